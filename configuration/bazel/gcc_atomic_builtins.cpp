@@ -0,0 +1,6 @@
+#include <cstdint>
+int main() {
+  static std::uintptr_t x = 0;
+  __atomic_store_n(&x, 1, __ATOMIC_RELEASE);
+  return (int) __atomic_load_n(&x, __ATOMIC_ACQUIRE) - 1;
+}
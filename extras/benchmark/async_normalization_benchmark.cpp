@@ -0,0 +1,138 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the startup time of a program that normalizes a root component installing many component functions and
+// that also has some other startup work to do (e.g. parsing the configuration, opening sockets), simulated by spinning
+// for a given time. This compares:
+// * constructing the NormalizedComponent and then doing the other work, in the same thread
+// * starting the normalization with fruit::normalizeAsync(), doing the other work while it runs in another thread, and
+//   then creating the first injector from the NormalizedComponentFuture
+//
+// Usage: async_normalization_benchmark <num_loops> <startup_work_in_microseconds>
+
+#include <fruit/fruit.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+// The number of component functions installed by the root component.
+constexpr int num_components = 256;
+
+template <int N>
+struct Dependency {
+  Dependency() = default;
+};
+
+template <int N>
+struct Service {
+  Service(Dependency<N>&) {}
+};
+
+template <int N>
+fruit::Component<> getServiceComponent() {
+  return fruit::createComponent()
+      .template registerConstructor<Service<N>(Dependency<N>&)>()
+      .template registerConstructor<Dependency<N>()>();
+}
+
+// Installs getServiceComponent<Begin>, ..., getServiceComponent<End - 1>.
+// This splits the range in halves so that the template recursion depth is logarithmic.
+template <int Begin, int End, bool single_component = (End - Begin == 1)>
+struct GetServiceComponents {
+  static fruit::Component<> get() {
+    return fruit::createComponent()
+        .install(GetServiceComponents<Begin, (Begin + End) / 2>::get)
+        .install(GetServiceComponents<(Begin + End) / 2, End>::get);
+  }
+};
+
+template <int Begin, int End>
+struct GetServiceComponents<Begin, End, true> {
+  static fruit::Component<> get() {
+    return fruit::createComponent().install(getServiceComponent<Begin>);
+  }
+};
+
+fruit::Component<> getRootComponent() {
+  return fruit::createComponent().install(GetServiceComponents<0, num_components>::get);
+}
+
+fruit::Component<> getRequestComponent() {
+  return fruit::createComponent();
+}
+
+using Clock = std::chrono::high_resolution_clock;
+
+// Simulates some other startup work, that uses the current thread for the given time.
+void doOtherStartupWork(Clock::duration duration) {
+  Clock::time_point end_time = Clock::now() + duration;
+  while (Clock::now() < end_time) {
+  }
+}
+
+double toMicroseconds(Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(duration).count();
+}
+
+int main(int argc, const char* argv[]) {
+  if (argc != 3) {
+    std::cout << "Error: you need to specify the number of loops and the startup work time (in microseconds) as "
+                 "arguments."
+              << std::endl;
+    return 1;
+  }
+  std::size_t num_loops = std::atoi(argv[1]);
+  Clock::duration startup_work_duration = std::chrono::microseconds(std::atoi(argv[2]));
+
+  Clock::duration normalization_time(0);
+  Clock::duration sequential_startup_time(0);
+  Clock::duration async_startup_time(0);
+  for (std::size_t i = 0; i < num_loops; i++) {
+    {
+      Clock::time_point start_time = Clock::now();
+      fruit::NormalizedComponent<> normalized_component(getRootComponent);
+      normalization_time += Clock::now() - start_time;
+      fruit::Injector<> injector(normalized_component, getRequestComponent);
+    }
+    {
+      Clock::time_point start_time = Clock::now();
+      fruit::NormalizedComponent<> normalized_component(getRootComponent);
+      doOtherStartupWork(startup_work_duration);
+      fruit::Injector<> injector(normalized_component, getRequestComponent);
+      sequential_startup_time += Clock::now() - start_time;
+    }
+    {
+      Clock::time_point start_time = Clock::now();
+      fruit::NormalizedComponentFuture<> normalized_component_future = fruit::normalizeAsync(getRootComponent);
+      doOtherStartupWork(startup_work_duration);
+      fruit::Injector<> injector(normalized_component_future, getRequestComponent);
+      async_startup_time += Clock::now() - start_time;
+    }
+  }
+
+  std::cout << std::fixed;
+  std::cout << std::setprecision(2);
+  std::cout << "Components = " << num_components << ", normalization time (us) = "
+            << toMicroseconds(normalization_time) / num_loops << std::endl;
+  std::cout << "Components = " << num_components << ", startup time with NormalizedComponent (us) = "
+            << toMicroseconds(sequential_startup_time) / num_loops << std::endl;
+  std::cout << "Components = " << num_components << ", startup time with normalizeAsync() (us) = "
+            << toMicroseconds(async_startup_time) / num_loops << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the time needed to construct independent subgraphs from multiple threads with the default injector-wide
+// mutex and with InjectorOptions::concurrent_construction.
+//
+// Usage: concurrent_construction_benchmark <num_loops> <constructor_time_in_microseconds>
+
+#include <fruit/fruit.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static std::chrono::microseconds constructor_time;
+
+// Simulates a constructor that does some work (e.g. I/O or parsing a configuration).
+static void doSomeWork() {
+  std::chrono::high_resolution_clock::time_point end_time =
+      std::chrono::high_resolution_clock::now() + constructor_time;
+  while (std::chrono::high_resolution_clock::now() < end_time) {
+  }
+}
+
+template <int Subgraph, int N>
+struct X {
+  INJECT(X(X<Subgraph, N - 1>&)) {
+    doSomeWork();
+  }
+};
+
+template <int Subgraph>
+struct X<Subgraph, 0> {
+  INJECT(X()) {
+    doSomeWork();
+  }
+};
+
+// 4 independent chains of 10 objects each.
+using BenchmarkComponent = fruit::Component<X<0, 9>, X<1, 9>, X<2, 9>, X<3, 9>>;
+using BenchmarkInjector = fruit::Injector<X<0, 9>, X<1, 9>, X<2, 9>, X<3, 9>>;
+
+BenchmarkComponent getRootComponent() {
+  return fruit::createComponent();
+}
+
+static double runBenchmark(std::size_t num_loops, bool concurrent_construction) {
+  double total_time = 0;
+  for (std::size_t i = 0; i < num_loops; i++) {
+    fruit::InjectorOptions options;
+    options.concurrent_construction = concurrent_construction;
+    BenchmarkInjector injector(options, getRootComponent);
+
+    std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    threads.emplace_back([&injector]() { injector.get<X<0, 9>&>(); });
+    threads.emplace_back([&injector]() { injector.get<X<1, 9>&>(); });
+    threads.emplace_back([&injector]() { injector.get<X<2, 9>&>(); });
+    threads.emplace_back([&injector]() { injector.get<X<3, 9>&>(); });
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    total_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start_time)
+            .count();
+  }
+  return total_time / num_loops;
+}
+
+int main(int argc, const char* argv[]) {
+  if (argc != 3) {
+    std::cout << "Error: you need to specify the number of loops and the time spent in each constructor (in "
+              << "microseconds) as arguments." << std::endl;
+    return 1;
+  }
+  std::size_t num_loops = std::atoi(argv[1]);
+  constructor_time = std::chrono::microseconds(std::atoi(argv[2]));
+
+  std::cout << std::fixed;
+  std::cout << std::setprecision(15);
+  std::cout << "Injector-wide mutex     = " << runBenchmark(num_loops, false) << std::endl;
+  std::cout << "Concurrent construction = " << runBenchmark(num_loops, true) << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the throughput of Injector::get<T>() on already-constructed objects when the same injector is used from
+// multiple threads at the same time.
+//
+// Usage: multithreaded_get_benchmark <num_loops> [<max_num_threads>]
+
+#include <fruit/fruit.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+template <int N>
+struct X {
+  INJECT(X(X<N - 1>&)) {}
+};
+
+template <>
+struct X<0> {
+  INJECT(X()) = default;
+};
+
+using BenchmarkComponent = fruit::Component<X<0>, X<1>, X<2>, X<3>, X<4>, X<5>, X<6>, X<7>, X<8>, X<9>>;
+using BenchmarkInjector = fruit::Injector<X<0>, X<1>, X<2>, X<3>, X<4>, X<5>, X<6>, X<7>, X<8>, X<9>>;
+
+BenchmarkComponent getRootComponent() {
+  return fruit::createComponent();
+}
+
+template <int N>
+struct GetAll {
+  void operator()(BenchmarkInjector& injector) {
+    injector.get<X<N>&>();
+    GetAll<N - 1>()(injector);
+  }
+};
+
+template <>
+struct GetAll<-1> {
+  void operator()(BenchmarkInjector&) {}
+};
+
+int main(int argc, const char* argv[]) {
+  if (argc != 2 && argc != 3) {
+    std::cout << "Error: you need to specify the number of loops (and optionally the max number of threads) as "
+              << "arguments." << std::endl;
+    return 1;
+  }
+  std::size_t num_loops = std::atoi(argv[1]);
+  std::size_t max_num_threads = std::max(1U, std::thread::hardware_concurrency());
+  if (argc == 3) {
+    max_num_threads = std::atoi(argv[2]);
+  }
+
+  BenchmarkInjector injector(getRootComponent);
+  // Construct everything upfront, we only want to measure get() on already-constructed objects.
+  GetAll<9>()(injector);
+
+  std::cout << std::fixed;
+  std::cout << std::setprecision(15);
+
+  for (std::size_t num_threads = 1; num_threads <= max_num_threads; num_threads *= 2) {
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < num_threads; i++) {
+      threads.emplace_back([&] {
+        while (!start.load()) {
+        }
+        for (std::size_t j = 0; j < num_loops; j++) {
+          GetAll<9>()(injector);
+        }
+      });
+    }
+
+    std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now();
+    start.store(true);
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    double totalTime =
+        std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start_time)
+            .count();
+
+    // 10 get() calls per loop.
+    double num_gets = 10.0 * num_loops * num_threads;
+    std::cout << "Threads = " << num_threads << ", get() calls per second = " << num_gets / totalTime << std::endl;
+  }
+
+  return 0;
+}
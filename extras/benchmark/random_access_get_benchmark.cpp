@@ -0,0 +1,200 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the throughput of the lookups done by Injector::get<T>() for already-constructed objects, when T is chosen
+// at random among many types: finding the node of T in the injection graph, checking that it's terminal and reading
+// the object pointer.
+// An Injector with 10000 types in its signature would take too long to compile, so this builds the injection graph
+// directly. Both an injector created from a Component (a single graph) and injectors created from a NormalizedComponent
+// (overlay graphs whose objects are constructed in the overlay) are measured. For the latter, the first injector
+// created from the NormalizedComponent (that finds the constructed objects through a hash table) is measured separately
+// from the next ones (that find them by direct indexing, see SemistaticGraph::NodeSlots).
+//
+// Usage: random_access_get_benchmark <num_loops> [<num_types>]
+
+#define IN_FRUIT_CPP_FILE 1
+
+#include <fruit/impl/data_structures/semistatic_graph.templates.h>
+#include <fruit/impl/normalized_component_storage/normalized_bindings.h>
+#include <fruit/impl/util/type_info.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+using fruit::impl::MemoryPool;
+using fruit::impl::NormalizedBinding;
+using fruit::impl::TypeId;
+using fruit::impl::getTypeId;
+
+using Graph = fruit::impl::SemistaticGraph<TypeId, NormalizedBinding>;
+
+constexpr int max_num_types = 10000;
+
+// Each get() is done on one of these many types, chosen at random (but the same in all loops).
+constexpr std::size_t num_gets_per_loop = 100000;
+
+template <int N>
+using BenchmarkType = std::integral_constant<int, N>;
+
+// Appends the TypeIds of BenchmarkType<Begin>, ..., BenchmarkType<End - 1> to `type_ids'.
+// This splits the range in halves so that the template recursion depth is logarithmic.
+template <int Begin, int End, bool single_type = (End - Begin == 1)>
+struct AddTypeIds {
+  void operator()(std::vector<TypeId>& type_ids) {
+    AddTypeIds<Begin, (Begin + End) / 2>()(type_ids);
+    AddTypeIds<(Begin + End) / 2, End>()(type_ids);
+  }
+};
+
+template <int Begin, int End>
+struct AddTypeIds<Begin, End, true> {
+  void operator()(std::vector<TypeId>& type_ids) {
+    type_ids.push_back(getTypeId<BenchmarkType<Begin>>());
+  }
+};
+
+// A binding with no dependencies, as the ones of the injection graph.
+struct BenchmarkBinding {
+  TypeId id;
+  NormalizedBinding value;
+
+  TypeId getId() const {
+    return id;
+  }
+
+  NormalizedBinding getValue() const {
+    return value;
+  }
+
+  bool isTerminal() const {
+    return false;
+  }
+
+  const TypeId* getEdgesBegin() const {
+    return nullptr;
+  }
+
+  const TypeId* getEdgesEnd() const {
+    return nullptr;
+  }
+
+  bool isLazyEdge(std::size_t) const {
+    return false;
+  }
+};
+
+// Makes all nodes terminal, as Injector::get() does after constructing each object.
+void constructAll(Graph& graph, const std::vector<TypeId>& type_ids, std::vector<int>& objects) {
+  for (std::size_t i = 0; i < type_ids.size(); i++) {
+    NormalizedBinding binding = graph.at(type_ids[i]).getNode();
+    binding.object = &objects[i];
+    graph.at(type_ids[i]).setTerminal(binding);
+  }
+}
+
+double measureGetsPerSecond(std::size_t num_loops, Graph& graph, const std::vector<TypeId>& keys,
+                            std::uintptr_t& checksum) {
+  std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now();
+  for (std::size_t i = 0; i < num_loops; i++) {
+    for (TypeId key : keys) {
+      Graph::node_iterator itr = graph.at(key);
+      if (itr.isTerminal()) {
+        checksum += reinterpret_cast<std::uintptr_t>(itr.getNode().object);
+      }
+    }
+  }
+  double totalTime =
+      std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start_time)
+          .count();
+  return num_loops * keys.size() / totalTime;
+}
+
+int main(int argc, const char* argv[]) {
+  if (argc != 2 && argc != 3) {
+    std::cout << "Error: you need to specify the number of loops (and optionally the number of types) as arguments."
+              << std::endl;
+    return 1;
+  }
+  std::size_t num_loops = std::atoi(argv[1]);
+  std::size_t num_types = max_num_types;
+  if (argc == 3) {
+    num_types = std::atoi(argv[2]);
+    if (num_types == 0 || num_types > max_num_types) {
+      std::cout << "Error: the number of types must be between 1 and " << max_num_types << "." << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<TypeId> type_ids;
+  AddTypeIds<0, max_num_types>()(type_ids);
+  type_ids.resize(num_types);
+
+  std::vector<BenchmarkBinding> bindings;
+  for (TypeId type_id : type_ids) {
+    NormalizedBinding value;
+    value.create = nullptr;
+    bindings.push_back(BenchmarkBinding{type_id, value});
+  }
+
+  std::default_random_engine random_generator;
+  std::uniform_int_distribution<std::size_t> distribution(0, num_types - 1);
+  std::vector<TypeId> keys;
+  for (std::size_t i = 0; i < num_gets_per_loop; i++) {
+    keys.push_back(type_ids[distribution(random_generator)]);
+  }
+
+  std::vector<int> objects(num_types);
+  std::uintptr_t checksum = 0;
+
+  MemoryPool memory_pool;
+  Graph graph(bindings.begin(), bindings.end(), memory_pool);
+  Graph base_graph(bindings.begin(), bindings.end(), memory_pool);
+  BenchmarkBinding* no_bindings = nullptr;
+  Graph::NodeSlots node_slots;
+
+  constructAll(graph, type_ids, objects);
+  double gets_per_second = measureGetsPerSecond(num_loops, graph, keys, checksum);
+
+  double first_overlay_gets_per_second;
+  {
+    Graph overlay_graph(base_graph, no_bindings, no_bindings, memory_pool, nullptr, &node_slots, node_slots.size());
+    constructAll(overlay_graph, type_ids, objects);
+    first_overlay_gets_per_second = measureGetsPerSecond(num_loops, overlay_graph, keys, checksum);
+    // As done when destroying an injector.
+    overlay_graph.assignNodeSlots(node_slots);
+  }
+
+  Graph overlay_graph(base_graph, no_bindings, no_bindings, memory_pool, nullptr, &node_slots, node_slots.size());
+  constructAll(overlay_graph, type_ids, objects);
+  double overlay_gets_per_second = measureGetsPerSecond(num_loops, overlay_graph, keys, checksum);
+
+  std::cout << std::fixed;
+  std::cout << std::setprecision(15);
+  std::cout << "Types = " << num_types << ", gets per second = " << gets_per_second << std::endl;
+  std::cout << "Types = " << num_types
+            << ", gets per second (first injector from a NormalizedComponent) = " << first_overlay_gets_per_second
+            << std::endl;
+  std::cout << "Types = " << num_types << ", gets per second (from a NormalizedComponent) = " << overlay_gets_per_second
+            << std::endl;
+  std::cout << "(checksum: " << checksum << ")" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the throughput of SemistaticMap::at() (hits) and SemistaticMap::find() (misses) with TypeId keys, that are
+// the lookups performed by an injector to find the node of a type.
+//
+// Usage: semistatic_map_benchmark <num_loops> [<num_types>]
+
+#define IN_FRUIT_CPP_FILE 1
+
+#include <fruit/impl/data_structures/semistatic_map.templates.h>
+#include <fruit/impl/util/type_info.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using fruit::impl::MemoryPool;
+using fruit::impl::SemistaticMap;
+using fruit::impl::TypeId;
+using fruit::impl::getTypeId;
+
+constexpr int max_num_types = 1024;
+
+template <int N>
+using BenchmarkType = std::integral_constant<int, N>;
+
+// Appends the TypeIds of BenchmarkType<Begin>, ..., BenchmarkType<End - 1> to `type_ids'.
+// This splits the range in halves so that the template recursion depth is logarithmic.
+template <int Begin, int End, bool single_type = (End - Begin == 1)>
+struct AddTypeIds {
+  void operator()(std::vector<TypeId>& type_ids) {
+    AddTypeIds<Begin, (Begin + End) / 2>()(type_ids);
+    AddTypeIds<(Begin + End) / 2, End>()(type_ids);
+  }
+};
+
+template <int Begin, int End>
+struct AddTypeIds<Begin, End, true> {
+  void operator()(std::vector<TypeId>& type_ids) {
+    type_ids.push_back(getTypeId<BenchmarkType<Begin>>());
+  }
+};
+
+template <typename F>
+double measureLookupsPerSecond(std::size_t num_loops, const std::vector<TypeId>& keys, F lookup) {
+  std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now();
+  for (std::size_t i = 0; i < num_loops; i++) {
+    for (TypeId key : keys) {
+      lookup(key);
+    }
+  }
+  double totalTime =
+      std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start_time)
+          .count();
+  return num_loops * keys.size() / totalTime;
+}
+
+int main(int argc, const char* argv[]) {
+  if (argc != 2 && argc != 3) {
+    std::cout << "Error: you need to specify the number of loops (and optionally the number of types) as arguments."
+              << std::endl;
+    return 1;
+  }
+  std::size_t num_loops = std::atoi(argv[1]);
+  std::size_t num_types = max_num_types / 2;
+  if (argc == 3) {
+    num_types = std::atoi(argv[2]);
+    if (num_types == 0 || num_types > max_num_types / 2) {
+      std::cout << "Error: the number of types must be between 1 and " << max_num_types / 2 << "." << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<TypeId> type_ids;
+  AddTypeIds<0, max_num_types>()(type_ids);
+  // The first num_types types are in the map, the last num_types are not.
+  std::vector<TypeId> present_keys(type_ids.begin(), type_ids.begin() + num_types);
+  std::vector<TypeId> missing_keys(type_ids.end() - num_types, type_ids.end());
+
+  std::vector<std::pair<TypeId, std::size_t>> values;
+  for (std::size_t i = 0; i < num_types; i++) {
+    values.emplace_back(present_keys[i], i);
+  }
+  MemoryPool memory_pool;
+  SemistaticMap<TypeId, std::size_t> map(values.begin(), values.end(), values.size(), memory_pool);
+
+  // This is only used to make sure that the lookups are not optimized out.
+  std::size_t checksum = 0;
+
+  double hits_per_second =
+      measureLookupsPerSecond(num_loops, present_keys, [&](TypeId key) { checksum += map.at(key); });
+  double misses_per_second = measureLookupsPerSecond(num_loops, missing_keys, [&](TypeId key) {
+    checksum += (map.find(key) == nullptr);
+  });
+
+  std::cout << std::fixed;
+  std::cout << std::setprecision(15);
+  std::cout << "Types = " << num_types << ", at() hits per second = " << hits_per_second << std::endl;
+  std::cout << "Types = " << num_types << ", find() misses per second = " << misses_per_second << std::endl;
+  std::cout << "(checksum: " << checksum << ")" << std::endl;
+
+  return 0;
+}
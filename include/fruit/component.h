@@ -70,9 +70,15 @@ private:
   template <typename... OtherParams>
   friend class NormalizedComponent;
 
+  template <typename... OtherParams>
+  friend class NormalizedComponentFuture;
+
   template <typename... OtherParams>
   friend class Injector;
 
+  template <typename... OtherParams>
+  friend class InjectorPool;
+
   template <typename... Bindings>
   friend class fruit::impl::PartialComponentStorage;
 
@@ -812,6 +818,40 @@ public:
   PartialComponent<fruit::impl::RegisterFactory<DecoratedSignature, Factory>, Bindings...>
   registerFactory(Factory factory);
 
+  /**
+   * Marks the binding for C (or for an annotated type, e.g. fruit::Annotated<MyAnnotation, C>) as shared across all
+   * the injectors created from the same NormalizedComponent.
+   *
+   * By default, each injector created from a NormalizedComponent constructs its own instance of each type that it
+   * uses. For a type marked with shareAcrossInjectors() instead, a single instance is constructed (the first time
+   * that any of those injectors needs it, even when they're used from different threads) and then returned by all the
+   * injectors. That instance is owned by the NormalizedComponent and is destroyed together with it.
+   *
+   * The types that C depends on (directly or indirectly) are shared too, so they must all be bound in the
+   * NormalizedComponent (a fatal error is reported when constructing the NormalizedComponent otherwise). In
+   * particular, C can't depend on the types that the NormalizedComponent requires.
+   *
+   * Example use:
+   *
+   * fruit::Component<fruit::Required<Request>, RequestHandler> getRequestHandlerComponent() {
+   *   return fruit::createComponent()
+   *       .bind<DatabaseConnectionPool, DatabaseConnectionPoolImpl>()
+   *       .shareAcrossInjectors<DatabaseConnectionPool>();
+   * }
+   *
+   * fruit::NormalizedComponent<fruit::Required<Request>, RequestHandler> normalized_component(
+   *     getRequestHandlerComponent);
+   * // These injectors (e.g. one for each request) construct their own RequestHandler, but the same
+   * // DatabaseConnectionPool.
+   * fruit::Injector<RequestHandler> injector1(normalized_component, getRequestComponent, &request1);
+   * fruit::Injector<RequestHandler> injector2(normalized_component, getRequestComponent, &request2);
+   *
+   * This has no effect in an Injector created from a Component (that constructs each object at most once anyway) and
+   * it's ignored in the component passed to an Injector together with a NormalizedComponent.
+   */
+  template <typename C>
+  PartialComponent<fruit::impl::ShareAcrossInjectors<C>, Bindings...> shareAcrossInjectors();
+
   /**
    * Adds the bindings (and multibindings) in the Component obtained by calling fun(args...) to the current component.
    *
@@ -28,8 +28,13 @@
 #include <fruit/component_function.h>
 #include <fruit/fruit_forward_decls.h>
 #include <fruit/injector.h>
+#include <fruit/injector_options.h>
+#include <fruit/injector_pool.h>
 #include <fruit/macro.h>
+#include <fruit/memory_resource.h>
 #include <fruit/normalized_component.h>
+#include <fruit/normalized_component_future.h>
+#include <fruit/normalized_component_options.h>
 #include <fruit/provider.h>
 
 #endif // FRUIT_FRUIT_H
@@ -54,12 +54,24 @@ class PartialComponent;
 template <typename... Types>
 class NormalizedComponent;
 
+template <typename... Types>
+class NormalizedComponentFuture;
+
 template <typename C>
 class Provider;
 
 template <typename... P>
 class Injector;
 
+template <typename... P>
+class InjectorPool;
+
+struct InjectorOptions;
+
+class MemoryResource;
+
+struct NormalizedComponentOptions;
+
 template <typename ComponentType, typename... ComponentFunctionArgs>
 class ComponentFunction;
 
@@ -115,6 +115,13 @@ struct AddMultibindingProvider<AnnotatedSignature, Lambda> {};
 template <typename DecoratedSignature, typename Lambda>
 struct RegisterFactory {};
 
+/**
+ * Marks the binding for C (that must be bound in the same normalized component) as shared across the injectors created
+ * from that normalized component.
+ */
+template <typename C>
+struct ShareAcrossInjectors {};
+
 /**
  * Adds the bindings (and multibindings) in `component' to the current component.
  * OtherComponent must be of the form Component<...>.
@@ -236,6 +236,17 @@ PartialComponent<Bindings...>::registerFactory(Lambda) {
   return {{storage}};
 }
 
+template <typename... Bindings>
+template <typename C>
+inline PartialComponent<fruit::impl::ShareAcrossInjectors<C>, Bindings...>
+PartialComponent<Bindings...>::shareAcrossInjectors() {
+  using Op = fruit::impl::meta::Eval<fruit::impl::meta::CheckNormalizedTypes(
+      fruit::impl::meta::RemoveAnnotationsFromVector(fruit::impl::meta::Vector<fruit::impl::meta::Type<C>>))>;
+  (void)typename fruit::impl::meta::CheckIfError<Op>::type();
+
+  return {{storage}};
+}
+
 template <typename... Bindings>
 inline PartialComponent<Bindings...>::PartialComponent(fruit::impl::PartialComponentStorage<Bindings...> storage)
     : storage(std::move(storage)) {}
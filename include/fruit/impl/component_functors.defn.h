@@ -1288,6 +1288,11 @@ struct ProcessBinding {
     using type = ComponentFunctor(RegisterFactory, Type<DecoratedSignature>, Type<Lambda>);
   };
 
+  template <typename C>
+  struct apply<fruit::impl::ShareAcrossInjectors<C>> {
+    using type = ComponentFunctorIdentity;
+  };
+
   template <typename... Params, typename... Args>
   struct apply<fruit::impl::InstallComponent<fruit::Component<Params...>(Args...)>> {
     using type = ComponentFunctor(InstallComponentHelper, Type<Params>...);
@@ -17,36 +17,51 @@
 #ifndef FRUIT_BINDING_DEPS_DEFN_H
 #define FRUIT_BINDING_DEPS_DEFN_H
 
+#include <fruit/fruit_forward_decls.h>
 #include <fruit/impl/component_storage/binding_deps.h>
 
+#include <type_traits>
+
 namespace fruit {
 namespace impl {
 
-template <typename L>
+template <typename AnnotatedT>
+struct IsLazyBindingDep : public std::false_type {};
+
+template <typename T>
+struct IsLazyBindingDep<fruit::Provider<T>> : public std::true_type {};
+
+template <typename Annotation, typename T>
+struct IsLazyBindingDep<fruit::Annotated<Annotation, T>> : public IsLazyBindingDep<T> {};
+
+template <typename Deps, typename AnnotatedArgs>
 struct GetBindingDepsHelper;
 
-template <typename... Ts>
-struct GetBindingDepsHelper<fruit::impl::meta::Vector<fruit::impl::meta::Type<Ts>...>> {
+template <typename... Ts, typename... AnnotatedArgs>
+struct GetBindingDepsHelper<fruit::impl::meta::Vector<fruit::impl::meta::Type<Ts>...>,
+                            fruit::impl::meta::Vector<fruit::impl::meta::Type<AnnotatedArgs>...>> {
   inline const BindingDeps* operator()() {
     static const TypeId types[] = {getTypeId<Ts>()..., TypeId{nullptr}}; // LCOV_EXCL_BR_LINE
-    static const BindingDeps deps = {types, sizeof...(Ts)};
+    static const bool lazy_deps[] = {IsLazyBindingDep<AnnotatedArgs>::value..., false};
+    static const BindingDeps deps = {types, sizeof...(Ts), lazy_deps};
     return &deps;
   }
 };
 
 // We specialize the "no Ts" case to avoid declaring types[] as an array of length 0.
 template <>
-struct GetBindingDepsHelper<fruit::impl::meta::Vector<>> {
+struct GetBindingDepsHelper<fruit::impl::meta::Vector<>, fruit::impl::meta::Vector<>> {
   inline const BindingDeps* operator()() {
     static const TypeId types[] = {TypeId{nullptr}};
-    static const BindingDeps deps = {types, 0};
+    static const bool lazy_deps[] = {false};
+    static const BindingDeps deps = {types, 0, lazy_deps};
     return &deps;
   }
 };
 
-template <typename Deps>
+template <typename Deps, typename AnnotatedArgs>
 inline const BindingDeps* getBindingDeps() {
-  return GetBindingDepsHelper<Deps>()();
+  return GetBindingDepsHelper<Deps, AnnotatedArgs>()();
 }
 
 } // namespace impl
@@ -28,9 +28,15 @@ struct BindingDeps {
 
   // The size of the above array.
   std::size_t num_deps;
+
+  // A C-style array with num_deps elements. lazy_deps[i] is true iff deps[i] is injected as a Provider<>, so it
+  // doesn't need to be constructed before the object that depends on it.
+  const bool* lazy_deps;
 };
 
-template <typename Deps>
+// Deps is a Vector of the (normalized) dependency types, and AnnotatedArgs the Vector of the corresponding injected
+// types (that can be e.g. Provider<>s).
+template <typename Deps, typename AnnotatedArgs = Deps>
 const BindingDeps* getBindingDeps();
 
 } // namespace impl
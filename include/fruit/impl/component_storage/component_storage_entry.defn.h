@@ -107,6 +107,11 @@ public:
   inline TypeId getFunTypeId() const final {
     return fruit::impl::getTypeId<Component (*)(Args...)>();
   }
+
+  inline const BindingDeps* getProvidedTypes() const final {
+    using Ps = typename Component::Comp::Ps;
+    return getBindingDeps<Ps, Ps>();
+  }
 };
 
 template <typename Component, typename... Args>
@@ -172,6 +177,15 @@ void ComponentStorageEntry::LazyComponentWithNoArgs::addBindings(erased_fun_t er
   entries.insert(entries.end(), component_entries.begin(), component_entries.end());
 }
 
+template <typename Component>
+inline const ComponentStorageEntry::LazyComponentWithNoArgs::ComponentTypeData*
+ComponentStorageEntry::LazyComponentWithNoArgs::getComponentTypeData() {
+  using Ps = typename Component::Comp::Ps;
+  static const ComponentTypeData component_type_data = {LazyComponentWithNoArgs::addBindings<Component>,
+                                                        getBindingDeps<Ps, Ps>()};
+  return &component_type_data;
+}
+
 template <typename Component>
 inline ComponentStorageEntry ComponentStorageEntry::LazyComponentWithNoArgs::create(Component (*fun)()) {
   FruitAssert(fun != nullptr);
@@ -179,7 +193,7 @@ inline ComponentStorageEntry ComponentStorageEntry::LazyComponentWithNoArgs::cre
   result.kind = ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_NO_ARGS;
   result.type_id = getTypeId<Component (*)()>();
   result.lazy_component_with_no_args.erased_fun = reinterpret_cast<erased_fun_t>(fun);
-  result.lazy_component_with_no_args.add_bindings_fun = LazyComponentWithNoArgs::addBindings<Component>;
+  result.lazy_component_with_no_args.component_type_data = LazyComponentWithNoArgs::getComponentTypeData<Component>();
   return result;
 }
 
@@ -197,7 +211,7 @@ ComponentStorageEntry::LazyComponentWithNoArgs::createReplacedComponentEntry(Com
   result.kind = ComponentStorageEntry::Kind::REPLACED_LAZY_COMPONENT_WITH_NO_ARGS;
   result.type_id = getTypeId<Component (*)()>();
   result.lazy_component_with_no_args.erased_fun = reinterpret_cast<erased_fun_t>(fun);
-  result.lazy_component_with_no_args.add_bindings_fun = LazyComponentWithNoArgs::addBindings<Component>;
+  result.lazy_component_with_no_args.component_type_data = LazyComponentWithNoArgs::getComponentTypeData<Component>();
   return result;
 }
 
@@ -209,7 +223,7 @@ ComponentStorageEntry::LazyComponentWithNoArgs::createReplacementComponentEntry(
   result.kind = ComponentStorageEntry::Kind::REPLACEMENT_LAZY_COMPONENT_WITH_NO_ARGS;
   result.type_id = getTypeId<Component (*)()>();
   result.lazy_component_with_no_args.erased_fun = reinterpret_cast<erased_fun_t>(fun);
-  result.lazy_component_with_no_args.add_bindings_fun = LazyComponentWithNoArgs::addBindings<Component>;
+  result.lazy_component_with_no_args.component_type_data = LazyComponentWithNoArgs::getComponentTypeData<Component>();
   return result;
 }
 
@@ -221,17 +235,22 @@ inline bool ComponentStorageEntry::LazyComponentWithNoArgs::
 operator==(const ComponentStorageEntry::LazyComponentWithNoArgs& other) const {
   if (erased_fun == other.erased_fun) {
     // These must be equal in this case, no need to compare them.
-    FruitAssert(add_bindings_fun == other.add_bindings_fun);
+    FruitAssert(component_type_data == other.component_type_data);
     return true;
   } else {
-    // type_id and add_bindings_fun may or may not be different from the ones in `other`.
+    // type_id and component_type_data may or may not be different from the ones in `other`.
     return false;
   }
 }
 
 inline void ComponentStorageEntry::LazyComponentWithNoArgs::addBindings(entry_vector_t& entries) const {
   FruitAssert(isValid());
-  add_bindings_fun(erased_fun, entries);
+  component_type_data->add_bindings_fun(erased_fun, entries);
+}
+
+inline const BindingDeps* ComponentStorageEntry::LazyComponentWithNoArgs::getProvidedTypes() const {
+  FruitAssert(isValid());
+  return component_type_data->provided_types;
 }
 
 inline std::size_t ComponentStorageEntry::LazyComponentWithNoArgs::hashCode() const {
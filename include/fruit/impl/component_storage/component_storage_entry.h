@@ -49,6 +49,10 @@ struct ComponentStorageEntry {
     // vector can be created. Unlike real multibinding entries, this *can* be deduped.
     MULTIBINDING_VECTOR_CREATOR,
 
+    // This is not an actual binding either, it marks the binding for type_id as shared across the injectors created
+    // from the normalized component (see PartialComponent::shareAcrossInjectors()). Only type_id is set.
+    TYPE_SHARED_ACROSS_INJECTORS,
+
     LAZY_COMPONENT_WITH_NO_ARGS,
     LAZY_COMPONENT_WITH_ARGS,
 
@@ -192,13 +196,25 @@ struct ComponentStorageEntry {
 
     using entry_vector_t = std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>;
 
-    // The function that allows to add this component's bindings to the given ComponentStorage.
     using add_bindings_fun_t = void (*)(erased_fun_t, entry_vector_t&);
-    add_bindings_fun_t add_bindings_fun;
+
+    // The data that only depends on the Component type returned by erased_fun. There's a single (static) object for
+    // each Component type, so we only store a pointer to it here to keep ComponentStorageEntry small.
+    struct ComponentTypeData {
+      // The function that allows to add this component's bindings to the given ComponentStorage.
+      add_bindings_fun_t add_bindings_fun;
+
+      // The types in the Component's signature, except the required ones.
+      const BindingDeps* provided_types;
+    };
+    const ComponentTypeData* component_type_data;
 
     template <typename Component>
     static void addBindings(erased_fun_t erased_fun, entry_vector_t& entries);
 
+    template <typename Component>
+    static const ComponentTypeData* getComponentTypeData();
+
     template <typename Component>
     static ComponentStorageEntry create(Component (*fun)());
 
@@ -215,6 +231,9 @@ struct ComponentStorageEntry {
 
     void addBindings(entry_vector_t& entries) const;
 
+    // Returns the types in the signature of the Component returned by the function, except the required ones.
+    const BindingDeps* getProvidedTypes() const;
+
     std::size_t hashCode() const;
 
     bool isValid() const;
@@ -249,6 +268,9 @@ struct ComponentStorageEntry {
 
       virtual void addBindings(entry_vector_t& component_storage_entries) const = 0;
       virtual std::size_t hashCode() const = 0;
+
+      // Returns the types in the signature of the Component returned by the function, except the required ones.
+      virtual const BindingDeps* getProvidedTypes() const = 0;
       virtual ComponentInterface* copy() const = 0;
 
       /**
@@ -327,6 +327,25 @@ public:
   }
 };
 
+template <typename C, typename... PreviousBindings>
+class PartialComponentStorage<ShareAcrossInjectors<C>, PreviousBindings...> {
+private:
+  PartialComponentStorage<PreviousBindings...>& previous_storage;
+
+public:
+  PartialComponentStorage(PartialComponentStorage<PreviousBindings...>& previous_storage) // NOLINT(google-explicit-constructor)
+      : previous_storage(previous_storage) {}
+
+  void addBindings(FixedSizeVector<ComponentStorageEntry>& entries) const {
+    entries.push_back(InjectorStorage::createComponentStorageEntryForTypeSharedAcrossInjectors<C>());
+    previous_storage.addBindings(entries);
+  }
+
+  std::size_t numBindings() const {
+    return previous_storage.numBindings() + 1;
+  }
+};
+
 template <typename OtherComponent, typename... PreviousBindings>
 class PartialComponentStorage<InstallComponent<OtherComponent()>, PreviousBindings...> {
 private:
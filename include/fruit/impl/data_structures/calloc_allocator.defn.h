@@ -0,0 +1,64 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_CALLOC_ALLOCATOR_DEFN_H
+#define FRUIT_CALLOC_ALLOCATOR_DEFN_H
+
+#include <fruit/impl/data_structures/calloc_allocator.h>
+#include <fruit/impl/fruit-config.h>
+
+#include <cstdlib>
+#include <new>
+
+namespace fruit {
+namespace impl {
+
+template <typename T>
+template <typename U>
+inline CallocAllocator<T>::CallocAllocator(const CallocAllocator<U>&) {}
+
+template <typename T>
+inline T* CallocAllocator<T>::allocate(std::size_t n) {
+  void* p = std::calloc(n, sizeof(T));
+  if (p == nullptr) {
+#if FRUIT_HAS_EXCEPTIONS
+    throw std::bad_alloc();
+#else
+    std::abort(); // LCOV_EXCL_LINE
+#endif
+  }
+  return static_cast<T*>(p);
+}
+
+template <typename T>
+inline void CallocAllocator<T>::deallocate(T* p, std::size_t) {
+  std::free(p);
+}
+
+template <class T, class U>
+bool operator==(const CallocAllocator<T>&, const CallocAllocator<U>&) {
+  return true;
+}
+
+template <class T, class U>
+bool operator!=(const CallocAllocator<T>&, const CallocAllocator<U>&) {
+  return false;
+}
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_CALLOC_ALLOCATOR_DEFN_H
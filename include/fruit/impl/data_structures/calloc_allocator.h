@@ -0,0 +1,59 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_CALLOC_ALLOCATOR_H
+#define FRUIT_CALLOC_ALLOCATOR_H
+
+#include <cstddef>
+
+namespace fruit {
+namespace impl {
+
+/**
+ * An allocator that returns zero-filled memory, obtained with calloc(). This avoids a separate pass to zero-fill
+ * arrays whose elements are mostly 0 (see FixedSizeVector::appendZeroFilled()).
+ */
+template <typename T>
+class CallocAllocator {
+public:
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = CallocAllocator<U>;
+  };
+
+  CallocAllocator() = default;
+
+  template <typename U>
+  CallocAllocator(const CallocAllocator<U>&); // NOLINT(google-explicit-constructor)
+
+  T* allocate(std::size_t n);
+  void deallocate(T* p, std::size_t);
+};
+
+template <class T, class U>
+bool operator==(const CallocAllocator<T>&, const CallocAllocator<U>&);
+
+template <class T, class U>
+bool operator!=(const CallocAllocator<T>&, const CallocAllocator<U>&);
+
+} // namespace impl
+} // namespace fruit
+
+#include <fruit/impl/data_structures/calloc_allocator.defn.h>
+
+#endif // FRUIT_CALLOC_ALLOCATOR_H
@@ -20,6 +20,8 @@
 #include <fruit/impl/fruit_assert.h>
 
 #include <cassert>
+#include <cstdlib>
+#include <new>
 
 #if FRUIT_EXTRA_DEBUG
 #include <iostream>
@@ -31,6 +33,18 @@
 namespace fruit {
 namespace impl {
 
+inline FixedSizeAllocator::OptionalLockGuard::OptionalLockGuard(std::mutex* mutex) : mutex(mutex) {
+  if (mutex != nullptr) {
+    mutex->lock();
+  }
+}
+
+inline FixedSizeAllocator::OptionalLockGuard::~OptionalLockGuard() {
+  if (mutex != nullptr) {
+    mutex->unlock();
+  }
+}
+
 template <typename C>
 void FixedSizeAllocator::destroyObject(void* p) {
   C* cPtr = reinterpret_cast<C*>(p);
@@ -43,6 +57,11 @@ void FixedSizeAllocator::destroyExternalObject(void* p) {
   delete cPtr; // LCOV_EXCL_BR_LINE
 }
 
+constexpr std::size_t FixedSizeAllocator::getAreaIndex(std::size_t alignment, std::size_t index) {
+  return (index == num_areas - 1 || (std::size_t(1) << index) == alignment) ? index
+                                                                             : getAreaIndex(alignment, index + 1);
+}
+
 inline void FixedSizeAllocator::FixedSizeAllocatorData::addType(TypeId typeId) {
 #if FRUIT_EXTRA_DEBUG
   types[typeId]++;
@@ -50,7 +69,13 @@ inline void FixedSizeAllocator::FixedSizeAllocatorData::addType(TypeId typeId) {
   if (!typeId.type_info->isTriviallyDestructible()) {
     num_types_to_destroy++;
   }
-  total_size += maximumRequiredSpace(typeId);
+  std::size_t alignment = typeId.type_info->alignment();
+  std::size_t area_index = getAreaIndex(alignment);
+  area_sizes[area_index] += typeId.type_info->size();
+  if (area_index == num_areas - 1) {
+    // Objects in this area are aligned individually.
+    area_sizes[area_index] += alignment - 1;
+  }
 }
 
 inline void FixedSizeAllocator::FixedSizeAllocatorData::addExternallyAllocatedType(TypeId typeId) {
@@ -58,8 +83,41 @@ inline void FixedSizeAllocator::FixedSizeAllocatorData::addExternallyAllocatedTy
   num_types_to_destroy++;
 }
 
-inline std::size_t FixedSizeAllocator::FixedSizeAllocatorData::maximumRequiredSpace(TypeId type) {
-  return type.type_info->alignment() + type.type_info->size() - 1;
+inline void FixedSizeAllocator::FixedSizeAllocatorData::removeType(TypeId typeId) {
+#if FRUIT_EXTRA_DEBUG
+  FruitAssert(types[typeId] != 0);
+  if (--types[typeId] == 0) {
+    types.erase(typeId);
+  }
+#endif
+  if (!typeId.type_info->isTriviallyDestructible()) {
+    FruitAssert(num_types_to_destroy != 0);
+    num_types_to_destroy--;
+  }
+  std::size_t alignment = typeId.type_info->alignment();
+  std::size_t area_index = getAreaIndex(alignment);
+  area_sizes[area_index] -= typeId.type_info->size();
+  if (area_index == num_areas - 1) {
+    area_sizes[area_index] -= alignment - 1;
+  }
+}
+
+inline void FixedSizeAllocator::FixedSizeAllocatorData::removeExternallyAllocatedType(TypeId typeId) {
+  (void)typeId;
+  FruitAssert(num_types_to_destroy != 0);
+  num_types_to_destroy--;
+}
+
+inline std::size_t FixedSizeAllocator::FixedSizeAllocatorData::getStorageSize() const {
+  std::size_t storage_size = 0;
+  std::size_t max_alignment = 1;
+  for (std::size_t i = 0; i < num_areas; i++) {
+    storage_size += area_sizes[i];
+    if (i != num_areas - 1 && area_sizes[i] != 0) {
+      max_alignment = std::size_t(1) << i;
+    }
+  }
+  return storage_size + max_alignment - 1;
 }
 
 template <typename AnnotatedT, typename... Args>
@@ -69,16 +127,22 @@ FixedSizeAllocator::constructObject(Args&&... args) {
   using T = fruit::impl::meta::UnwrapType<
       fruit::impl::meta::Eval<fruit::impl::meta::RemoveAnnotations(fruit::impl::meta::Type<AnnotatedT>)>>;
 
-  char* p = storage_last_used;
-  size_t misalignment = std::uintptr_t(p) % alignof(T);
+  constexpr std::size_t area_index = getAreaIndex(alignof(T));
+  T* x;
+  {
+    OptionalLockGuard lock(mutex);
+    char* p = next_free[area_index];
 #if FRUIT_EXTRA_DEBUG
-  FruitAssert(remaining_types[getTypeId<AnnotatedT>()] != 0);
-  remaining_types[getTypeId<AnnotatedT>()]--;
+    FruitAssert(remaining_types[getTypeId<AnnotatedT>()] != 0);
+    remaining_types[getTypeId<AnnotatedT>()]--;
 #endif
-  p += alignof(T) - misalignment;
-  FruitAssert(std::uintptr_t(p) % alignof(T) == 0);
-  T* x = reinterpret_cast<T*>(p);
-  storage_last_used = p + sizeof(T) - 1;
+    if (area_index == num_areas - 1) {
+      p += (alignof(T) - std::uintptr_t(p) % alignof(T)) % alignof(T);
+    }
+    FruitAssert(std::uintptr_t(p) % alignof(T) == 0);
+    x = reinterpret_cast<T*>(p);
+    next_free[area_index] = p + sizeof(T);
+  }
 
   // This runs arbitrary code (T's constructor), which might end up calling
   // constructObject recursively. We must make sure all invariants are satisfied before
@@ -87,7 +151,8 @@ FixedSizeAllocator::constructObject(Args&&... args) {
 
   // We still run this later though, since if T's constructor throws we don't want to
   // destruct this object in FixedSizeAllocator's destructor.
-  if (!std::is_trivially_destructible<T>::value) {
+  if (!std::is_trivially_destructible<T>::value && !skip_destruction) {
+    OptionalLockGuard lock(mutex);
     on_destruction.push_back(std::pair<destroy_t, void*>{destroyObject<T>, x});
   }
   return x;
@@ -95,15 +160,67 @@ FixedSizeAllocator::constructObject(Args&&... args) {
 
 template <typename T>
 inline void FixedSizeAllocator::registerExternallyAllocatedObject(T* p) {
+  if (skip_destruction) {
+    return;
+  }
+  OptionalLockGuard lock(mutex);
   on_destruction.push_back(std::pair<destroy_t, void*>{destroyExternalObject<T>, p});
 }
 
-inline FixedSizeAllocator::FixedSizeAllocator(const FixedSizeAllocatorData& allocator_data)
-    : on_destruction(allocator_data.num_types_to_destroy) {
-  // The +1 is because we waste the first byte (storage_last_used points to the beginning of storage).
-  storage_begin = new char[allocator_data.total_size + 1];
-  storage_last_used = storage_begin;
+inline void FixedSizeAllocator::setMutex(std::mutex* mutex) {
+  this->mutex = mutex;
+}
+
+inline FixedSizeAllocator::FixedSizeAllocator(const FixedSizeAllocatorData& allocator_data, MemoryRegion* region,
+                                              bool skip_destruction)
+    : storage_size(allocator_data.getStorageSize()), storage_allocator(region),
+      on_destruction(skip_destruction ? 0 : allocator_data.num_types_to_destroy,
+                     RegionAllocator<std::pair<destroy_t, void*>>(region)),
+      skip_destruction(skip_destruction) {
+  if (storage_size != 0) {
+    storage_begin = storage_allocator.allocate(storage_size);
+  }
+  initAreas(allocator_data);
+}
+
+inline FixedSizeAllocator::FixedSizeAllocator(const FixedSizeAllocatorData& allocator_data,
+                                              MemoryResource* memory_resource, bool skip_destruction)
+    : storage_size(allocator_data.getStorageSize()), memory_resource(memory_resource),
+      on_destruction(skip_destruction ? 0 : allocator_data.num_types_to_destroy), skip_destruction(skip_destruction) {
+  if (storage_size != 0) {
+    if (memory_resource != nullptr) {
+      // initAreas() aligns the areas, so the storage itself doesn't need any alignment.
+      storage_begin = static_cast<char*>(memory_resource->allocate(storage_size, 1));
+      if (storage_begin == nullptr) {
+#if FRUIT_HAS_EXCEPTIONS
+        throw std::bad_alloc();
+#else
+        std::abort(); // LCOV_EXCL_LINE
+#endif
+      }
+    } else {
+      storage_begin = storage_allocator.allocate(storage_size);
+    }
+  }
+  initAreas(allocator_data);
+}
+
+inline void FixedSizeAllocator::initAreas(const FixedSizeAllocatorData& allocator_data) {
+  // The exact areas are laid out by decreasing alignment, so that only the first one needs padding.
+  char* p = storage_begin;
+  bool aligned = false;
+  for (std::size_t i = num_areas - 1; i-- > 0;) {
+    if (!aligned && allocator_data.area_sizes[i] != 0) {
+      std::size_t alignment = std::size_t(1) << i;
+      p += (alignment - std::uintptr_t(p) % alignment) % alignment;
+      aligned = true;
+    }
+    next_free[i] = p;
+    p += allocator_data.area_sizes[i];
+  }
+  next_free[num_areas - 1] = p;
 #if FRUIT_EXTRA_DEBUG
+  FruitAssert(p + allocator_data.area_sizes[num_areas - 1] <= storage_begin + storage_size);
   remaining_types = allocator_data.types;
   std::cerr << "Constructing allocator for types:";
   for (auto x : remaining_types) {
@@ -113,10 +230,22 @@ inline FixedSizeAllocator::FixedSizeAllocator(const FixedSizeAllocatorData& allo
 #endif
 }
 
+inline std::size_t FixedSizeAllocator::maximumRequiredSpace(const FixedSizeAllocatorData& allocator_data,
+                                                            bool skip_destruction) {
+  return MemoryRegion::maximumRequiredSpace<char>(allocator_data.getStorageSize()) +
+         MemoryRegion::maximumRequiredSpace<std::pair<destroy_t, void*>>(
+             skip_destruction ? 0 : allocator_data.num_types_to_destroy);
+}
+
 inline FixedSizeAllocator::FixedSizeAllocator(FixedSizeAllocator&& x) noexcept : FixedSizeAllocator() {
   std::swap(storage_begin, x.storage_begin);
-  std::swap(storage_last_used, x.storage_last_used);
+  std::swap(next_free, x.next_free);
+  std::swap(storage_size, x.storage_size);
+  std::swap(storage_allocator, x.storage_allocator);
+  std::swap(memory_resource, x.memory_resource);
   std::swap(on_destruction, x.on_destruction);
+  std::swap(mutex, x.mutex);
+  std::swap(skip_destruction, x.skip_destruction);
 #if FRUIT_EXTRA_DEBUG
   std::swap(remaining_types, x.remaining_types);
 #endif
@@ -124,8 +253,13 @@ inline FixedSizeAllocator::FixedSizeAllocator(FixedSizeAllocator&& x) noexcept :
 
 inline FixedSizeAllocator& FixedSizeAllocator::operator=(FixedSizeAllocator&& x) noexcept {
   std::swap(storage_begin, x.storage_begin);
-  std::swap(storage_last_used, x.storage_last_used);
+  std::swap(next_free, x.next_free);
+  std::swap(storage_size, x.storage_size);
+  std::swap(storage_allocator, x.storage_allocator);
+  std::swap(memory_resource, x.memory_resource);
   std::swap(on_destruction, x.on_destruction);
+  std::swap(mutex, x.mutex);
+  std::swap(skip_destruction, x.skip_destruction);
 #if FRUIT_EXTRA_DEBUG
   std::swap(remaining_types, x.remaining_types);
 #endif
@@ -18,8 +18,13 @@
 #define FRUIT_FIXED_SIZE_ALLOCATOR_H
 
 #include <fruit/impl/data_structures/fixed_size_vector.h>
+#include <fruit/impl/data_structures/memory_region.h>
+#include <fruit/impl/data_structures/region_allocator.h>
 #include <fruit/impl/meta/component.h>
 #include <fruit/impl/util/type_info.h>
+#include <fruit/memory_resource.h>
+
+#include <mutex>
 
 #if FRUIT_EXTRA_DEBUG
 #include <unordered_map>
@@ -31,18 +36,41 @@ namespace impl {
 /**
  * An allocator where the maximum total size is fixed at construction, and all memory is retained until the allocator
  * object itself is destructed.
+ *
+ * The storage is split in an area for each alignment, laid out by decreasing alignment. Since the size of a type is a
+ * multiple of its alignment, objects are packed without any padding (except for types with an alignment larger than
+ * max_exact_alignment, that are rare).
  */
 class FixedSizeAllocator {
 public:
   using destroy_t = void (*)(void*);
 
+  // Types with an alignment up to this are stored without padding.
+  static constexpr std::size_t max_exact_alignment = 128;
+
+  // The number of storage areas: one for each power of 2 up to max_exact_alignment, and one for the types with a
+  // larger alignment.
+  static constexpr std::size_t num_areas = 9;
+
 private:
-  // A pointer to the last used byte in the allocated memory chunk starting at storage_begin.
-  char* storage_last_used = nullptr;
+  // Returns the index of the storage area for objects with the specified alignment (that is a power of 2).
+  static constexpr std::size_t getAreaIndex(std::size_t alignment, std::size_t index = 0);
+
+  // For each storage area, a pointer to the first unused byte in it.
+  char* next_free[num_areas] = {};
 
   // The chunk of memory that will be used for all allocations.
   char* storage_begin = nullptr;
 
+  // The size of the chunk of memory starting at storage_begin.
+  std::size_t storage_size = 0;
+
+  // The allocator used for storage_begin, unless memory_resource is not nullptr.
+  RegionAllocator<char> storage_allocator;
+
+  // If not nullptr, storage_begin was allocated from this resource.
+  MemoryResource* memory_resource = nullptr;
+
 #if FRUIT_EXTRA_DEBUG
   std::unordered_map<TypeId, std::size_t> remaining_types;
 #endif
@@ -50,7 +78,26 @@ private:
   // This vector contains the destroy operations that have to be performed at destruction, and
   // the pointers that they must be invoked with. Allows destruction in the correct order.
   // These must be called in reverse order.
-  FixedSizeVector<std::pair<destroy_t, void*>> on_destruction;
+  FixedSizeVector<std::pair<destroy_t, void*>, RegionAllocator<std::pair<destroy_t, void*>>> on_destruction;
+
+  // If not nullptr, this is locked while modifying the fields above, so that constructObject() and
+  // registerExternallyAllocatedObject() can be called concurrently by multiple threads.
+  // This is *not* locked while running constructors.
+  std::mutex* mutex = nullptr;
+
+  // If true, the objects are not destroyed when this allocator is destroyed (and externally allocated objects are not
+  // deleted); only the allocator's storage is released, in O(1). In this case on_destruction has no capacity.
+  bool skip_destruction = false;
+
+  // Locks `mutex' (if any) until the end of the scope.
+  class OptionalLockGuard {
+  private:
+    std::mutex* mutex;
+
+  public:
+    explicit OptionalLockGuard(std::mutex* mutex);
+    ~OptionalLockGuard();
+  };
 
   // Destroys an object previously created using constructObject().
   template <typename C>
@@ -64,13 +111,16 @@ public:
   // Data used to construct an allocator for a fixed set of types.
   class FixedSizeAllocatorData {
   private:
-    std::size_t total_size = 0;
+    // The size of each storage area.
+    std::size_t area_sizes[num_areas] = {};
     std::size_t num_types_to_destroy = 0;
 #if FRUIT_EXTRA_DEBUG
     std::unordered_map<TypeId, std::size_t> types;
 #endif
 
-    static std::size_t maximumRequiredSpace(TypeId type);
+    // The size of the storage of an allocator for this type set. This is the sum of the sizes of the areas, plus the
+    // padding needed to align the first one.
+    std::size_t getStorageSize() const;
 
     friend class FixedSizeAllocator;
 
@@ -83,13 +133,33 @@ public:
     // resulting
     // allocator.
     void addExternallyAllocatedType(TypeId typeId);
+
+    // Undoes a previous addType(typeId) call.
+    void removeType(TypeId typeId);
+
+    // Undoes a previous addExternallyAllocatedType(typeId) call.
+    void removeExternallyAllocatedType(TypeId typeId);
   };
 
   // Constructs an empty allocator (no allocations are allowed).
   FixedSizeAllocator() = default;
 
   // Constructs an allocator for the type set in FixedSizeAllocatorData.
-  explicit FixedSizeAllocator(const FixedSizeAllocatorData& allocator_data);
+  // If `region' is not nullptr, the allocator's memory is allocated from it, and it must have at least
+  // maximumRequiredSpace(allocator_data, skip_destruction) bytes available.
+  // If `skip_destruction' is true, the objects are not destroyed when this allocator is destroyed (and externally
+  // allocated objects are not deleted); only the allocator's storage is released, in O(1).
+  explicit FixedSizeAllocator(const FixedSizeAllocatorData& allocator_data, MemoryRegion* region = nullptr,
+                              bool skip_destruction = false);
+
+  // Constructs an allocator for the type set in FixedSizeAllocatorData, whose objects are stored in memory allocated
+  // from `memory_resource' (if it's not nullptr). The allocator's bookkeeping data is still allocated from the heap.
+  FixedSizeAllocator(const FixedSizeAllocatorData& allocator_data, MemoryResource* memory_resource,
+                     bool skip_destruction = false);
+
+  // An upper bound on the memory that the first constructor allocates from the MemoryRegion (if any).
+  static std::size_t maximumRequiredSpace(const FixedSizeAllocatorData& allocator_data,
+                                          bool skip_destruction = false);
 
   FixedSizeAllocator(FixedSizeAllocator&&) noexcept;
   FixedSizeAllocator& operator=(FixedSizeAllocator&&) noexcept;
@@ -98,7 +168,7 @@ public:
   FixedSizeAllocator& operator=(const FixedSizeAllocator&) = delete;
 
   // On destruction, all objects allocated with constructObject() and all externally-allocated objects registered with
-  // registerExternallyAllocatedObject() are destroyed.
+  // registerExternallyAllocatedObject() are destroyed (unless the allocator was constructed with skip_destruction).
   ~FixedSizeAllocator();
 
   // Allocates an object of type T, constructing it with the specified arguments. Similar to:
@@ -110,6 +180,15 @@ public:
 
   template <typename T>
   void registerExternallyAllocatedObject(T* p);
+
+  // If `mutex' is not nullptr, after this call the allocator can be used concurrently by multiple threads, and it will
+  // use `mutex' for synchronization. `mutex' must outlive this allocator (or the next setMutex() call).
+  // If `mutex' is nullptr, the allocator goes back to not being thread-safe.
+  void setMutex(std::mutex* mutex);
+
+private:
+  // Sets next_free to the beginning of each storage area, after allocating storage_begin.
+  void initAreas(const FixedSizeAllocatorData& allocator_data);
 };
 
 } // namespace impl
@@ -80,6 +80,7 @@ inline void FixedSizeVector<T, Allocator>::swap(FixedSizeVector& x) noexcept {
   std::swap(v_end, x.v_end);
   std::swap(v_begin, x.v_begin);
   std::swap(capacity, x.capacity);
+  std::swap(allocator, x.allocator);
 }
 
 template <typename T, typename Allocator>
@@ -94,6 +95,13 @@ inline void FixedSizeVector<T, Allocator>::push_back(T x) {
 #endif
 }
 
+template <typename T, typename Allocator>
+inline void FixedSizeVector<T, Allocator>::appendZeroFilled(std::size_t n) {
+  FruitAssert(v_end == v_begin);
+  FruitAssert(n <= capacity);
+  v_end += n;
+}
+
 // This method is covered by tests, even though lcov doesn't detect that.
 template <typename T, typename Allocator>
 inline T* FixedSizeVector<T, Allocator>::data() {
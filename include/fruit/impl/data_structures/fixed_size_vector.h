@@ -52,6 +52,8 @@ public:
   // Copy construction is not allowed, you need to specify the capacity in order to construct the copy.
   FixedSizeVector(const FixedSizeVector& other) = delete;
   FixedSizeVector(const FixedSizeVector& other, std::size_t capacity);
+  // Same as the previous constructor, but the copy uses `allocator' instead of a copy of other's allocator.
+  FixedSizeVector(const FixedSizeVector& other, std::size_t capacity, Allocator allocator);
 
   FixedSizeVector(FixedSizeVector&& other) noexcept;
 
@@ -66,6 +68,12 @@ public:
   // This yields undefined behavior (instead of reallocating) if the vector's capacity is exceeded.
   void push_back(T x);
 
+  // Appends n elements without writing to them, so their value is whatever the memory already contains.
+  // This must only be used with an allocator that returns zero-filled memory (e.g. CallocAllocator), when an all-zero
+  // T is a valid value, and before any other element is added or removed.
+  void appendZeroFilled(std::size_t n);
+
+  // This also swaps the allocators.
   void swap(FixedSizeVector& x) noexcept;
 
   // Removes all elements, so size() becomes 0 (but maintains the capacity).
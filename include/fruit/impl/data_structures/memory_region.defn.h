@@ -0,0 +1,50 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_MEMORY_REGION_DEFN_H
+#define FRUIT_MEMORY_REGION_DEFN_H
+
+#include <fruit/impl/data_structures/memory_region.h>
+#include <fruit/impl/fruit_assert.h>
+
+#include <cstdint>
+
+namespace fruit {
+namespace impl {
+
+inline MemoryRegion::MemoryRegion(char* begin, std::size_t size) : first_free(begin), end(begin + size) {}
+
+template <typename T>
+inline T* MemoryRegion::allocate(std::size_t n) {
+  std::size_t misalignment = std::uintptr_t(first_free) % alignof(T);
+  if (misalignment != 0) {
+    first_free += alignof(T) - misalignment;
+  }
+  T* p = reinterpret_cast<T*>(first_free);
+  first_free += n * sizeof(T);
+  FruitAssert(first_free <= end);
+  return p;
+}
+
+template <typename T>
+inline std::size_t MemoryRegion::maximumRequiredSpace(std::size_t n) {
+  return n * sizeof(T) + alignof(T) - 1;
+}
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_MEMORY_REGION_DEFN_H
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_MEMORY_REGION_H
+#define FRUIT_MEMORY_REGION_H
+
+#include <cstddef>
+
+namespace fruit {
+namespace impl {
+
+/**
+ * A chunk of memory (owned by someone else) from which arrays are allocated in order, without any further
+ * allocation. This is used to carve all the data of an object out of a single allocation: the size of the chunk is
+ * computed in advance as the sum of maximumRequiredSpace<T>(n) for all the arrays that will be allocated.
+ * See also RegionAllocator, an Allocator backed by a MemoryRegion object.
+ */
+class MemoryRegion {
+private:
+  // The memory block [first_free, end) is available for allocation.
+  char* first_free;
+  char* end;
+
+public:
+  // The memory in [begin, begin + size) must outlive all the arrays allocated from this region. It doesn't need to be
+  // initialized: the users of the region initialize all the memory that they read.
+  MemoryRegion(char* begin, std::size_t size);
+
+  MemoryRegion(const MemoryRegion&) = delete;
+  MemoryRegion& operator=(const MemoryRegion&) = delete;
+
+  /**
+   * Returns an uninitialized chunk of memory that can hold n T objects.
+   * Note that this does *not* construct any T objects at that location.
+   * There must be enough space left in the region; this is not checked except in debug mode.
+   */
+  template <typename T>
+  T* allocate(std::size_t n);
+
+  /**
+   * Returns the amount of memory that allocate<T>(n) takes from the region (at most, depending on the alignment).
+   * This is also correct for n==0, even though FixedSizeVector doesn't allocate anything in that case.
+   */
+  template <typename T>
+  static std::size_t maximumRequiredSpace(std::size_t n);
+};
+
+} // namespace impl
+} // namespace fruit
+
+#include <fruit/impl/data_structures/memory_region.defn.h>
+
+#endif // FRUIT_MEMORY_REGION_H
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_REGION_ALLOCATOR_DEFN_H
+#define FRUIT_REGION_ALLOCATOR_DEFN_H
+
+#include <fruit/impl/data_structures/region_allocator.h>
+
+namespace fruit {
+namespace impl {
+
+template <typename T, typename BaseAllocator>
+inline RegionAllocator<T, BaseAllocator>::RegionAllocator() : region(nullptr) {}
+
+template <typename T, typename BaseAllocator>
+inline RegionAllocator<T, BaseAllocator>::RegionAllocator(MemoryRegion* region) : region(region) {}
+
+template <typename T, typename BaseAllocator>
+template <typename U, typename OtherBaseAllocator>
+inline RegionAllocator<T, BaseAllocator>::RegionAllocator(const RegionAllocator<U, OtherBaseAllocator>& other)
+    : region(other.region) {}
+
+template <typename T, typename BaseAllocator>
+inline T* RegionAllocator<T, BaseAllocator>::allocate(std::size_t n) {
+  if (region != nullptr) {
+    return region->allocate<T>(n);
+  }
+  return BaseAllocator().allocate(n);
+}
+
+template <typename T, typename BaseAllocator>
+inline void RegionAllocator<T, BaseAllocator>::deallocate(T* p, std::size_t n) {
+  if (region == nullptr) {
+    BaseAllocator().deallocate(p, n);
+  }
+  // Otherwise the memory will be deallocated by the owner of the region.
+}
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_REGION_ALLOCATOR_DEFN_H
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_REGION_ALLOCATOR_H
+#define FRUIT_REGION_ALLOCATOR_H
+
+#include <fruit/impl/data_structures/memory_region.h>
+
+#include <memory>
+
+namespace fruit {
+namespace impl {
+
+/**
+ * An allocator that allocates from a MemoryRegion if one is specified, or using BaseAllocator otherwise.
+ * In the former case deallocate() is a no-op, since the memory is owned by the owner of the region.
+ *
+ * This is used for the data structures of an injector, so that the ones of an injector created from a
+ * NormalizedComponent can be carved out of a single allocation, while other instances of the same types still use
+ * BaseAllocator.
+ */
+template <typename T, typename BaseAllocator = std::allocator<T>>
+class RegionAllocator {
+private:
+  // Can be nullptr. This is only dereferenced in allocate().
+  MemoryRegion* region;
+
+  template <class U, class OtherBaseAllocator>
+  friend class RegionAllocator;
+
+public:
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = RegionAllocator<U, typename std::allocator_traits<BaseAllocator>::template rebind_alloc<U>>;
+  };
+
+  /**
+   * Constructs an allocator that uses BaseAllocator.
+   */
+  RegionAllocator();
+
+  /**
+   * Constructs an allocator that allocates from `region' if it's not nullptr, or uses BaseAllocator otherwise.
+   * The region (if any) must outlive all allocate() calls, but not the allocated objects nor this allocator.
+   */
+  explicit RegionAllocator(MemoryRegion* region);
+
+  template <typename U, typename OtherBaseAllocator>
+  RegionAllocator(const RegionAllocator<U, OtherBaseAllocator>&); // NOLINT(google-explicit-constructor)
+
+  T* allocate(std::size_t n);
+  void deallocate(T* p, std::size_t n);
+};
+
+} // namespace impl
+} // namespace fruit
+
+#include <fruit/impl/data_structures/region_allocator.defn.h>
+
+#endif // FRUIT_REGION_ALLOCATOR_H
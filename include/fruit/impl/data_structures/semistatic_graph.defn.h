@@ -18,10 +18,29 @@
 #define SEMISTATIC_GRAPH_DEFN_H
 
 #include <fruit/impl/data_structures/semistatic_graph.h>
+#include <fruit/impl/util/atomic_helpers.h>
 
 namespace fruit {
 namespace impl {
 
+template <typename NodeId>
+inline std::size_t DenseNodeIndex<NodeId>::get(NodeId) {
+  return 0;
+}
+
+template <typename NodeId>
+inline std::size_t DenseNodeIndex<NodeId>::getOrAssign(NodeId) {
+  return 0;
+}
+
+inline std::size_t DenseNodeIndex<TypeId>::get(TypeId id) {
+  return id.type_info->denseIndex();
+}
+
+inline std::size_t DenseNodeIndex<TypeId>::getOrAssign(TypeId id) {
+  return id.type_info->getOrAssignDenseIndex();
+}
+
 inline bool SemistaticGraphInternalNodeId::operator==(const SemistaticGraphInternalNodeId& x) const {
   return id == x.id;
 }
@@ -31,69 +50,143 @@ inline bool SemistaticGraphInternalNodeId::operator<(const SemistaticGraphIntern
 }
 
 template <typename NodeId, typename Node>
-inline SemistaticGraph<NodeId, Node>::node_iterator::node_iterator(NodeData* itr) : itr(itr) {}
+inline SemistaticGraph<NodeId, Node>::node_iterator::node_iterator(SemistaticGraph* graph, std::size_t index)
+    : graph(graph), index(index) {}
 
 template <typename NodeId, typename Node>
-inline Node& SemistaticGraph<NodeId, Node>::node_iterator::getNode() {
-  FruitAssert(itr->edges_begin != 1);
-  return itr->node;
+inline const Node& SemistaticGraph<NodeId, Node>::node_iterator::getNode() {
+  return graph->getNodeValue(index, overlay_node);
 }
 
 template <typename NodeId, typename Node>
 inline bool SemistaticGraph<NodeId, Node>::node_iterator::isTerminal() {
-  FruitAssert(itr->edges_begin != 1);
-  return itr->edges_begin == 0;
+  FruitAssert(graph->loadEdgesBegin(index, overlay_node) != missing_node);
+  // Pairs with the release operation in setTerminal(), so that if this returns true the node is also visible.
+  return graph->isTerminalNode(index, overlay_node);
 }
 
 template <typename NodeId, typename Node>
 inline void SemistaticGraph<NodeId, Node>::node_iterator::setTerminal() {
-  FruitAssert(itr->edges_begin != 1);
-  itr->edges_begin = 0;
+  FruitAssert(graph->loadEdgesBegin(index, overlay_node) != missing_node);
+  if (graph->is_overlay) {
+    // This materializes the node (if needed), copying its value from the base graph.
+    atomicStoreRelease(graph->getMutableEdgesBegin(index, overlay_node), std::uintptr_t(terminal_node));
+  } else {
+    graph->setTerminalBit(index);
+  }
+}
+
+template <typename NodeId, typename Node>
+inline void SemistaticGraph<NodeId, Node>::node_iterator::setTerminal(const Node& node) {
+  FruitAssert(graph->loadEdgesBegin(index, overlay_node) != missing_node);
+  if (graph->is_overlay) {
+    OverlayNode* node_ptr = graph->getOrMaterializeOverlayNode(index, overlay_node);
+    node_ptr->value = node;
+    atomicStoreRelease(&node_ptr->edges_begin, std::uintptr_t(terminal_node));
+  } else {
+    graph->nodes[index] = node;
+    graph->setTerminalBit(index);
+  }
+}
+
+template <typename NodeId, typename Node>
+inline bool SemistaticGraph<NodeId, Node>::node_iterator::tryClaim() {
+  if (graph->hasBaseTerminalBit(index)) {
+    // Checked first to avoid materializing the node.
+    return false;
+  }
+  std::uintptr_t* edges_begin_ptr = graph->getMutableEdgesBegin(index, overlay_node);
+  std::uintptr_t edges_begin = atomicLoadAcquire(edges_begin_ptr);
+  FruitAssert(edges_begin != missing_node);
+  if (edges_begin == terminal_node || (edges_begin & 1) != 0) {
+    return false;
+  }
+  return atomicCompareExchange(edges_begin_ptr, edges_begin, edges_begin | 1);
+}
+
+template <typename NodeId, typename Node>
+inline bool SemistaticGraph<NodeId, Node>::node_iterator::isClaimed() {
+  return (graph->loadEdgesBegin(index, overlay_node) & 1) != 0;
+}
+
+template <typename NodeId, typename Node>
+inline void SemistaticGraph<NodeId, Node>::node_iterator::unclaim() {
+  // The node was materialized by tryClaim(), so this doesn't materialize anything.
+  std::uintptr_t* edges_begin_ptr = graph->getMutableEdgesBegin(index, overlay_node);
+  FruitAssert((*edges_begin_ptr & 1) != 0);
+  atomicStoreRelease(edges_begin_ptr, *edges_begin_ptr & ~std::uintptr_t(1));
 }
 
 template <typename NodeId, typename Node>
 inline bool SemistaticGraph<NodeId, Node>::node_iterator::operator==(const node_iterator& other) const {
-  return itr == other.itr;
+  return graph == other.graph && index == other.index;
 }
 
 template <typename NodeId, typename Node>
-inline SemistaticGraph<NodeId, Node>::const_node_iterator::const_node_iterator(const NodeData* itr) : itr(itr) {}
+inline SemistaticGraph<NodeId, Node>::const_node_iterator::const_node_iterator(const SemistaticGraph* graph,
+                                                                              std::size_t index)
+    : graph(graph), index(index) {}
 
-template<typename NodeId, typename Node>
-inline SemistaticGraph<NodeId, Node>::const_node_iterator::const_node_iterator(node_iterator itr) : itr(itr.itr) {}
+template <typename NodeId, typename Node>
+inline SemistaticGraph<NodeId, Node>::const_node_iterator::const_node_iterator(node_iterator itr)
+    : graph(itr.graph), index(itr.index), overlay_node(itr.overlay_node) {}
 
 template <typename NodeId, typename Node>
 inline const Node& SemistaticGraph<NodeId, Node>::const_node_iterator::getNode() {
-  FruitAssert(itr->edges_begin != 1);
-  return itr->node;
+  return graph->getNodeValue(index, overlay_node);
 }
 
 template <typename NodeId, typename Node>
 inline bool SemistaticGraph<NodeId, Node>::const_node_iterator::isTerminal() {
-  FruitAssert(itr->edges_begin != 1);
-  return itr->edges_begin == 0;
+  FruitAssert(graph->loadEdgesBegin(index, overlay_node) != missing_node);
+  return graph->isTerminalNode(index, overlay_node);
 }
 
 template <typename NodeId, typename Node>
 inline bool SemistaticGraph<NodeId, Node>::const_node_iterator::operator==(const const_node_iterator& other) const {
-  return itr == other.itr;
+  return graph == other.graph && index == other.index;
 }
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::edge_iterator
 SemistaticGraph<NodeId, Node>::node_iterator::neighborsBegin() {
-  FruitAssert(itr->edges_begin != 0);
-  FruitAssert(itr->edges_begin != 1);
-  return edge_iterator{reinterpret_cast<InternalNodeId*>(itr->edges_begin)}; // NOLINT(performance-no-int-to-ptr)
+  // The low-order bit is masked out since the node might be claimed.
+  std::uintptr_t edges_begin = graph->loadEdgesBegin(index, overlay_node) & ~std::uintptr_t(1);
+  FruitAssert(edges_begin != terminal_node);
+  FruitAssert(edges_begin != missing_node);
+  return edge_iterator{reinterpret_cast<InternalNodeId*>(edges_begin)}; // NOLINT(performance-no-int-to-ptr)
+}
+
+template <typename NodeId, typename Node>
+inline typename SemistaticGraph<NodeId, Node>::edge_iterator
+SemistaticGraph<NodeId, Node>::node_iterator::neighborsEnd() {
+  InternalNodeId* edges_begin = neighborsBegin().itr;
+  // The element before the edges stores the number of edges.
+  return edge_iterator{edges_begin + edges_begin[-1].id};
+}
+
+template <typename NodeId, typename Node>
+inline std::ptrdiff_t SemistaticGraph<NodeId, Node>::node_iterator::operator-(const node_iterator& other) const {
+  return std::ptrdiff_t(index) - std::ptrdiff_t(other.index);
 }
 
 template <typename NodeId, typename Node>
 inline SemistaticGraph<NodeId, Node>::edge_iterator::edge_iterator(InternalNodeId* itr) : itr(itr) {}
 
+template <typename NodeId, typename Node>
+inline bool SemistaticGraph<NodeId, Node>::edge_iterator::operator==(const edge_iterator& other) const {
+  return itr == other.itr;
+}
+
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::node_iterator
 SemistaticGraph<NodeId, Node>::edge_iterator::getNodeIterator(node_iterator nodes_begin) {
-  return node_iterator{nodeAtId(nodes_begin.itr, *itr)};
+  return node_iterator{nodes_begin.graph, itr->id & ~lazy_edge_bit};
+}
+
+template <typename NodeId, typename Node>
+inline bool SemistaticGraph<NodeId, Node>::edge_iterator::isLazy() const {
+  return (itr->id & lazy_edge_bit) != 0;
 }
 
 template <typename NodeId, typename Node>
@@ -110,86 +203,237 @@ SemistaticGraph<NodeId, Node>::edge_iterator::getNodeIterator(std::size_t i, nod
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::node_iterator SemistaticGraph<NodeId, Node>::begin() {
-  return node_iterator{nodes.begin()};
+  return node_iterator{this, 0};
 }
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::node_iterator SemistaticGraph<NodeId, Node>::end() {
-  return node_iterator{nodes.end()};
+  return node_iterator{this, first_unused_index};
 }
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::const_node_iterator SemistaticGraph<NodeId, Node>::end() const {
-  return const_node_iterator{nodes.end()};
+  return const_node_iterator{this, first_unused_index};
 }
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::node_iterator SemistaticGraph<NodeId, Node>::at(NodeId nodeId) {
-  InternalNodeId internalNodeId = node_index_map.at(nodeId);
-  return node_iterator{nodeAtId(internalNodeId)};
+  std::size_t dense_node_id = findInDenseNodeIds(nodeId);
+  if (dense_node_id != 0) {
+    return node_iterator{this, dense_node_id - 1};
+  }
+  return node_iterator{this, node_index_map.at(nodeId).id};
 }
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::const_node_iterator
 SemistaticGraph<NodeId, Node>::find(NodeId nodeId) const {
-  const InternalNodeId* internalNodeIdPtr = node_index_map.find(nodeId);
-  if (internalNodeIdPtr == nullptr) {
-    return const_node_iterator{nodes.end()};
+  std::size_t index;
+  std::size_t dense_node_id = findInDenseNodeIds(nodeId);
+  if (dense_node_id != 0) {
+    index = dense_node_id - 1;
   } else {
-    const NodeData* p = nodeAtId(*internalNodeIdPtr);
-    if (p->edges_begin == 1) {
-      return const_node_iterator{nodes.end()};
+    const InternalNodeId* internalNodeIdPtr = node_index_map.find(nodeId);
+    if (internalNodeIdPtr == nullptr) {
+      return end();
     }
-    return const_node_iterator{p};
+    index = internalNodeIdPtr->id;
+  }
+  const_node_iterator itr{this, index};
+  if (loadEdgesBegin(index, itr.overlay_node) == missing_node) {
+    return end();
   }
+  return itr;
 }
 
 template <typename NodeId, typename Node>
 inline typename SemistaticGraph<NodeId, Node>::node_iterator SemistaticGraph<NodeId, Node>::find(NodeId nodeId) {
-  const InternalNodeId* internalNodeIdPtr = node_index_map.find(nodeId);
-  if (internalNodeIdPtr == nullptr) {
-    return node_iterator{nodes.end()};
-  } else {
-    NodeData* p = nodeAtId(*internalNodeIdPtr);
-    if (p->edges_begin == 1) {
-      return node_iterator{nodes.end()};
+  const_node_iterator itr = static_cast<const SemistaticGraph*>(this)->find(nodeId);
+  node_iterator result{this, itr.index};
+  result.overlay_node = itr.overlay_node;
+  return result;
+}
+
+template <typename NodeId, typename Node>
+inline std::size_t SemistaticGraph<NodeId, Node>::maxNumDenseNodeIds(std::size_t num_node_ids) {
+  // This bounds the memory used by dense_node_ids to a few times the memory used by node_index_map for the same IDs.
+  return 4 * num_node_ids + 64;
+}
+
+template <typename NodeId, typename Node>
+inline std::size_t SemistaticGraph<NodeId, Node>::findInDenseNodeIds(NodeId nodeId) const {
+  std::size_t dense_index = DenseNodeIndex<NodeId>::get(nodeId);
+  // These subtractions wrap around (giving an out-of-range position) for dense indexes below the offsets, and also for
+  // dense_index==0 since dense indexes start from 1.
+  std::size_t position = dense_index - dense_node_ids_offset;
+  if (position < dense_node_ids.size()) {
+    std::size_t dense_node_id = dense_node_ids.begin()[position];
+    if (dense_node_id != 0) {
+      return dense_node_id;
+    }
+  }
+  std::size_t base_position = dense_index - base_dense_node_ids_offset;
+  if (base_position < base_dense_node_ids_size) {
+    return base_dense_node_ids[base_position];
+  }
+  return 0;
+}
+
+template <typename NodeId, typename Node>
+inline void SemistaticGraph<NodeId, Node>::MaterializedNodesDeleter::operator()(MaterializedNodes* materialized_nodes) {
+  while (materialized_nodes != nullptr) {
+    MaterializedNodes* previous = materialized_nodes->previous;
+    if (materialized_nodes->heap_allocated) {
+      ::operator delete(materialized_nodes);
+    }
+    materialized_nodes = previous;
+  }
+}
+
+template <typename NodeId, typename Node>
+inline std::size_t SemistaticGraph<NodeId, Node>::initialMaterializedNodesCapacity(std::size_t num_node_slots) {
+  return num_node_slots < 8 ? 8 - num_node_slots : 0;
+}
+
+template <typename NodeId, typename Node>
+inline std::size_t SemistaticGraph<NodeId, Node>::hashNodeIndex(std::size_t index, std::size_t table_shift) {
+  // Fibonacci hashing: the multiplier is 2^bits_per_hash divided by the golden ratio.
+  return (index * std::size_t(0x9E3779B97F4A7C15U >> (64 - bits_per_hash))) >> table_shift;
+}
+
+template <typename NodeId, typename Node>
+inline typename SemistaticGraph<NodeId, Node>::OverlayNode*
+SemistaticGraph<NodeId, Node>::findOverlayNode(std::size_t index) const {
+  FruitAssert(is_overlay);
+  if (index >= base_num_nodes) {
+    return const_cast<OverlayNode*>(new_nodes.data() + (index - base_num_nodes));
+  }
+  if (slot_nodes.size() != 0) {
+    // This wraps around (giving an out-of-range position) for the nodes without a slot.
+    std::size_t position = std::size_t(atomicLoadRelaxed(base_node_slots + index)) - 1;
+    if (position < slot_nodes.size()) {
+      // The nodes with a slot are never in the hash table.
+      return const_cast<OverlayNode*>(slot_nodes.data() + position);
+    }
+  }
+  return findMaterializedNode(index);
+}
+
+template <typename NodeId, typename Node>
+inline typename SemistaticGraph<NodeId, Node>::OverlayNode*
+SemistaticGraph<NodeId, Node>::findOverlayNode(std::size_t index, OverlayNode*& cached_node) const {
+  if (cached_node == nullptr) {
+    cached_node = findOverlayNode(index);
+  }
+  return cached_node;
+}
+
+template <typename NodeId, typename Node>
+inline typename SemistaticGraph<NodeId, Node>::OverlayNode*
+SemistaticGraph<NodeId, Node>::getOrMaterializeOverlayNode(std::size_t index, OverlayNode*& cached_node) {
+  OverlayNode* node = findOverlayNode(index, cached_node);
+  if (node == nullptr || atomicLoadAcquire(&node->edges_begin) == inherited_node) {
+    cached_node = materializeOverlayNode(index);
+  }
+  return cached_node;
+}
+
+template <typename NodeId, typename Node>
+inline bool SemistaticGraph<NodeId, Node>::hasBaseTerminalBit(std::size_t index) const {
+  // The base graph is immutable, so this doesn't need an atomic load.
+  return index < base_num_nodes && (base_terminal_bits[index / bits_per_terminal_bits_word] &
+                                    (std::uintptr_t(1) << (index % bits_per_terminal_bits_word))) != 0;
+}
+
+template <typename NodeId, typename Node>
+inline bool SemistaticGraph<NodeId, Node>::isTerminalNode(std::size_t index, OverlayNode*& cached_node) const {
+  if (!is_overlay) {
+    std::uintptr_t word = atomicLoadAcquire(terminal_bits.data() + index / bits_per_terminal_bits_word);
+    return (word & (std::uintptr_t(1) << (index % bits_per_terminal_bits_word))) != 0;
+  }
+  // The nodes that are terminal in the base graph are never materialized, so this check can be skipped if the node
+  // was already found.
+  if (cached_node == nullptr && hasBaseTerminalBit(index)) {
+    return true;
+  }
+  OverlayNode* node = findOverlayNode(index, cached_node);
+  return node != nullptr && atomicLoadAcquire(&node->edges_begin) == terminal_node;
+}
+
+template <typename NodeId, typename Node>
+inline void SemistaticGraph<NodeId, Node>::setTerminalBit(std::size_t index) {
+  // The bit is set first, so that a thread that sees the node as terminal in node_edges_begins also sees the bit.
+  atomicFetchOrRelease(terminal_bits.data() + index / bits_per_terminal_bits_word,
+                       std::uintptr_t(1) << (index % bits_per_terminal_bits_word));
+  atomicStoreRelease(&node_edges_begins[index], std::uintptr_t(terminal_node));
+}
+
+template <typename NodeId, typename Node>
+inline const Node& SemistaticGraph<NodeId, Node>::getNodeValue(std::size_t index, OverlayNode*& cached_node) const {
+  FruitAssert(loadEdgesBegin(index, cached_node) != missing_node);
+  if (!is_overlay) {
+    return nodes.data()[index];
+  }
+  // See isTerminalNode().
+  if (cached_node == nullptr && hasBaseTerminalBit(index)) {
+    return base_nodes[index];
+  }
+  OverlayNode* node = findOverlayNode(index, cached_node);
+  // This is an acquire operation, in case the node has just become terminal (or has just been materialized).
+  if (node == nullptr || atomicLoadAcquire(&node->edges_begin) == inherited_node) {
+    return base_nodes[index];
+  }
+  return node->value;
+}
+
+template <typename NodeId, typename Node>
+inline std::uintptr_t SemistaticGraph<NodeId, Node>::loadEdgesBegin(std::size_t index, OverlayNode*& cached_node) const {
+  if (!is_overlay) {
+    return atomicLoadAcquire(node_edges_begins.data() + index);
+  }
+  OverlayNode* node = findOverlayNode(index, cached_node);
+  if (node != nullptr) {
+    std::uintptr_t edges_begin = atomicLoadAcquire(&node->edges_begin);
+    if (edges_begin != inherited_node) {
+      return edges_begin;
     }
-    return node_iterator{p};
   }
+  // The base graph is immutable, so this doesn't need an atomic load.
+  return base_node_edges_begins[index];
+}
+
+template <typename NodeId, typename Node>
+inline std::uintptr_t* SemistaticGraph<NodeId, Node>::getMutableEdgesBegin(std::size_t index, OverlayNode*& cached_node) {
+  if (!is_overlay) {
+    return &node_edges_begins[index];
+  }
+  return &getOrMaterializeOverlayNode(index, cached_node)->edges_begin;
+}
+
+template <typename NodeId, typename Node>
+inline void SemistaticGraph<NodeId, Node>::setMutex(std::mutex* mutex) {
+  this->mutex = mutex;
 }
 
 template <typename NodeId, typename Node>
-inline typename SemistaticGraph<NodeId, Node>::NodeData*
-SemistaticGraph<NodeId, Node>::nodeAtId(InternalNodeId internalNodeId) {
-  return nodeAtId(nodes.data(), internalNodeId);
+inline std::size_t SemistaticGraph<NodeId, Node>::getNumMaterializedNodes() const {
+  return num_materialized_nodes;
 }
 
 template <typename NodeId, typename Node>
-inline const typename SemistaticGraph<NodeId, Node>::NodeData*
-SemistaticGraph<NodeId, Node>::nodeAtId(InternalNodeId internalNodeId) const {
-  return nodeAtId(nodes.data(), internalNodeId);
+inline std::size_t SemistaticGraph<NodeId, Node>::NodeSlots::size() const {
+  // Pairs with the release operation in assignNodeSlots().
+  return atomicLoadAcquire(&num_slots);
 }
 
 template <typename NodeId, typename Node>
-inline typename SemistaticGraph<NodeId, Node>::NodeData*
-SemistaticGraph<NodeId, Node>::nodeAtId(NodeData* nodes_begin, InternalNodeId internalNodeId) {
-  FruitAssert(internalNodeId.id % sizeof(NodeData) == 0);
-  NodeData* p = reinterpret_cast<NodeData*>(reinterpret_cast<char*>(nodes_begin) + internalNodeId.id);
-  // The code above is faster (the compiler doesn't have to worry about internalNodeId.id%sizeof(NodeData), that we know
-  // to be 0).
-  FruitAssert(p == nodes_begin + internalNodeId.id / sizeof(NodeData));
-  return p;
+inline std::uintptr_t SemistaticGraph<NodeId, Node>::getHashMultiplier() const {
+  return node_index_map.getHashMultiplier();
 }
 
 template <typename NodeId, typename Node>
-inline const typename SemistaticGraph<NodeId, Node>::NodeData*
-SemistaticGraph<NodeId, Node>::nodeAtId(const NodeData* nodes_begin, InternalNodeId internalNodeId) {
-  FruitAssert(internalNodeId.id % sizeof(NodeData) == 0);
-  const NodeData* p = reinterpret_cast<const NodeData*>(reinterpret_cast<const char*>(nodes_begin) + internalNodeId.id);
-  // The code above is faster (the compiler doesn't have to worry about internalNodeId.id%sizeof(NodeData), that we know
-  // to be 0).
-  FruitAssert(p == nodes_begin + internalNodeId.id / sizeof(NodeData));
-  return p;
+inline std::size_t SemistaticGraph<NodeId, Node>::getNumHashFunctionRetries() const {
+  return node_index_map.getNumHashFunctionRetries();
 }
 
 } // namespace impl
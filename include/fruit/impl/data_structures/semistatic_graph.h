@@ -18,7 +18,16 @@
 #define SEMISTATIC_GRAPH_H
 
 #include "memory_pool.h"
+#include <fruit/impl/data_structures/calloc_allocator.h>
+#include <fruit/impl/data_structures/memory_region.h>
+#include <fruit/impl/data_structures/region_allocator.h>
 #include <fruit/impl/data_structures/semistatic_map.h>
+#include <fruit/impl/util/type_info.h>
+
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 
 #if FRUIT_EXTRA_DEBUG
 #include <iostream>
@@ -28,14 +37,39 @@ namespace fruit {
 namespace impl {
 
 // The alignas ensures that a SemistaticGraphInternalNodeId* always has 0 in the low-order bit.
-struct alignas(2) alignas(alignof(std::size_t)) SemistaticGraphInternalNodeId {
-  // This stores the index in the vector times sizeof(NodeData).
-  std::size_t id;
+// This is 32 bits (even on 64-bit platforms) to halve the memory used by the edges. In edges_storage the high-order
+// bit marks lazy edges, so graphs can't have more than 2^31-1 nodes.
+struct alignas(2) SemistaticGraphInternalNodeId {
+  // The index of the node in the graph's arrays (e.g. `nodes').
+  std::uint32_t id;
 
   bool operator==(const SemistaticGraphInternalNodeId& x) const;
   bool operator<(const SemistaticGraphInternalNodeId& x) const;
 };
 
+/**
+ * If this is specialized for a NodeId type, each NodeId in a SemistaticGraph<NodeId, ...> is given a dense index (a
+ * small positive integer, the same in all graphs) and the graph stores an array indexed by it (spanning only the range
+ * of dense indexes of its NodeIds), so that at() and find() are a single indexed load instead of a hash table lookup.
+ * The hash table is still used for NodeIds without a dense index, and for all NodeIds if their dense indexes are too
+ * sparse.
+ * The default implementation doesn't assign dense indexes.
+ */
+template <typename NodeId>
+struct DenseNodeIndex {
+  // Returns the dense index of `id', or 0 if it doesn't have one.
+  static std::size_t get(NodeId id);
+
+  // Returns the dense index of `id', assigning one if possible. Returns 0 if `id' can't have a dense index.
+  static std::size_t getOrAssign(NodeId id);
+};
+
+template <>
+struct DenseNodeIndex<TypeId> {
+  static std::size_t get(TypeId id);
+  static std::size_t getOrAssign(TypeId id);
+};
+
 /**
  * A direct graph implementation where most of the graph is fixed at construction time, but a few nodes and edges can be
  * added
@@ -45,13 +79,13 @@ struct alignas(2) alignas(alignof(std::size_t)) SemistaticGraphInternalNodeId {
  * with no
  * outgoing edges may or may not be marked as terminal.
  *
- * While insertion of elements after construction is supported, inserting or changing the neighbors of more than O(1)
- * nodes
- * after construction will raise the cost of any further operations to more than O(1).
+ * Nodes and edges can also be added after construction, by creating an overlay graph (see the 4-arg constructor) on an
+ * immutable base graph. The overlay only stores the new nodes and the nodes of the base graph whose state it changes
+ * (e.g. turning them into terminal nodes), so its size and construction cost scale with those and not with the size of
+ * the base graph. Lookups of nodes stored in the overlay stay O(1): the ones that already had a slot (see NodeSlots)
+ * when the overlay was created are found by direct indexing, the others through a hash table.
  *
- * Even though adding nodes/edges after construction is inefficient, it is efficient to turn non-terminal nodes into
- * terminal ones
- * (and therefore removing all the outgoing edges from the node) after construction.
+ * Turning a non-terminal node into a terminal one (removing all its outgoing edges) is O(1), in overlays too.
  *
  * NodeId and Node must be default constructible and trivially copyable.
  */
@@ -60,84 +94,297 @@ class SemistaticGraph {
 private:
   using InternalNodeId = SemistaticGraphInternalNodeId;
 
-  // The node data for nodeId is in nodes[node_index_map.at(nodeId)/sizeof(NodeData)].
-  // To avoid hash table lookups, the edges in edges_storage are stored as indexes of `nodes' instead of as NodeIds.
+  // The data for nodeId is at index node_index_map.at(nodeId).id of the arrays below.
+  // To avoid hash table lookups, the edges in edges_storage are stored as indexes instead of as NodeIds.
   // node_index_map contains all known NodeIds, including ones known only due to an outgoing edge ending there from
   // another node.
   SemistaticMap<NodeId, InternalNodeId> node_index_map;
 
-  struct NodeData {
-#if FRUIT_EXTRA_DEBUG
-    NodeId key;
-#endif
-
-  public:
-    // If edges_begin==0, this is a terminal node.
-    // If edges_begin==1, this node doesn't exist, it's just referenced by another node.
-    // Otherwise, reinterpret_cast<InternalNodeId*>(edges_begin) is the beginning of the edges range.
+  // The node data is split in a "hot" part (`nodes' and `terminal_bits'), that is all that's needed to get the value
+  // of a terminal node, and a "cold" part (`node_edges_begins') that is only used for non-terminal nodes.
+  // This way the lookups of terminal nodes (by far the most common ones once an injector is warmed up) only touch
+  // sizeof(Node) bytes per node, and don't pull the edges data into the CPU caches.
+  // Overlay graphs (see the 4-arg constructor) don't have these arrays, they store OverlayNode objects instead.
+
+  // The values in node_edges_begins (and in OverlayNode::edges_begin) are either pointers into edges_storage or one of
+  // these.
+  // If it's terminal_node, this is a terminal node.
+  // If it's missing_node, this node doesn't exist, it's just referenced by another node.
+  // If it's inherited_node (only used in the OverlayNode objects in slot_nodes), the node hasn't been materialized and
+  // its state is the one in the base graph.
+  // Otherwise, reinterpret_cast<InternalNodeId*>(x & ~1) is the beginning of the edges range.
+  // In the last two cases, the low-order bit is set iff the node has been claimed (see node_iterator::tryClaim()).
+  enum : std::uintptr_t { inherited_node = 0, terminal_node = 2, missing_node = 4 };
+
+  static constexpr std::size_t bits_per_terminal_bits_word = sizeof(std::uintptr_t) * 8;
+
+  // Set in the InternalNodeId elements of edges_storage for lazy edges (see edge_iterator::isLazy()).
+  static constexpr std::uint32_t lazy_edge_bit = std::uint32_t(1) << 31;
+
+  // The state of a node in an overlay graph. These only exist for the nodes added by the overlay, for the nodes of the
+  // base graph whose state has been changed in the overlay (e.g. with setTerminal() or tryClaim()) and for the nodes
+  // with a slot (see NodeSlots); the other nodes are read from the base graph.
+  struct OverlayNode {
+    Node value;
+    // Same as node_edges_begins, see above. This is terminal_node iff the node is terminal, and it's stored with a
+    // release operation after storing `value', so that once a thread sees it (with an acquire load) it can read the
+    // value without locking.
     std::uintptr_t edges_begin;
+  };
 
-    // An explicit "public" specifier here prevents the compiler from reordering the fields.
-    // We want the edges_begin field to be stored first because that's what we're going to branch on.
-  public:
-    Node node;
+  // A hash table with the OverlayNode objects of the nodes of the base graph materialized in an overlay graph, except
+  // the ones stored in slot_nodes.
+  // When this is full, a new one with twice the capacity is created, that points to the same OverlayNode objects plus
+  // a new chunk for the next ones. The old ones are kept until the graph is destroyed, since other threads might
+  // still be reading them.
+  struct MaterializedNodesTableEntry {
+    // A pointer to the OverlayNode, or 0 if the element is empty. Elements are only written while holding the graph's
+    // mutex, and this is stored last (with a release operation).
+    std::uintptr_t node;
+    std::size_t index;
+  };
+
+  // The number of bits of the hashes of node indexes in MaterializedNodes tables (see hashNodeIndex()).
+  static constexpr std::size_t bits_per_hash = sizeof(std::size_t) * CHAR_BIT;
+
+  struct MaterializedNodes {
+    // The MaterializedNodes object that this replaced, or nullptr.
+    MaterializedNodes* previous;
+    // True if this was allocated with operator new, false if it was allocated from a MemoryRegion.
+    bool heap_allocated;
+    // An open-addressing hash table (with linear probing) of the OverlayNode objects, by node index. The index is
+    // also stored in the table so that probing doesn't need to access the OverlayNode objects.
+    MaterializedNodesTableEntry* table;
+    // The table has 2^(bits_per_hash - table_shift) elements.
+    std::size_t table_shift;
+    // Storage for the OverlayNode objects materialized while this is the current MaterializedNodes object.
+    OverlayNode* nodes;
+    std::size_t num_nodes;
+    std::size_t capacity;
+    // The sum of `capacity' in this object and in all the previous ones.
+    std::size_t total_capacity;
+  };
+
+  // Frees the heap-allocated MaterializedNodes objects in a chain.
+  struct MaterializedNodesDeleter {
+    void operator()(MaterializedNodes* materialized_nodes);
   };
 
+  // The number of nodes (if this is not an overlay graph) or an upper bound on the index of nodes (if it is).
   std::size_t first_unused_index;
 
-  FixedSizeVector<NodeData> nodes;
+  // The value of each node. Only used if !is_overlay.
+  FixedSizeVector<Node, CallocAllocator<Node>> nodes;
+
+  // A bitmap with a bit for each node, set iff the node is terminal. Only used if !is_overlay.
+  // A bit is set with a release operation after storing the node's value, so that once a thread sees the bit set
+  // (with an acquire load) it can read the value without locking.
+  FixedSizeVector<std::uintptr_t, CallocAllocator<std::uintptr_t>> terminal_bits;
+
+  // The "cold" state of each node, see above. Only used if !is_overlay.
+  FixedSizeVector<std::uintptr_t, CallocAllocator<std::uintptr_t>> node_edges_begins;
+
+  bool is_overlay = false;
+
+  // For overlay graphs, the arrays above of the base graph and its number of nodes. nullptr and 0 for other graphs.
+  const Node* base_nodes = nullptr;
+  const std::uintptr_t* base_terminal_bits = nullptr;
+  const std::uintptr_t* base_node_edges_begins = nullptr;
+  std::size_t base_num_nodes = 0;
+
+  // For overlay graphs, the nodes with index >= base_num_nodes (i.e. the ones added by the overlay), in index order.
+  FixedSizeVector<OverlayNode, RegionAllocator<OverlayNode>> new_nodes;
+
+  // For overlay graphs, the slots of the base graph's nodes (see NodeSlots::slots), or nullptr if slot_nodes is empty.
+  const std::uint32_t* base_node_slots = nullptr;
+
+  // For overlay graphs, an OverlayNode object for each node of the base graph that had a slot when this graph was
+  // created, in slot order. The edges_begin field of these is inherited_node until the node is materialized.
+  FixedSizeVector<OverlayNode, RegionAllocator<OverlayNode>> slot_nodes;
+
+  // For overlay graphs, the current MaterializedNodes object (as a std::uintptr_t, for atomicLoadAcquire()).
+  std::uintptr_t materialized_nodes = 0;
+
+  // Owns the chain of MaterializedNodes objects, and points to the same object as `materialized_nodes'.
+  std::unique_ptr<MaterializedNodes, MaterializedNodesDeleter> materialized_nodes_owner;
+
+  // The number of materialized nodes (see getNumMaterializedNodes()).
+  std::size_t num_materialized_nodes = 0;
+
+  // If not nullptr, this is locked when materializing a node in an overlay graph (see setMutex()).
+  std::mutex* mutex = nullptr;
+
+  // dense_node_ids[DenseNodeIndex<NodeId>::get(id) - dense_node_ids_offset] is node_index_map.at(id).id + 1 for all the
+  // node IDs in the graph that have a dense index, and 0 for the other elements. dense_node_ids_offset is the minimum
+  // dense index of those node IDs, so the size of this array depends on the node IDs in the graph and not on the number
+  // of dense indexes assigned in the process.
+  // This is empty if the dense indexes are too sparse (see maxNumDenseNodeIds()), in that case the lookups use
+  // node_index_map.
+  // In overlay graphs, this only contains the node IDs that are not in the base graph, and base_dense_node_ids points
+  // to the base graph's dense_node_ids.
+  FixedSizeVector<std::uint32_t, RegionAllocator<std::uint32_t>> dense_node_ids;
+  std::size_t dense_node_ids_offset = 0;
+  const std::uint32_t* base_dense_node_ids = nullptr;
+  std::size_t base_dense_node_ids_size = 0;
+  std::size_t base_dense_node_ids_offset = 0;
 
   // Stores vectors of edges as contiguous chunks of node IDs.
-  // The NodeData elements in `nodes' contain indexes into this vector (stored as already multiplied by
-  // sizeof(NodeData)).
+  // The elements of node_edges_begins point into this vector.
+  // Each chunk is preceded by an element whose `id' is the number of edges in the chunk (see neighborsEnd()).
   // The first element is unused.
-  FixedSizeVector<InternalNodeId> edges_storage;
+  FixedSizeVector<InternalNodeId, RegionAllocator<InternalNodeId>> edges_storage;
 
 #if FRUIT_EXTRA_DEBUG
   template <typename NodeIter>
   void printGraph(NodeIter first, NodeIter last);
 #endif
 
-  NodeData* nodeAtId(InternalNodeId internalNodeId);
-  const NodeData* nodeAtId(InternalNodeId internalNodeId) const;
+  // Returns the maximum size of dense_node_ids for a graph with num_node_ids node IDs that have a dense index. If the
+  // dense indexes span a larger range, dense_node_ids is left empty.
+  static std::size_t maxNumDenseNodeIds(std::size_t num_node_ids);
+
+  // Allocates and fills dense_node_ids for the node IDs (and corresponding InternalNodeIds) in [first, last).
+  template <typename Iter>
+  void fillDenseNodeIds(Iter first, Iter last, MemoryRegion* region);
+
+  // Returns node_index_map.at(nodeId).id + 1, looking it up in dense_node_ids (or base_dense_node_ids), or 0 if
+  // the node ID doesn't have a dense index or isn't in those arrays.
+  std::size_t findInDenseNodeIds(NodeId nodeId) const;
+
+  // Throws std::length_error (or aborts, if exceptions are disabled) if num_nodes nodes don't fit in the 31 bits of an
+  // InternalNodeId. Unlike a FruitAssert, this is also checked in release builds.
+  static void checkNumNodes(std::size_t num_nodes);
+
+  // Allocates the arrays with the node data for first_unused_index nodes, that are all missing.
+  void allocateNodes();
+
+  // Returns the capacity of the MaterializedNodes object allocated by the overlay constructor.
+  // Space for a few materialized nodes (including the ones in slot_nodes) is always reserved, so that an overlay that
+  // only materializes a few nodes doesn't need any other allocation. This decreases as num_node_slots grows, so that
+  // (for small values of num_node_slots) the overlay doesn't need more memory than the previous ones.
+  static std::size_t initialMaterializedNodesCapacity(std::size_t num_node_slots);
+
+  // Allocates a MaterializedNodes object with room for `capacity' new OverlayNode objects, that also contains all the
+  // ones in `previous' (if any). If `region' is nullptr, this is allocated with operator new.
+  static MaterializedNodes* allocateMaterializedNodes(std::size_t capacity, MaterializedNodes* previous,
+                                                      MemoryRegion* region);
+
+  // Returns the memory that allocateMaterializedNodes() takes from the region for the same capacity, if
+  // previous->total_capacity is previous_capacity (or 0 if there's no `previous').
+  static std::size_t maximumRequiredSpaceForMaterializedNodes(std::size_t capacity, std::size_t previous_capacity);
+
+  // Returns the position in a MaterializedNodes table where the lookup of the node at `index' starts.
+  static std::size_t hashNodeIndex(std::size_t index, std::size_t table_shift);
+
+  // Adds `node' (the node at `index') to the hash table of `materialized_nodes'. This is a release operation.
+  static void insertMaterializedNode(MaterializedNodes* materialized_nodes, OverlayNode* node, std::size_t index);
+
+  // For overlay graphs, returns the OverlayNode of the node at `index', or nullptr if the node is inherited from the
+  // base graph and hasn't been materialized yet. For the nodes with an OverlayNode in slot_nodes, this returns it even
+  // if the node hasn't been materialized (its edges_begin is then inherited_node). The OverlayNode's value must only be
+  // read after an acquire load of its edges_begin.
+  OverlayNode* findOverlayNode(std::size_t index) const;
 
-  static NodeData* nodeAtId(NodeData* nodes_begin, InternalNodeId internalNodeId);
-  static const NodeData* nodeAtId(const NodeData* nodes_begin, InternalNodeId internalNodeId);
+  // The slow path of findOverlayNode(), that looks up the node in the hash table of materialized nodes.
+  OverlayNode* findMaterializedNode(std::size_t index) const;
+
+  // Like the previous method, but returns cached_node if it's not nullptr, and otherwise stores the result there.
+  // The methods below also take a cached_node parameter, used in the same way. Node iterators pass a field of the
+  // iterator, so that the hash table lookup is only done once when calling several methods on the same iterator.
+  // This is safe since an OverlayNode object is never moved.
+  OverlayNode* findOverlayNode(std::size_t index, OverlayNode*& cached_node) const;
+
+  // Like findOverlayNode(), but materializes the node (copying its state from the base graph) if needed.
+  OverlayNode* getOrMaterializeOverlayNode(std::size_t index, OverlayNode*& cached_node);
+
+  // The slow path of getOrMaterializeOverlayNode(), that locks `mutex' (if set).
+  OverlayNode* materializeOverlayNode(std::size_t index);
+
+  // Returns true if this is an overlay graph and the node is terminal in the base graph.
+  bool hasBaseTerminalBit(std::size_t index) const;
+
+  // Returns true if the node is terminal. This is an acquire operation.
+  bool isTerminalNode(std::size_t index, OverlayNode*& cached_node) const;
+
+  // Marks a node of a graph that is not an overlay as terminal. This is a release operation.
+  void setTerminalBit(std::size_t index);
+
+  // Returns the value of the node, looking it up in the base graph if the node is inherited.
+  const Node& getNodeValue(std::size_t index, OverlayNode*& cached_node) const;
+
+  // Loads the node's state (see node_edges_begins) with an acquire operation, looking it up in the base graph if the
+  // node is inherited.
+  std::uintptr_t loadEdgesBegin(std::size_t index, OverlayNode*& cached_node) const;
+
+  // Returns the location of the node's state (see node_edges_begins) that setTerminal(), tryClaim() and unclaim()
+  // modify, materializing the node if needed.
+  std::uintptr_t* getMutableEdgesBegin(std::size_t index, OverlayNode*& cached_node);
 
 public:
   class edge_iterator;
 
   class node_iterator {
   private:
-    NodeData* itr;
+    SemistaticGraph* graph;
+    std::size_t index;
+    // See findOverlayNode().
+    OverlayNode* overlay_node = nullptr;
 
     friend class SemistaticGraph<NodeId, Node>;
 
-    explicit node_iterator(NodeData* itr);
+    node_iterator(SemistaticGraph* graph, std::size_t index);
 
   public:
-    Node& getNode();
+    // This is an acquire operation, like isTerminal().
+    const Node& getNode();
 
+    // This is an acquire operation: if it returns true, any write to the node done before the matching setTerminal()
+    // call is visible to the caller (even if the caller doesn't hold any lock).
     bool isTerminal();
 
     // Turns the node into a terminal node, also removing all the deps.
+    // This is a release operation, so any modification to the node must happen before this call.
     void setTerminal();
 
+    // Replaces the node's value with `node' and then turns the node into a terminal one, as setTerminal().
+    void setTerminal(const Node& node);
+
+    // Atomically marks a non-terminal node as claimed. Returns false if the node was already claimed or terminal.
+    // This can be used to ensure that only 1 thread processes the node; the claim can be released with setTerminal()
+    // or unclaim().
+    bool tryClaim();
+
+    // Returns true if the node is currently claimed. This is an acquire operation.
+    bool isClaimed();
+
+    // Releases a claim obtained with tryClaim() without turning the node into a terminal node.
+    void unclaim();
+
     // Assumes !isTerminal().
-    // neighborsEnd() is NOT provided/stored for efficiency, the client code is expected to know the number of
-    // neighbors.
+    // Prefer using neighborsBegin() alone when the client code knows the number of neighbors, it's slightly faster.
     edge_iterator neighborsBegin();
 
+    // Assumes !isTerminal().
+    edge_iterator neighborsEnd();
+
     bool operator==(const node_iterator&) const;
+
+    // Returns the distance between the two nodes in the graph's storage. The result is unspecified, but it's
+    // guaranteed that for any node `n' in `graph', 0 <= n - graph.begin() < graph.end() - graph.begin() so this can be
+    // used to index arrays with an element for each node.
+    std::ptrdiff_t operator-(const node_iterator&) const;
   };
 
   class const_node_iterator {
   private:
-    const NodeData* itr;
+    const SemistaticGraph* graph;
+    std::size_t index;
+    // See findOverlayNode().
+    OverlayNode* overlay_node = nullptr;
 
     friend class SemistaticGraph<NodeId, Node>;
 
-    explicit const_node_iterator(const NodeData* itr);
+    const_node_iterator(const SemistaticGraph* graph, std::size_t index);
 
   public:
     explicit const_node_iterator(node_iterator itr);
@@ -168,6 +415,43 @@ public:
 
     // Equivalent to i times operator++ followed by getNodeIterator(nodes_begin).
     node_iterator getNodeIterator(std::size_t i, node_iterator nodes_begin);
+
+    // Returns true if the edge was marked as lazy when constructing the graph (see the 3-arg constructor). The graph
+    // doesn't treat lazy edges differently, this is just stored for the clients.
+    bool isLazy() const;
+
+    bool operator==(const edge_iterator&) const;
+  };
+
+  /**
+   * Assigns slots to the nodes of a graph that are materialized in the overlays on it (see the 4-arg constructor), so
+   * that the overlays can find them by direct indexing instead of through a hash table.
+   * Nodes get a slot when an overlay that materialized them calls assignNodeSlots(), typically right before it's
+   * destroyed. The overlays created after that reserve an OverlayNode for each slot, so when a program creates many
+   * overlays that touch the same nodes (e.g. an injector for each request) those only use the hash table for the
+   * nodes touched for the first time.
+   *
+   * Overlays created and destroyed concurrently in different threads can share the same NodeSlots object.
+   */
+  class NodeSlots {
+  public:
+    // Returns the number of slots assigned so far. This is an acquire operation.
+    std::size_t size() const;
+
+  private:
+    // Serializes the assignNodeSlots() calls.
+    std::mutex mutex;
+    // The slot of each node of the base graph, or 0 for the nodes without one. Slots are numbered from 1 in the order
+    // in which they're assigned, and a node's slot never changes once assigned. The elements are stored with a release
+    // operation and read without locking, with relaxed loads: the acquire load in size() makes the slots assigned
+    // before it visible. This is empty until the first slot is assigned.
+    // These are 32 bits (as node indexes, see SemistaticGraphInternalNodeId) so that more of them fit in the CPU
+    // caches.
+    FixedSizeVector<std::uint32_t, CallocAllocator<std::uint32_t>> slots;
+    // The number of slots assigned so far. Stored with a release operation after assigning the slots.
+    std::uintptr_t num_slots = 0;
+
+    friend class SemistaticGraph<NodeId, Node>;
   };
 
   // Constructs an *invalid* graph (as if this graph was just moved from).
@@ -180,14 +464,18 @@ public:
    * - x.isTerminal(), returning a bool
    * - x.getEdgesBegin() and x.getEdgesEnd(), that if !x.isTerminal() define a range of values of type NodeId
    *   (the outgoing edges).
+   * - x.isLazyEdge(i), returning a bool that says whether the i-th outgoing edge is lazy (see edge_iterator::isLazy())
    *
    * This constructor is *not* defined in semistatic_graph.templates.h, but only in semistatic_graph.cc.
    * All instantiations must have a matching instantiation in semistatic_graph.cc.
    *
    * The MemoryPool is only used during construction, the constructed object *can* outlive the memory pool.
+   *
+   * hash_options controls how the hash function used to look up node IDs is chosen.
    */
   template <typename NodeIter>
-  SemistaticGraph(NodeIter first, NodeIter last, MemoryPool& memory_pool);
+  SemistaticGraph(NodeIter first, NodeIter last, MemoryPool& memory_pool,
+                  const SemistaticMapHashOptions& hash_options = SemistaticMapHashOptions());
 
   SemistaticGraph(SemistaticGraph&&) noexcept = default;
   SemistaticGraph(const SemistaticGraph&) = delete;
@@ -197,13 +485,37 @@ public:
    * 2-arg
    * constructor.
    * The nodes in [first, last) must NOT be already in x, but can be neighbors of nodes in x.
-   * The new graph will share data with `x', so must be destroyed before `x' is destroyed.
-   * Also, after this is called, `x' must not be modified until this object has been destroyed.
+   * The new graph is an overlay on `x': it doesn't copy the nodes of `x', it only stores the new nodes plus the nodes
+   * whose state is later changed in the new graph (e.g. with setTerminal() or tryClaim()), that are materialized on the
+   * first change. The values and edges of the other nodes are read from `x'.
+   * So the memory used by the new graph scales with the number of new nodes and of the nodes actually changed in it,
+   * not with the size of `x'.
+   * So the new graph must be destroyed before `x' is destroyed, and after this is called `x' must not be modified until
+   * this object has been destroyed. `x' must not be an overlay graph itself.
+   *
+   * If node_slots is not nullptr, it must be used only for overlays on `x', and num_node_slots must be at most
+   * node_slots->size(). The new graph reserves an OverlayNode for each of the first num_node_slots slots, and the nodes
+   * with those slots are materialized there (and found by direct indexing). The other materialized nodes are stored in
+   * a hash table.
+   *
+   * If `region' is not nullptr, the memory of the new graph is allocated from it (instead of allocating it
+   * separately) except for the nodes materialized in the hash table beyond the first few, and it must have at least
+   * maximumRequiredSpaceForOverlay(x, first, last, num_node_slots) bytes available.
    *
    * The MemoryPool is only used during construction, the constructed object *can* outlive the memory pool.
    */
   template <typename NodeIter>
-  SemistaticGraph(const SemistaticGraph& x, NodeIter first, NodeIter last, MemoryPool& memory_pool);
+  SemistaticGraph(const SemistaticGraph& x, NodeIter first, NodeIter last, MemoryPool& memory_pool,
+                  MemoryRegion* region = nullptr, const NodeSlots* node_slots = nullptr,
+                  std::size_t num_node_slots = 0);
+
+  /**
+   * An upper bound on the memory that the previous constructor allocates from the MemoryRegion (if any) for the same
+   * `x', `first', `last' and `num_node_slots'.
+   */
+  template <typename NodeIter>
+  static std::size_t maximumRequiredSpaceForOverlay(const SemistaticGraph& x, NodeIter first, NodeIter last,
+                                                    std::size_t num_node_slots = 0);
 
   ~SemistaticGraph();
 
@@ -226,6 +538,25 @@ public:
   node_iterator find(NodeId nodeId);
   const_node_iterator find(NodeId nodeId) const;
 
+  // Sets a mutex that is locked when materializing nodes of an overlay graph, or nullptr (the default) if the caller
+  // guarantees that the methods of node_iterator that modify nodes are never called concurrently. Methods that only
+  // read the graph never lock it.
+  void setMutex(std::mutex* mutex);
+
+  // For overlay graphs, returns the number of nodes of the base graph that have been materialized in this graph (i.e.
+  // whose state has been changed in this graph). Returns 0 for other graphs.
+  std::size_t getNumMaterializedNodes() const;
+
+  // For overlay graphs, assigns a slot in `node_slots' to each node materialized in this graph that doesn't have one
+  // yet (see NodeSlots). `node_slots' must be the one passed to the constructor, if any. This can be called
+  // concurrently with the methods of other overlays that use `node_slots', but not with methods of this graph that
+  // modify nodes.
+  void assignNodeSlots(NodeSlots& node_slots) const;
+
+  // See SemistaticMap::getHashMultiplier() and SemistaticMap::getNumHashFunctionRetries().
+  std::uintptr_t getHashMultiplier() const;
+  std::size_t getNumHashFunctionRetries() const;
+
 #if FRUIT_EXTRA_DEBUG
   // Emits a runtime error if some node was not created but there is an edge pointing to it.
   void checkFullyConstructed();
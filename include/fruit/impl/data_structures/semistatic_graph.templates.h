@@ -22,12 +22,18 @@
 #endif
 
 #include <fruit/impl/data_structures/arena_allocator.h>
+#include <fruit/impl/data_structures/calloc_allocator.h>
 #include <fruit/impl/data_structures/fixed_size_vector.templates.h>
 #include <fruit/impl/data_structures/memory_pool.h>
 #include <fruit/impl/data_structures/semistatic_graph.h>
 #include <fruit/impl/data_structures/semistatic_map.templates.h>
+#include <fruit/impl/fruit-config.h>
 #include <fruit/impl/util/hash_helpers.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
 #if FRUIT_EXTRA_DEBUG
 #include <iostream>
 #endif
@@ -45,8 +51,8 @@ struct indexing_iterator {
     index += index_increment;
   }
 
-  auto operator*() -> decltype(std::make_pair(*iter, SemistaticGraphInternalNodeId{index})) {
-    return std::make_pair(*iter, SemistaticGraphInternalNodeId{index});
+  auto operator*() -> decltype(std::make_pair(*iter, SemistaticGraphInternalNodeId{std::uint32_t(index)})) {
+    return std::make_pair(*iter, SemistaticGraphInternalNodeId{std::uint32_t(index)});
   }
 
   bool operator==(const indexing_iterator<Iter, index_increment>& other) const {
@@ -81,13 +87,16 @@ void SemistaticGraph<NodeId, Node>::printGraph(NodeIter first, NodeIter last) {
 
 template <typename NodeId, typename Node>
 template <typename NodeIter>
-SemistaticGraph<NodeId, Node>::SemistaticGraph(NodeIter first, NodeIter last, MemoryPool& memory_pool) {
+SemistaticGraph<NodeId, Node>::SemistaticGraph(NodeIter first, NodeIter last, MemoryPool& memory_pool,
+                                               const SemistaticMapHashOptions& hash_options) {
+  // This also counts the elements that store the number of edges of each non-terminal node.
   std::size_t num_edges = 0;
   // Step 1: assign IDs to all nodes, fill node_index_map and set first_unused_index.
   HashSetWithArenaAllocator<NodeId> node_ids = createHashSetWithArenaAllocator<NodeId>(last - first, memory_pool);
   for (NodeIter i = first; i != last; ++i) {
     node_ids.insert(i->getId());
     if (!i->isTerminal()) {
+      ++num_edges;
       for (auto j = i->getEdgesBegin(); j != i->getEdgesEnd(); ++j) {
         node_ids.insert(*j);
         ++num_edges;
@@ -95,38 +104,44 @@ SemistaticGraph<NodeId, Node>::SemistaticGraph(NodeIter first, NodeIter last, Me
     }
   }
 
+  checkNumNodes(node_ids.size());
+
   using itr_t = typename HashSetWithArenaAllocator<NodeId>::iterator;
   node_index_map = SemistaticMap<NodeId, InternalNodeId>(
-      indexing_iterator<itr_t, sizeof(NodeData)>{node_ids.begin(), 0},
-      indexing_iterator<itr_t, sizeof(NodeData)>{node_ids.end(), node_ids.size() * sizeof(NodeData)},
+      indexing_iterator<itr_t, 1>{node_ids.begin(), 0},
+      indexing_iterator<itr_t, 1>{node_ids.end(), node_ids.size()},
       node_ids.size(),
-      memory_pool);
+      memory_pool,
+      nullptr /* region */,
+      hash_options);
 
   first_unused_index = node_ids.size();
 
-  // Step 2: fill `nodes' and edges_storage.
+  fillDenseNodeIds(indexing_iterator<itr_t, 1>{node_ids.begin(), 0},
+                   indexing_iterator<itr_t, 1>{node_ids.end(), node_ids.size()}, nullptr /* region */);
+
+  // Step 2: fill the node data and edges_storage.
 
   // Note that not all of these will be assigned in the loop below.
-  nodes = FixedSizeVector<NodeData>(first_unused_index, NodeData{
-#if FRUIT_EXTRA_DEBUG
-                                                            NodeId(),
-#endif
-                                                            1, Node()});
+  allocateNodes();
 
   // edges_storage[0] is unused, that's the reason for the +1
-  edges_storage = FixedSizeVector<InternalNodeId>(num_edges + 1);
+  edges_storage = FixedSizeVector<InternalNodeId, RegionAllocator<InternalNodeId>>(num_edges + 1);
   edges_storage.push_back(InternalNodeId());
 
   for (NodeIter i = first; i != last; ++i) {
-    NodeData& nodeData = *nodeAtId(node_index_map.at(i->getId()));
-    nodeData.node = i->getValue();
+    std::size_t index = node_index_map.at(i->getId()).id;
+    nodes[index] = i->getValue();
     if (i->isTerminal()) {
-      nodeData.edges_begin = 0;
+      terminal_bits[index / bits_per_terminal_bits_word] |= std::uintptr_t(1) << (index % bits_per_terminal_bits_word);
+      node_edges_begins[index] = terminal_node;
     } else {
-      nodeData.edges_begin = reinterpret_cast<std::uintptr_t>(edges_storage.data() + edges_storage.size());
+      edges_storage.push_back(InternalNodeId{static_cast<std::uint32_t>(i->getEdgesEnd() - i->getEdgesBegin())});
+      node_edges_begins[index] = reinterpret_cast<std::uintptr_t>(edges_storage.data() + edges_storage.size());
       for (auto j = i->getEdgesBegin(); j != i->getEdgesEnd(); ++j) {
-        InternalNodeId other_node_id = node_index_map.at(*j);
-        edges_storage.push_back(other_node_id);
+        std::uint32_t other_node_id = node_index_map.at(*j).id;
+        edges_storage.push_back(
+            InternalNodeId{other_node_id | (i->isLazyEdge(j - i->getEdgesBegin()) ? lazy_edge_bit : std::uint32_t(0))});
       }
     }
   }
@@ -139,11 +154,13 @@ SemistaticGraph<NodeId, Node>::SemistaticGraph(NodeIter first, NodeIter last, Me
 template <typename NodeId, typename Node>
 template <typename NodeIter>
 SemistaticGraph<NodeId, Node>::SemistaticGraph(const SemistaticGraph& x, NodeIter first, NodeIter last,
-                                               MemoryPool& memory_pool)
+                                               MemoryPool& memory_pool, MemoryRegion* region,
+                                               const NodeSlots* node_slots, std::size_t num_node_slots)
     : first_unused_index(x.first_unused_index) {
 
   // TODO: The code below is very similar to the other constructor, extract the common parts in separate functions.
 
+  // This also counts the elements that store the number of edges of each non-terminal node.
   std::size_t num_new_edges = 0;
 
   // Step 1: assign IDs to new nodes, fill `node_index_map' and update `first_unused_index'.
@@ -157,6 +174,7 @@ SemistaticGraph<NodeId, Node>::SemistaticGraph(const SemistaticGraph& x, NodeIte
       node_ids.push_back(std::make_pair(i->getId(), InternalNodeId()));
     }
     if (!i->isTerminal()) {
+      ++num_new_edges;
       for (auto j = i->getEdgesBegin(); j != i->getEdgesEnd(); ++j) {
         if (x.node_index_map.find(*j) == nullptr) {
           node_ids.push_back(std::make_pair(*j, InternalNodeId()));
@@ -171,39 +189,66 @@ SemistaticGraph<NodeId, Node>::SemistaticGraph(const SemistaticGraph& x, NodeIte
   node_ids.erase(std::unique(node_ids.begin(), node_ids.end()), node_ids.end());
 
   // Step 1c: assign new IDs.
+  checkNumNodes(first_unused_index + node_ids.size());
   for (auto& p : node_ids) {
-    p.second = InternalNodeId{first_unused_index * sizeof(NodeData)};
+    p.second = InternalNodeId{static_cast<std::uint32_t>(first_unused_index)};
     ++first_unused_index;
   }
 
-  // Step 1d: actually populate node_index_map.
-  node_index_map = SemistaticMap<NodeId, InternalNodeId>(x.node_index_map, std::move(node_ids));
+  // Step 1d: actually populate node_index_map and dense_node_ids.
+  FruitAssert(!x.is_overlay);
+  base_dense_node_ids = x.dense_node_ids.data();
+  base_dense_node_ids_size = x.dense_node_ids.size();
+  base_dense_node_ids_offset = x.dense_node_ids_offset;
+  fillDenseNodeIds(node_ids.begin(), node_ids.end(), region);
+  node_index_map = SemistaticMap<NodeId, InternalNodeId>(x.node_index_map, node_ids, memory_pool, region);
+
+  // Step 2: fill the node data and `edges_storage'
+  is_overlay = true;
+  base_nodes = x.nodes.data();
+  base_terminal_bits = x.terminal_bits.data();
+  base_node_edges_begins = x.node_edges_begins.data();
+  base_num_nodes = x.first_unused_index;
+
+  new_nodes = FixedSizeVector<OverlayNode, RegionAllocator<OverlayNode>>(first_unused_index - base_num_nodes,
+                                                                         RegionAllocator<OverlayNode>(region));
+  // Note that the loop below does not necessarily assign all the new nodes.
+  for (std::size_t i = base_num_nodes; i < first_unused_index; ++i) {
+    new_nodes.push_back(OverlayNode{Node(), missing_node});
+  }
 
-  // Step 2: fill `nodes' and `edges_storage'
-  nodes = FixedSizeVector<NodeData>(x.nodes, first_unused_index);
-  // Note that the loop below does not necessarily assign all of these.
-  for (std::size_t i = x.nodes.size(); i < first_unused_index; ++i) {
-    nodes.push_back(NodeData{
-#if FRUIT_EXTRA_DEBUG
-        NodeId(),
-#endif
-        1, Node()});
+  if (num_node_slots != 0) {
+    FruitAssert(num_node_slots <= node_slots->size());
+    // The slots array doesn't change after the first slot is assigned, so this doesn't need to lock node_slots->mutex.
+    base_node_slots = node_slots->slots.data();
+    slot_nodes = FixedSizeVector<OverlayNode, RegionAllocator<OverlayNode>>(
+        num_node_slots, OverlayNode{Node(), inherited_node}, RegionAllocator<OverlayNode>(region));
   }
 
+  MaterializedNodes* materialized =
+      allocateMaterializedNodes(initialMaterializedNodesCapacity(num_node_slots), nullptr, region);
+  materialized_nodes_owner.reset(materialized);
+  materialized_nodes = reinterpret_cast<std::uintptr_t>(materialized);
+
   // edges_storage[0] is unused, that's the reason for the +1
-  edges_storage = FixedSizeVector<InternalNodeId>(num_new_edges + 1);
+  edges_storage = FixedSizeVector<InternalNodeId, RegionAllocator<InternalNodeId>>(
+      num_new_edges + 1, RegionAllocator<InternalNodeId>(region));
   edges_storage.push_back(InternalNodeId());
 
   for (NodeIter i = first; i != last; ++i) {
-    NodeData& nodeData = *nodeAtId(node_index_map.at(i->getId()));
-    nodeData.node = i->getValue();
+    // This is a new node, unless it was referenced by an edge in `x'. In that case it's materialized.
+    OverlayNode* node = nullptr;
+    getOrMaterializeOverlayNode(node_index_map.at(i->getId()).id, node);
+    node->value = i->getValue();
     if (i->isTerminal()) {
-      nodeData.edges_begin = 0;
+      node->edges_begin = terminal_node;
     } else {
-      nodeData.edges_begin = reinterpret_cast<std::uintptr_t>(edges_storage.data() + edges_storage.size());
+      edges_storage.push_back(InternalNodeId{static_cast<std::uint32_t>(i->getEdgesEnd() - i->getEdgesBegin())});
+      node->edges_begin = reinterpret_cast<std::uintptr_t>(edges_storage.data() + edges_storage.size());
       for (auto j = i->getEdgesBegin(); j != i->getEdgesEnd(); ++j) {
-        InternalNodeId otherNodeId = node_index_map.at(*j);
-        edges_storage.push_back(otherNodeId);
+        std::uint32_t other_node_id = node_index_map.at(*j).id;
+        edges_storage.push_back(
+            InternalNodeId{other_node_id | (i->isLazyEdge(j - i->getEdgesBegin()) ? lazy_edge_bit : std::uint32_t(0))});
       }
     }
   }
@@ -213,11 +258,275 @@ SemistaticGraph<NodeId, Node>::SemistaticGraph(const SemistaticGraph& x, NodeIte
 #endif
 }
 
+template <typename NodeId, typename Node>
+void SemistaticGraph<NodeId, Node>::checkNumNodes(std::size_t num_nodes) {
+  // Node indexes are stored in 31 bits, since the high-order bit of the InternalNodeId elements of edges_storage is
+  // lazy_edge_bit. So a graph can have at most 2^31-1 nodes.
+  if (num_nodes >= lazy_edge_bit) {
+#if FRUIT_HAS_EXCEPTIONS
+    throw std::length_error("Fruit doesn't support injectors with 2^31 or more types.");
+#else
+    std::abort(); // LCOV_EXCL_LINE
+#endif
+  }
+}
+
+template <typename NodeId, typename Node>
+void SemistaticGraph<NodeId, Node>::allocateNodes() {
+  std::size_t num_terminal_bits_words =
+      (first_unused_index + bits_per_terminal_bits_word - 1) / bits_per_terminal_bits_word;
+  nodes = FixedSizeVector<Node, CallocAllocator<Node>>(first_unused_index);
+  terminal_bits = FixedSizeVector<std::uintptr_t, CallocAllocator<std::uintptr_t>>(num_terminal_bits_words);
+  node_edges_begins = FixedSizeVector<std::uintptr_t, CallocAllocator<std::uintptr_t>>(first_unused_index);
+
+  nodes.appendZeroFilled(first_unused_index);
+  terminal_bits.appendZeroFilled(num_terminal_bits_words);
+  for (std::size_t i = 0; i < first_unused_index; ++i) {
+    node_edges_begins.push_back(missing_node);
+  }
+}
+
+namespace semistatic_graph_internal {
+// Returns the table_shift of a MaterializedNodes object with the specified total capacity, so that the hash table is
+// at most half full.
+inline std::size_t getMaterializedNodesTableShift(std::size_t total_capacity) {
+  constexpr std::size_t bits_per_hash = sizeof(std::size_t) * CHAR_BIT;
+  std::size_t table_shift = bits_per_hash - 1;
+  while ((std::size_t(1) << (bits_per_hash - table_shift)) < 2 * total_capacity) {
+    --table_shift;
+  }
+  return table_shift;
+}
+} // namespace semistatic_graph_internal
+
+template <typename NodeId, typename Node>
+std::size_t SemistaticGraph<NodeId, Node>::maximumRequiredSpaceForMaterializedNodes(std::size_t capacity,
+                                                                                    std::size_t previous_capacity) {
+  std::size_t table_shift = semistatic_graph_internal::getMaterializedNodesTableShift(capacity + previous_capacity);
+  std::size_t table_size = std::size_t(1) << (bits_per_hash - table_shift);
+  return MemoryRegion::maximumRequiredSpace<MaterializedNodes>(1) +
+         MemoryRegion::maximumRequiredSpace<MaterializedNodesTableEntry>(table_size) +
+         MemoryRegion::maximumRequiredSpace<OverlayNode>(capacity);
+}
+
+template <typename NodeId, typename Node>
+typename SemistaticGraph<NodeId, Node>::MaterializedNodes*
+SemistaticGraph<NodeId, Node>::allocateMaterializedNodes(std::size_t capacity, MaterializedNodes* previous,
+                                                         MemoryRegion* region) {
+  std::size_t previous_capacity = (previous == nullptr) ? 0 : previous->total_capacity;
+  if (region == nullptr) {
+    std::size_t size = maximumRequiredSpaceForMaterializedNodes(capacity, previous_capacity);
+    // The MaterializedNodes object is allocated first, at the beginning of the block, so MaterializedNodesDeleter can
+    // free the whole block.
+    MemoryRegion heap_region(static_cast<char*>(::operator new(size)), size);
+    MaterializedNodes* materialized = allocateMaterializedNodes(capacity, previous, &heap_region);
+    materialized->heap_allocated = true;
+    return materialized;
+  }
+
+  std::size_t table_shift = semistatic_graph_internal::getMaterializedNodesTableShift(capacity + previous_capacity);
+  std::size_t table_size = std::size_t(1) << (bits_per_hash - table_shift);
+
+  MaterializedNodes* materialized = region->allocate<MaterializedNodes>(1);
+  materialized->previous = previous;
+  materialized->heap_allocated = false;
+  materialized->table = region->allocate<MaterializedNodesTableEntry>(table_size);
+  materialized->table_shift = table_shift;
+  materialized->nodes = region->allocate<OverlayNode>(capacity);
+  materialized->num_nodes = 0;
+  materialized->capacity = capacity;
+  materialized->total_capacity = capacity + previous_capacity;
+  std::fill(materialized->table, materialized->table + table_size, MaterializedNodesTableEntry{0, 0});
+
+  if (previous != nullptr) {
+    std::size_t previous_table_size = std::size_t(1) << (bits_per_hash - previous->table_shift);
+    for (std::size_t i = 0; i < previous_table_size; ++i) {
+      if (previous->table[i].node != 0) {
+        insertMaterializedNode(materialized, reinterpret_cast<OverlayNode*>(previous->table[i].node), // NOLINT
+                               previous->table[i].index);
+      }
+    }
+  }
+  return materialized;
+}
+
+template <typename NodeId, typename Node>
+void SemistaticGraph<NodeId, Node>::insertMaterializedNode(MaterializedNodes* materialized_nodes, OverlayNode* node,
+                                                           std::size_t index) {
+  std::size_t table_mask = (std::size_t(1) << (bits_per_hash - materialized_nodes->table_shift)) - 1;
+  std::size_t i = hashNodeIndex(index, materialized_nodes->table_shift);
+  while (materialized_nodes->table[i].node != 0) {
+    i = (i + 1) & table_mask;
+  }
+  materialized_nodes->table[i].index = index;
+  atomicStoreRelease(&materialized_nodes->table[i].node, reinterpret_cast<std::uintptr_t>(node));
+}
+
+template <typename NodeId, typename Node>
+typename SemistaticGraph<NodeId, Node>::OverlayNode*
+SemistaticGraph<NodeId, Node>::findMaterializedNode(std::size_t index) const {
+  // Pairs with the release operation that publishes a new MaterializedNodes object.
+  const MaterializedNodes* materialized =
+      reinterpret_cast<const MaterializedNodes*>(atomicLoadAcquire(&materialized_nodes)); // NOLINT
+  std::size_t table_mask = (std::size_t(1) << (bits_per_hash - materialized->table_shift)) - 1;
+  for (std::size_t i = hashNodeIndex(index, materialized->table_shift); /* no condition */; i = (i + 1) & table_mask) {
+    // Pairs with the release operation in insertMaterializedNode(), so that the OverlayNode is visible.
+    std::uintptr_t node = atomicLoadAcquire(&materialized->table[i].node);
+    if (node == 0) {
+      return nullptr;
+    }
+    if (materialized->table[i].index == index) {
+      return reinterpret_cast<OverlayNode*>(node); // NOLINT(performance-no-int-to-ptr)
+    }
+  }
+}
+
+template <typename NodeId, typename Node>
+typename SemistaticGraph<NodeId, Node>::OverlayNode*
+SemistaticGraph<NodeId, Node>::materializeOverlayNode(std::size_t index) {
+  std::unique_lock<std::mutex> lock;
+  if (mutex != nullptr) {
+    lock = std::unique_lock<std::mutex>(*mutex);
+    // Another thread might have materialized this node after the check in getOrMaterializeOverlayNode().
+    OverlayNode* node = findOverlayNode(index);
+    if (node != nullptr && atomicLoadAcquire(&node->edges_begin) != inherited_node) {
+      return node;
+    }
+  }
+
+  FruitAssert(index < base_num_nodes);
+  ++num_materialized_nodes;
+  if (slot_nodes.size() != 0) {
+    std::size_t position = std::size_t(atomicLoadRelaxed(base_node_slots + index)) - 1;
+    if (position < slot_nodes.size()) {
+      OverlayNode* node = slot_nodes.data() + position;
+      node->value = base_nodes[index];
+      // Pairs with the acquire operation in findOverlayNode().
+      atomicStoreRelease(&node->edges_begin, base_node_edges_begins[index]);
+      return node;
+    }
+  }
+
+  MaterializedNodes* materialized = materialized_nodes_owner.get();
+  if (materialized->num_nodes == materialized->capacity) {
+    // The new object also points to the OverlayNode objects of the previous ones, so those are never moved (other
+    // threads might be accessing them).
+    materialized = allocateMaterializedNodes(std::max(materialized->total_capacity, std::size_t(8)), materialized,
+                                             nullptr /* region */);
+    // The previous objects are now owned through `materialized->previous'.
+    materialized_nodes_owner.release();
+    materialized_nodes_owner.reset(materialized);
+    // Pairs with the acquire operation in findOverlayNode().
+    atomicStoreRelease(&materialized_nodes, reinterpret_cast<std::uintptr_t>(materialized));
+  }
+
+  OverlayNode* node = materialized->nodes + materialized->num_nodes;
+  ++materialized->num_nodes;
+  node->value = base_nodes[index];
+  node->edges_begin = base_node_edges_begins[index];
+  insertMaterializedNode(materialized, node, index);
+  return node;
+}
+
+template <typename NodeId, typename Node>
+template <typename NodeIter>
+std::size_t SemistaticGraph<NodeId, Node>::maximumRequiredSpaceForOverlay(const SemistaticGraph& x, NodeIter first,
+                                                                          NodeIter last,
+                                                                          std::size_t num_node_slots) {
+  // Upper bounds on the number of new node IDs and on the number of elements of edges_storage (see the constructor).
+  // The first one doesn't exclude duplicates and IDs already in `x', to avoid the hash table lookups.
+  std::size_t num_new_node_ids = 0;
+  std::size_t num_new_edges = 0;
+  for (NodeIter i = first; i != last; ++i) {
+    ++num_new_node_ids;
+    if (!i->isTerminal()) {
+      num_new_node_ids += i->getEdgesEnd() - i->getEdgesBegin();
+      num_new_edges += 1 + (i->getEdgesEnd() - i->getEdgesBegin());
+    }
+  }
+  return SemistaticMap<NodeId, InternalNodeId>::maximumRequiredSpaceForOverlay(x.node_index_map, num_new_node_ids) +
+         MemoryRegion::maximumRequiredSpace<OverlayNode>(num_new_node_ids) +
+         MemoryRegion::maximumRequiredSpace<OverlayNode>(num_node_slots) +
+         maximumRequiredSpaceForMaterializedNodes(initialMaterializedNodesCapacity(num_node_slots),
+                                                  0 /* previous_capacity */) +
+         MemoryRegion::maximumRequiredSpace<std::uint32_t>(maxNumDenseNodeIds(num_new_node_ids)) +
+         MemoryRegion::maximumRequiredSpace<InternalNodeId>(num_new_edges + 1);
+}
+
+template <typename NodeId, typename Node>
+void SemistaticGraph<NodeId, Node>::assignNodeSlots(NodeSlots& node_slots) const {
+  FruitAssert(is_overlay);
+  const MaterializedNodes* current_materialized_nodes = materialized_nodes_owner.get();
+  if (current_materialized_nodes->num_nodes == 0 && current_materialized_nodes->previous == nullptr) {
+    // All the materialized nodes (if any) have a slot already. This is the common case once the slots are assigned, so
+    // it's checked first to avoid locking the mutex.
+    return;
+  }
+  std::lock_guard<std::mutex> lock(node_slots.mutex);
+  // Only modified while holding the mutex, so this doesn't need an atomic load.
+  std::uintptr_t num_slots = node_slots.num_slots;
+  if (node_slots.slots.size() == 0) {
+    node_slots.slots = FixedSizeVector<std::uint32_t, CallocAllocator<std::uint32_t>>(base_num_nodes);
+    node_slots.slots.appendZeroFilled(base_num_nodes);
+  }
+  // The nodes with a slot are in slot_nodes, so this only needs to look at the ones in the hash table.
+  std::size_t table_size = std::size_t(1) << (bits_per_hash - current_materialized_nodes->table_shift);
+  for (std::size_t i = 0; i < table_size; ++i) {
+    if (current_materialized_nodes->table[i].node != 0) {
+      std::uint32_t* slot = &node_slots.slots[current_materialized_nodes->table[i].index];
+      // Another overlay might have assigned a slot to this node after this overlay was created.
+      if (*slot == 0) {
+        ++num_slots;
+        atomicStoreRelease(slot, std::uint32_t(num_slots));
+      }
+    }
+  }
+  // Pairs with the acquire operation in NodeSlots::size().
+  atomicStoreRelease(&node_slots.num_slots, num_slots);
+}
+
+template <typename NodeId, typename Node>
+template <typename Iter>
+void SemistaticGraph<NodeId, Node>::fillDenseNodeIds(Iter first, Iter last, MemoryRegion* region) {
+  std::size_t num_dense_indexes = 0;
+  std::size_t min_dense_index = 0;
+  std::size_t max_dense_index = 0;
+  for (Iter i = first; !(i == last); ++i) {
+    std::size_t dense_index = DenseNodeIndex<NodeId>::getOrAssign((*i).first);
+    if (dense_index != 0) {
+      min_dense_index = (num_dense_indexes == 0) ? dense_index : std::min(min_dense_index, dense_index);
+      max_dense_index = std::max(max_dense_index, dense_index);
+      ++num_dense_indexes;
+    }
+  }
+  if (num_dense_indexes == 0) {
+    // NodeId doesn't support dense indexes, or there are no node IDs.
+    return;
+  }
+  std::size_t num_elements = max_dense_index - min_dense_index + 1;
+  if (num_elements > maxNumDenseNodeIds(num_dense_indexes)) {
+    // The dense indexes of these node IDs are too sparse (e.g. they're a few types among many others in the process),
+    // the lookups use node_index_map instead.
+    return;
+  }
+
+  using Allocator = RegionAllocator<std::uint32_t>;
+  dense_node_ids = FixedSizeVector<std::uint32_t, Allocator>(num_elements, std::uint32_t(0), Allocator(region));
+  dense_node_ids_offset = min_dense_index;
+  for (Iter i = first; !(i == last); ++i) {
+    std::size_t dense_index = DenseNodeIndex<NodeId>::get((*i).first);
+    if (dense_index != 0) {
+      dense_node_ids[dense_index - min_dense_index] = (*i).second.id + 1;
+    }
+  }
+}
+
 #if FRUIT_EXTRA_DEBUG
 template <typename NodeId, typename Node>
 void SemistaticGraph<NodeId, Node>::checkFullyConstructed() {
-  for (NodeData& data : nodes) {
-    if (data.edges_begin == 1) {
+  for (std::size_t i = 0; i < first_unused_index; ++i) {
+    OverlayNode* cached_node = nullptr;
+    if (loadEdgesBegin(i, cached_node) == missing_node) {
       std::cerr << "Fruit bug: the dependency graph was not fully constructed." << std::endl;
       abort();
     }
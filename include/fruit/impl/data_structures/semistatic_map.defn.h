@@ -35,6 +35,16 @@ inline typename SemistaticMap<Key, Value>::Unsigned SemistaticMap<Key, Value>::h
   return hash_function.hash(std::hash<typename std::remove_cv<Key>::type>()(key));
 }
 
+template <typename Key, typename Value>
+inline std::uintptr_t SemistaticMap<Key, Value>::getHashMultiplier() const {
+  return hash_function.a;
+}
+
+template <typename Key, typename Value>
+inline std::size_t SemistaticMap<Key, Value>::getNumHashFunctionRetries() const {
+  return num_hash_function_retries;
+}
+
 } // namespace impl
 } // namespace fruit
 
@@ -18,6 +18,8 @@
 #define SEMISTATIC_MAP_H
 
 #include <fruit/impl/data_structures/fixed_size_vector.h>
+#include <fruit/impl/data_structures/memory_region.h>
+#include <fruit/impl/data_structures/region_allocator.h>
 
 #include "arena_allocator.h"
 #include "memory_pool.h"
@@ -29,13 +31,22 @@
 namespace fruit {
 namespace impl {
 
+// Controls how the hash function of a SemistaticMap is chosen.
+struct SemistaticMapHashOptions {
+  // If true, the candidate hash functions are generated with a fixed seed instead of one based on the current time.
+  bool deterministic = false;
+
+  // If not 0, this multiplier is tried before generating any random one.
+  std::uintptr_t preferred_multiplier = 0;
+};
+
 /**
  * Provides a subset of the interface of std::map, and also has these additional assumptions:
  * - Key must be default constructible and trivially copyable
  * - Value must be default constructible and trivially copyable
  *
- * Also, while insertion of elements after construction is supported, inserting more than O(1) elements
- * after construction will raise the cost of any further lookups to more than O(1).
+ * Elements can't be inserted after construction, but a map can be overlaid on an existing one to add more elements
+ * (see the constructor that takes a map below); lookups in the overlay are still O(1).
  */
 template <typename Key, typename Value>
 class SemistaticMap {
@@ -63,26 +74,38 @@ private:
 
   static NumBits pickNumBits(std::size_t n);
 
+  // The keys of a bucket are [keys_begin, keys_end), and the value corresponding to keys_begin[i] is values_begin[i].
   struct CandidateValuesRange {
-    value_type* begin;
-    value_type* end;
+    Key* keys_begin;
+    Key* keys_end;
+    Value* values_begin;
   };
 
   HashFunction hash_function;
-  // Given a key x, if p=lookup_table[hash_function.hash(x)] the candidate places for x are [p.first, p.second). These
-  // pointers
-  // point to the values[] vector, but it might be either the one of this object or the one of an object that was
-  // shallow-copied
-  // into this one.
-  FixedSizeVector<CandidateValuesRange> lookup_table;
-  FixedSizeVector<value_type> values;
+  // Given a key x, if p=lookup_table[hash_function.hash(x)] the candidate places for x are [p.keys_begin, p.keys_end).
+  // These pointers point to the keys[] and values[] vectors, but they might be either the ones of this object or the
+  // ones of an object that was shallow-copied into this one.
+  FixedSizeVector<CandidateValuesRange, RegionAllocator<CandidateValuesRange>> lookup_table;
+  // The keys are stored separately from the values so that a whole bucket can be compared with a single vector
+  // instruction. This is always followed by (beta-1) padding keys, so that reading beta keys starting at any
+  // element is always within bounds.
+  FixedSizeVector<Key, RegionAllocator<Key>> keys;
+  FixedSizeVector<Value, RegionAllocator<Value>> values;
+
+  // If this is an overlay, this is the map it was overlaid on, that contains all the elements not found in the tables
+  // above. Otherwise, this is nullptr.
+  const SemistaticMap* base_map = nullptr;
+
+  // The number of candidate hash functions that were discarded (due to too many collisions) before picking
+  // hash_function.
+  std::size_t num_hash_function_retries = 0;
 
   Unsigned hash(const Key& key) const;
 
-  // Inserts a range [elems_begin, elems_end) of new (key,value) pairs with hash h. The keys must not exist in the map.
-  // Before calling this, ensure that the capacity of `values' is sufficient to contain the new values without
-  // re-allocating.
-  void insert(std::size_t h, const value_type* elems_begin, const value_type* elems_end);
+  // The options used for the table of an overlay on `map'. Overlays are constructed often (e.g. once for each
+  // injector), so they start from the multiplier of `map' (that's likely to work for similar keys too) and don't
+  // seed the random generator from the clock.
+  static SemistaticMapHashOptions overlayHashOptions(const SemistaticMap& map);
 
 public:
   // Constructs an *invalid* map (as if this map was just moved from).
@@ -92,17 +115,28 @@ public:
    * Iter must be a forward iterator with value type std::pair<Key, Value>.
    *
    * The MemoryPool is only used during construction, the constructed object *can* outlive the memory pool.
+   *
+   * If `region' is not nullptr, the memory of the map is allocated from it.
    */
   template <typename Iter>
-  SemistaticMap(Iter begin, Iter end, std::size_t num_values, MemoryPool& memory_pool);
+  SemistaticMap(Iter begin, Iter end, std::size_t num_values, MemoryPool& memory_pool, MemoryRegion* region = nullptr,
+                const SemistaticMapHashOptions& hash_options = SemistaticMapHashOptions());
 
-  // Creates a shallow copy of `map' with the additional elements in new_elements.
+  // Creates an overlay on `map' with the additional elements in new_elements.
   // The keys in new_elements must be unique and must not be present in `map'.
-  // The new map will share data with `map', so must be destroyed before `map' is destroyed.
-  // NOTE: If more than O(1) elements are added, calls to at() and find() on the result will *not* be O(1).
-  // This is O(new_elements.size()*log(new_elements.size())).
+  // The new elements are stored in a separate table with its own hash function (so that at() and find() on the result
+  // are still O(1)), while the elements of `map' are looked up in `map' itself; so the new map must be destroyed
+  // before `map' is destroyed.
+  // This is O(new_elements.size()), regardless of the size of `map'.
+  // If `region' is not nullptr, the memory of the new map is allocated from it; in that case the region must have at
+  // least maximumRequiredSpaceForOverlay(map, new_elements.size()) bytes available.
   SemistaticMap(const SemistaticMap<Key, Value>& map,
-                std::vector<value_type, ArenaAllocator<value_type>>&& new_elements);
+                const std::vector<value_type, ArenaAllocator<value_type>>& new_elements, MemoryPool& memory_pool,
+                MemoryRegion* region = nullptr);
+
+  // An upper bound on the memory allocated from the MemoryRegion by the previous constructor.
+  static std::size_t maximumRequiredSpaceForOverlay(const SemistaticMap<Key, Value>& map,
+                                                    std::size_t num_new_elements);
 
   SemistaticMap(SemistaticMap&&) noexcept = default;
   SemistaticMap(const SemistaticMap&) = delete;
@@ -119,6 +153,14 @@ public:
   // Prefer using at() when possible, this is slightly slower.
   // Returns nullptr if the key was not found.
   const Value* find(Key key) const;
+
+  // The multiplier of the hash function used by this map. This can be used as the preferred_multiplier in the
+  // SemistaticMapHashOptions of another map with the same keys, to skip the search for a suitable hash function.
+  // For an overlay, this is the multiplier used for the new elements.
+  std::uintptr_t getHashMultiplier() const;
+
+  // The number of candidate hash functions that were discarded before finding a suitable one.
+  std::size_t getNumHashFunctionRetries() const;
 };
 
 } // namespace impl
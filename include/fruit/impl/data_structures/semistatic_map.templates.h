@@ -24,7 +24,10 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <random>
+#include <type_traits>
 #include <utility>
 // This include is not necessary for GCC/Clang, but it's necessary for MSVC.
 #include <numeric>
@@ -34,17 +37,105 @@
 #include <fruit/impl/data_structures/arena_allocator.h>
 #include <fruit/impl/data_structures/fixed_size_vector.templates.h>
 #include <fruit/impl/fruit_assert.h>
+#include <fruit/impl/util/type_info.h>
+
+// SIMD bucket probing is only used on x86-64, where keys of size 8 are common (e.g. TypeId).
+#if defined(__x86_64__) && defined(__AVX2__)
+#define FRUIT_SEMISTATIC_MAP_USE_AVX2 1
+#define FRUIT_SEMISTATIC_MAP_USE_SIMD 1
+#include <immintrin.h>
+#elif (defined(__x86_64__) && defined(__SSE2__)) || defined(_M_X64)
+#define FRUIT_SEMISTATIC_MAP_USE_SSE2 1
+#define FRUIT_SEMISTATIC_MAP_USE_SIMD 1
+#include <emmintrin.h>
+#else
+#define FRUIT_SEMISTATIC_MAP_USE_SIMD 0
+#endif
 
 namespace fruit {
 namespace impl {
 
+// Whether two values of type T are equal iff their object representations are equal.
+template <typename T>
+struct SemistaticMapKeyHasBitwiseEquality
+    : std::integral_constant<bool, std::is_integral<T>::value || std::is_pointer<T>::value> {};
+
+template <>
+struct SemistaticMapKeyHasBitwiseEquality<TypeId> : std::true_type {};
+
+// Looks for `key' in the bucket [keys_begin, keys_end) of a SemistaticMap and returns its index, or
+// (keys_end - keys_begin) if it's not there.
+// The vectorized version compares 4 keys at once, so it might read up to 3 keys after keys_end (SemistaticMap
+// ensures that these are always readable and that buckets have at most 3 keys).
+template <typename Key, bool use_simd = FRUIT_SEMISTATIC_MAP_USE_SIMD && sizeof(Key) == 8 &&
+                                         SemistaticMapKeyHasBitwiseEquality<Key>::value>
+struct SemistaticMapBucketProbe {
+  static std::size_t find(const Key* keys_begin, const Key* keys_end, const Key& key) {
+    const Key* p = keys_begin;
+    for (; p != keys_end; ++p) {
+      if (*p == key) {
+        break;
+      }
+    }
+    return p - keys_begin;
+  }
+};
+
+#if FRUIT_SEMISTATIC_MAP_USE_SIMD
+
+template <typename Key>
+struct SemistaticMapBucketProbe<Key, true> {
+  // Returns a 4-bit mask where the i-th bit is set iff keys[i] is bitwise equal to key.
+  static unsigned compare4(const Key* keys, const Key& key) {
+#if FRUIT_SEMISTATIC_MAP_USE_AVX2
+    std::int64_t key_bits;
+    std::memcpy(&key_bits, &key, sizeof(key_bits));
+    __m256i needle = _mm256_set1_epi64x(key_bits);
+    __m256i haystack = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));
+    return (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(haystack, needle)));
+#else
+    // SSE2 has no 64-bit equality comparison, so we compare the 32-bit halves and then require both halves of each
+    // 64-bit lane to match.
+    std::int64_t key_bits;
+    std::memcpy(&key_bits, &key, sizeof(key_bits));
+    __m128i needle = _mm_set1_epi64x(key_bits);
+    __m128i eq01 = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys)), needle);
+    __m128i eq23 = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + 2)), needle);
+    eq01 = _mm_and_si128(eq01, _mm_shuffle_epi32(eq01, _MM_SHUFFLE(2, 3, 0, 1)));
+    eq23 = _mm_and_si128(eq23, _mm_shuffle_epi32(eq23, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (unsigned)_mm_movemask_pd(_mm_castsi128_pd(eq01)) |
+           ((unsigned)_mm_movemask_pd(_mm_castsi128_pd(eq23)) << 2);
+#endif
+  }
+
+  static std::size_t find(const Key* keys_begin, const Key* keys_end, const Key& key) {
+    std::size_t n = keys_end - keys_begin;
+    // SemistaticMap ensures that buckets have less than 4 keys.
+    FruitAssert(n < 4);
+    // Ignore any matches in the keys after keys_end.
+    unsigned mask = compare4(keys_begin, key) & ((1u << n) - 1);
+    if (mask == 0) {
+      return n;
+    }
+    std::size_t i = 0;
+    for (; (mask & 1) == 0; mask >>= 1) {
+      ++i;
+    }
+    return i;
+  }
+};
+
+#endif // FRUIT_SEMISTATIC_MAP_USE_SIMD
+
 template <typename Key, typename Value>
 template <typename Iter>
 SemistaticMap<Key, Value>::SemistaticMap(
     Iter values_begin, // NOLINT(bugprone-easily-swappable-parameters)
     Iter values_end,
     std::size_t num_values,
-    MemoryPool& memory_pool) {
+    MemoryPool& memory_pool,
+    MemoryRegion* region,
+    const SemistaticMapHashOptions& hash_options) {
   NumBits num_bits = pickNumBits(num_values);
   std::size_t num_buckets = size_t(1) << num_bits;
 
@@ -54,13 +145,19 @@ SemistaticMap<Key, Value>::SemistaticMap(
 
   // The cast is a no-op in some systems (e.g. GCC and Clang under Linux 64bit) but it's needed in other systems (e.g.
   // MSVC).
-  unsigned seed = (unsigned)std::chrono::system_clock::now().time_since_epoch().count();
+  unsigned seed = hash_options.deterministic
+                      ? (unsigned)std::default_random_engine::default_seed
+                      : (unsigned)std::chrono::system_clock::now().time_since_epoch().count();
   std::default_random_engine random_generator(seed);
   std::uniform_int_distribution<Unsigned> random_distribution;
 
-  while (1) {
+  num_hash_function_retries = 0;
+  hash_function.a = hash_options.preferred_multiplier;
+  if (hash_function.a == 0) {
     hash_function.a = random_distribution(random_generator);
+  }
 
+  while (1) {
     for (Iter itr = values_begin; !(itr == values_end); ++itr) {
       Unsigned& this_count = count[hash((*itr).first)];
       ++this_count;
@@ -72,14 +169,20 @@ SemistaticMap<Key, Value>::SemistaticMap(
 
   pick_another:
     std::memset(count.data(), 0, num_buckets * sizeof(Unsigned));
+    ++num_hash_function_retries;
+    hash_function.a = random_distribution(random_generator);
   }
 
-  values = FixedSizeVector<value_type>(num_values, value_type());
+  // The last (beta-1) keys are padding, see the comment on `keys'.
+  static_assert(beta == 4, "SemistaticMapBucketProbe reads 4 keys at a time, so it needs exactly 3 padding keys.");
+  keys = FixedSizeVector<Key, RegionAllocator<Key>>(num_values + beta - 1, Key(), RegionAllocator<Key>(region));
+  values = FixedSizeVector<Value, RegionAllocator<Value>>(num_values, Value(), RegionAllocator<Value>(region));
 
   std::partial_sum(count.begin(), count.end(), count.begin());
-  lookup_table = FixedSizeVector<CandidateValuesRange>(count.size());
+  lookup_table = FixedSizeVector<CandidateValuesRange, RegionAllocator<CandidateValuesRange>>(
+      count.size(), RegionAllocator<CandidateValuesRange>(region));
   for (Unsigned n : count) {
-    lookup_table.push_back(CandidateValuesRange{values.data() + n, values.data() + n});
+    lookup_table.push_back(CandidateValuesRange{keys.data() + n, keys.data() + n, values.data() + n});
   }
 
   // At this point lookup_table[h] is the number of keys in [first, last) that have a hash <=h.
@@ -87,102 +190,61 @@ SemistaticMap<Key, Value>::SemistaticMap(
 
   Iter itr = values_begin;
   for (std::size_t i = 0; i < num_values; ++i, ++itr) {
-    value_type*& first_value_ptr = lookup_table[hash((*itr).first)].begin;
-    --first_value_ptr;
-    FruitAssert(values.data() <= first_value_ptr);
-    FruitAssert(first_value_ptr < values.data() + values.size());
-    *first_value_ptr = *itr;
+    CandidateValuesRange& range = lookup_table[hash((*itr).first)];
+    --range.keys_begin;
+    --range.values_begin;
+    FruitAssert(keys.data() <= range.keys_begin);
+    FruitAssert(range.keys_begin < keys.data() + num_values);
+    *range.keys_begin = (*itr).first;
+    *range.values_begin = (*itr).second;
   }
 }
 
 template <typename Key, typename Value>
 SemistaticMap<Key, Value>::SemistaticMap(const SemistaticMap<Key, Value>& map,
-                                         std::vector<value_type, ArenaAllocator<value_type>>&& new_elements)
-    : hash_function(map.hash_function), lookup_table(map.lookup_table, map.lookup_table.size()) {
-
-  // Sort by hash.
-  std::sort(new_elements.begin(), new_elements.end(),
-            [this](const value_type& x, const value_type& y) { return hash(x.first) < hash(y.first); });
-
-  std::size_t num_additional_values = new_elements.size();
-  // Add the space needed to store copies of the old buckets.
-  for (auto itr = new_elements.begin(), itr_end = new_elements.end(); itr != itr_end; /* no increment */) {
-    Unsigned h = hash(itr->first);
-    auto p = map.lookup_table[h];
-    num_additional_values += (p.end - p.begin);
-    for (; itr != itr_end && hash(itr->first) == h; ++itr) {
-    }
-  }
-
-  values = FixedSizeVector<value_type>(num_additional_values);
-
-  // Now actually perform the insertions.
-
-  if (new_elements.empty()) {
-    // This is to workaround a bug in the STL shipped with GCC <4.8.2, where calling data() on an
-    // empty vector causes undefined behavior (https://gcc.gnu.org/bugzilla/show_bug.cgi?id=59829).
-    return;
-  }
-  for (value_type *itr = new_elements.data(), *itr_end = new_elements.data() + new_elements.size(); itr != itr_end;
-       /* no increment */) {
-    Unsigned h = hash(itr->first);
-    auto p = map.lookup_table[h];
-    num_additional_values += (p.end - p.begin);
-    value_type* first = itr;
-    for (; itr != itr_end && hash(itr->first) == h; ++itr) {
-    }
-    value_type* last = itr;
-    insert(h, first, last);
-  }
+                                         const std::vector<value_type, ArenaAllocator<value_type>>& new_elements,
+                                         MemoryPool& memory_pool, MemoryRegion* region)
+    : SemistaticMap(new_elements.begin(), new_elements.end(), new_elements.size(), memory_pool, region,
+                    overlayHashOptions(map)) {
+  base_map = &map;
 }
 
 template <typename Key, typename Value>
-void SemistaticMap<Key, Value>::insert(
-    std::size_t h,
-    const value_type* elems_begin, // NOLINT(bugprone-easily-swappable-parameters)
-    const value_type* elems_end) {
-
-  value_type* old_bucket_begin = lookup_table[h].begin;
-  value_type* old_bucket_end = lookup_table[h].end;
-
-  lookup_table[h].begin = values.data() + values.size();
-
-  // Step 1: re-insert all keys with the same hash at the end (if any).
-  for (value_type* p = old_bucket_begin; p != old_bucket_end; ++p) {
-    values.push_back(*p);
-  }
-
-  // Step 2: also insert the new keys and values
-  for (auto itr = elems_begin; itr != elems_end; ++itr) {
-    values.push_back(*itr);
-  }
-
-  lookup_table[h].end = values.data() + values.size();
+SemistaticMapHashOptions SemistaticMap<Key, Value>::overlayHashOptions(const SemistaticMap<Key, Value>& map) {
+  SemistaticMapHashOptions hash_options;
+  hash_options.deterministic = true;
+  hash_options.preferred_multiplier = map.hash_function.a;
+  return hash_options;
+}
 
-  // The old sequence is no longer pointed to by any index in the lookup table, but recompacting the vectors would be
-  // too slow.
+template <typename Key, typename Value>
+std::size_t SemistaticMap<Key, Value>::maximumRequiredSpaceForOverlay(const SemistaticMap<Key, Value>&,
+                                                                      std::size_t num_new_elements) {
+  // The new elements are stored in a separate table, so this doesn't depend on the size of the base map.
+  return MemoryRegion::maximumRequiredSpace<CandidateValuesRange>(std::size_t(1) << pickNumBits(num_new_elements)) +
+         MemoryRegion::maximumRequiredSpace<Key>(num_new_elements + beta - 1) +
+         MemoryRegion::maximumRequiredSpace<Value>(num_new_elements);
 }
 
 template <typename Key, typename Value>
 const Value& SemistaticMap<Key, Value>::at(Key key) const {
-  Unsigned h = hash(key);
-  for (const value_type* p = lookup_table[h].begin; /* p!=lookup_table[h].end but no need to check */; ++p) {
-    FruitAssert(p != lookup_table[h].end);
-    if (p->first == key) {
-      return p->second;
-    }
+  const CandidateValuesRange& range = lookup_table[hash(key)];
+  std::size_t i = SemistaticMapBucketProbe<Key>::find(range.keys_begin, range.keys_end, key);
+  if (base_map != nullptr && range.keys_begin + i == range.keys_end) {
+    return base_map->at(key);
   }
+  FruitAssert(range.keys_begin + i != range.keys_end);
+  return range.values_begin[i];
 }
 
 template <typename Key, typename Value>
 const Value* SemistaticMap<Key, Value>::find(Key key) const {
-  Unsigned h = hash(key);
-  for (const value_type *p = lookup_table[h].begin, *p_end = lookup_table[h].end; p != p_end; ++p) {
-    if (p->first == key) {
-      return &(p->second);
-    }
+  const CandidateValuesRange& range = lookup_table[hash(key)];
+  std::size_t i = SemistaticMapBucketProbe<Key>::find(range.keys_begin, range.keys_end, key);
+  if (range.keys_begin + i == range.keys_end) {
+    return base_map == nullptr ? nullptr : base_map->find(key);
   }
-  return nullptr;
+  return range.values_begin + i;
 }
 
 template <typename Key, typename Value>
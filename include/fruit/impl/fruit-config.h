@@ -87,4 +87,12 @@
   __builtin_unreachable()
 #endif
 
+// Whether exceptions are enabled (e.g. they aren't with -fno-exceptions). When they're not, the library doesn't catch
+// exceptions (and user code can't throw any).
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define FRUIT_HAS_EXCEPTIONS 1
+#else
+#define FRUIT_HAS_EXCEPTIONS 0
+#endif
+
 #endif // FRUIT_CONFIG_H
@@ -26,16 +26,23 @@ namespace fruit {
 
 template <typename... P>
 template <typename... FormalArgs, typename... Args>
-inline Injector<P...>::Injector(Component<P...> (*getComponent)(FormalArgs...), Args&&... args) {
+inline Injector<P...>::Injector(Component<P...> (*getComponent)(FormalArgs...), Args&&... args)
+    : Injector(InjectorOptions(), getComponent, std::forward<Args>(args)...) {}
+
+template <typename... P>
+template <typename... FormalArgs, typename... Args>
+inline Injector<P...>::Injector(const InjectorOptions& options, Component<P...> (*getComponent)(FormalArgs...),
+                                Args&&... args) {
   Component<P...> component = fruit::createComponent().install(getComponent, std::forward<Args>(args)...);
 
   fruit::impl::MemoryPool memory_pool;
   using exposed_types_t = std::vector<fruit::impl::TypeId, fruit::impl::ArenaAllocator<fruit::impl::TypeId>>;
   exposed_types_t exposed_types =
-      exposed_types_t(std::initializer_list<fruit::impl::TypeId>{fruit::impl::getTypeId<P>()...},
+      exposed_types_t(std::initializer_list<fruit::impl::TypeId>{
+                          fruit::impl::getTypeId<fruit::impl::InjectorStorage::NormalizeType<P>>()...},
                       fruit::impl::ArenaAllocator<fruit::impl::TypeId>(memory_pool));
   storage = std::unique_ptr<fruit::impl::InjectorStorage>(
-      new fruit::impl::InjectorStorage(std::move(component.storage), exposed_types, memory_pool));
+      new fruit::impl::InjectorStorage(std::move(component.storage), exposed_types, memory_pool, options));
 }
 
 namespace impl {
@@ -92,12 +99,19 @@ struct InjectorImplHelper {
 template <typename... P>
 template <typename... NormalizedComponentParams, typename... ComponentParams, typename... FormalArgs, typename... Args>
 inline Injector<P...>::Injector(const NormalizedComponent<NormalizedComponentParams...>& normalized_component,
+                                Component<ComponentParams...> (*getComponent)(FormalArgs...), Args&&... args)
+    : Injector(InjectorOptions(), normalized_component, getComponent, std::forward<Args>(args)...) {}
+
+template <typename... P>
+template <typename... NormalizedComponentParams, typename... ComponentParams, typename... FormalArgs, typename... Args>
+inline Injector<P...>::Injector(const InjectorOptions& options,
+                                const NormalizedComponent<NormalizedComponentParams...>& normalized_component,
                                 Component<ComponentParams...> (*getComponent)(FormalArgs...), Args&&... args) {
   Component<ComponentParams...> component = fruit::createComponent().install(getComponent, std::forward<Args>(args)...);
 
   fruit::impl::MemoryPool memory_pool;
-  storage = std::unique_ptr<fruit::impl::InjectorStorage>(new fruit::impl::InjectorStorage(
-      *(normalized_component.storage.storage), std::move(component.storage), memory_pool));
+  storage = fruit::impl::InjectorStorage::create(*(normalized_component.storage.storage), std::move(component.storage),
+                                                 memory_pool, options);
 
   using NormalizedComp =
       fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<NormalizedComponentParams>...);
@@ -112,6 +126,24 @@ inline Injector<P...>::Injector(const NormalizedComponent<NormalizedComponentPar
   (void)typename fruit::impl::meta::CheckIfError<E>::type();
 }
 
+template <typename... P>
+template <typename... NormalizedComponentParams, typename... ComponentParams, typename... FormalArgs, typename... Args>
+inline Injector<P...>::Injector(
+    const NormalizedComponentFuture<NormalizedComponentParams...>& normalized_component_future,
+    Component<ComponentParams...> (*getComponent)(FormalArgs...), Args&&... args)
+    : Injector(InjectorOptions(), normalized_component_future, getComponent, std::forward<Args>(args)...) {}
+
+template <typename... P>
+template <typename... NormalizedComponentParams, typename... ComponentParams, typename... FormalArgs, typename... Args>
+inline Injector<P...>::Injector(
+    const InjectorOptions& options,
+    const NormalizedComponentFuture<NormalizedComponentParams...>& normalized_component_future,
+    Component<ComponentParams...> (*getComponent)(FormalArgs...), Args&&... args)
+    : Injector(options, normalized_component_future.get(), getComponent, std::forward<Args>(args)...) {}
+
+template <typename... P>
+inline Injector<P...>::Injector(std::unique_ptr<fruit::impl::InjectorStorage> storage) : storage(std::move(storage)) {}
+
 template <typename... P>
 template <typename T>
 inline fruit::impl::RemoveAnnotations<T> Injector<P...>::get() {
@@ -148,6 +180,17 @@ FRUIT_DEPRECATED_DEFINITION(inline void Injector<P...>::eagerlyInjectAll()) {
   storage->eagerlyInjectMultibindings();
 }
 
+template <typename... P>
+inline void Injector<P...>::eagerlyInjectAllParallel(std::size_t num_threads) {
+  storage->eagerlyInjectParallel(
+      {fruit::impl::getTypeId<fruit::impl::InjectorStorage::NormalizeType<P>>()...}, num_threads);
+}
+
+template <typename... P>
+inline std::size_t Injector<P...>::getNumRemovedUnreachableBindings() const {
+  return storage->getNumRemovedUnreachableBindings();
+}
+
 } // namespace fruit
 
 #endif // FRUIT_INJECTOR_DEFN_H
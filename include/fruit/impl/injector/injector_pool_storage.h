@@ -0,0 +1,86 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_INJECTOR_POOL_STORAGE_H
+#define FRUIT_INJECTOR_POOL_STORAGE_H
+
+#include <fruit/injector_options.h>
+#include <fruit/impl/injector/injector_storage.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace fruit {
+namespace impl {
+
+/**
+ * The non-templated part of InjectorPool. Used to implement InjectorPool<>, don't use directly.
+ *
+ * This keeps the memory of the InjectorStorage objects that are no longer used (see InjectorStorage::create()), so
+ * that it can be reused by the next injectors.
+ */
+class InjectorPoolStorage {
+private:
+  // The options passed to the constructor, except that skip_object_destruction is always false.
+  InjectorOptions options;
+
+  // The maximum number of blocks kept in idle_blocks. Blocks released when there are already this many are deallocated.
+  std::size_t max_idle_injectors;
+
+  // Guards idle_blocks.
+  std::mutex mutex;
+
+  // The memory of the injectors that have been released (see InjectorStorage::destroyKeepingMemory()).
+  // This has at most max_idle_injectors elements.
+  std::vector<InjectorStorage::MemoryBlock> idle_blocks;
+
+  // Adds `block' to idle_blocks, or deallocates it if there are already max_idle_injectors idle blocks.
+  void keepOrDeallocate(InjectorStorage::MemoryBlock block);
+
+public:
+  InjectorPoolStorage(const InjectorOptions& options, std::size_t max_idle_injectors);
+
+  InjectorPoolStorage(InjectorPoolStorage&&) = delete;
+  InjectorPoolStorage(const InjectorPoolStorage&) = delete;
+
+  InjectorPoolStorage& operator=(InjectorPoolStorage&&) = delete;
+  InjectorPoolStorage& operator=(const InjectorPoolStorage&) = delete;
+
+  ~InjectorPoolStorage();
+
+  /**
+   * Returns an InjectorStorage equivalent to InjectorStorage::create(normalized_storage, std::move(storage),
+   * memory_pool, options), reusing the memory of a released one if there's any.
+   *
+   * The MemoryPool is only used during this call, the returned object *can* outlive the memory pool.
+   */
+  std::unique_ptr<InjectorStorage> acquire(const NormalizedComponentStorage& normalized_storage,
+                                           ComponentStorage&& storage, MemoryPool& memory_pool);
+
+  /**
+   * Destroys `injector' (and all the objects that it constructed), keeping its memory for reuse by a later acquire()
+   * call.
+   * `injector' must have been returned by acquire().
+   */
+  void release(std::unique_ptr<InjectorStorage> injector);
+};
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_INJECTOR_POOL_STORAGE_H
@@ -25,6 +25,7 @@
 #include <fruit/impl/util/lambda_invoker.h>
 #include <fruit/impl/util/type_info.h>
 
+#include <algorithm>
 #include <cassert>
 
 // Redundant, but makes KDevelop happy.
@@ -96,6 +97,11 @@ inline const TypeId* InjectorStorage::BindingDataNodeIter::getEdgesEnd() {
   return itr->binding_for_object_to_construct.deps->deps + itr->binding_for_object_to_construct.deps->num_deps;
 }
 
+inline bool InjectorStorage::BindingDataNodeIter::isLazyEdge(std::size_t i) {
+  FruitAssert(i < itr->binding_for_object_to_construct.deps->num_deps);
+  return itr->binding_for_object_to_construct.deps->lazy_deps[i];
+}
+
 template <typename AnnotatedT>
 struct GetFirstStage;
 
@@ -231,14 +237,20 @@ struct GetSecondStage<fruit::Annotated<Annotation, T>> : public GetSecondStage<T
 
 template <typename AnnotatedT>
 inline InjectorStorage::RemoveAnnotations<AnnotatedT> InjectorStorage::get() {
-  std::lock_guard<std::recursive_mutex> lock(mutex);
-  return GetSecondStage<AnnotatedT>()(GetFirstStage<AnnotatedT>()(*this, lazyGetPtr<NormalizeType<AnnotatedT>>()));
+  // lazyGetPtr() only accesses immutable data, so it doesn't need to lock `mutex'.
+  return get<RemoveAnnotations<AnnotatedT>>(lazyGetPtr<NormalizeType<AnnotatedT>>());
 }
 
 template <typename T>
 inline T InjectorStorage::get(InjectorStorage::Graph::node_iterator node_iterator) {
   FruitStaticAssert(fruit::impl::meta::IsSame(fruit::impl::meta::Type<T>,
                                               fruit::impl::meta::RemoveAnnotations(fruit::impl::meta::Type<T>)));
+  if (node_iterator.isTerminal() || concurrent_construction) {
+    // Fast path: the object has already been constructed (and published by getPtrInternal()), so we can return it
+    // without locking `mutex'.
+    // With concurrent_construction, getPtrInternal() synchronizes the construction of each object separately instead.
+    return GetSecondStage<T>()(GetFirstStage<T>()(*this, node_iterator));
+  }
   std::lock_guard<std::recursive_mutex> lock(mutex);
   return GetSecondStage<T>()(GetFirstStage<T>()(*this, node_iterator));
 }
@@ -301,18 +313,21 @@ inline const std::vector<InjectorStorage::RemoveAnnotations<AnnotatedC>*>& Injec
 }
 
 inline const void* InjectorStorage::getPtrInternal(Graph::node_iterator node_itr) {
-  NormalizedBinding& normalized_binding = node_itr.getNode();
   if (!node_itr.isTerminal()) {
-    normalized_binding.object = normalized_binding.create(*this, node_itr);
-    FruitAssert(node_itr.isTerminal());
+    if (concurrent_construction) {
+      constructConcurrently(node_itr);
+    } else {
+      constructWithDependencies(node_itr);
+    }
   }
-  return normalized_binding.object;
+  return node_itr.getNode().object;
 }
 
-inline NormalizedMultibindingSet* InjectorStorage::getNormalizedMultibindingSet(TypeId type) {
-  auto itr = multibindings.find(type);
-  if (itr != multibindings.end())
-    return &(itr->second);
+inline InjectorStorage::MultibindingSet* InjectorStorage::getMultibindingSet(TypeId type) {
+  MultibindingSet* itr = std::lower_bound(multibindings.begin(), multibindings.end(), type,
+                                          [](const MultibindingSet& x, TypeId y) { return x.type_id < y; });
+  if (itr != multibindings.end() && itr->type_id == type)
+    return itr;
   else
     return nullptr;
 }
@@ -321,7 +336,7 @@ template <typename AnnotatedC>
 inline std::shared_ptr<char> InjectorStorage::createMultibindingVector(InjectorStorage& storage) {
   using C = RemoveAnnotations<AnnotatedC>;
   TypeId type = getTypeId<AnnotatedC>();
-  NormalizedMultibindingSet* multibinding_set = storage.getNormalizedMultibindingSet(type);
+  MultibindingSet* multibinding_set = storage.getMultibindingSet(type);
 
   // This method is only called if there was at least 1 multibinding (otherwise the would-be caller would have returned
   // nullptr
@@ -336,10 +351,10 @@ inline std::shared_ptr<char> InjectorStorage::createMultibindingVector(InjectorS
   storage.ensureConstructedMultibinding(*multibinding_set);
 
   std::vector<C*> s;
-  s.reserve(multibinding_set->elems.size());
-  for (const NormalizedMultibinding& multibinding : multibinding_set->elems) {
-    FruitAssert(multibinding.is_constructed);
-    s.push_back(reinterpret_cast<C*>(multibinding.object));
+  s.reserve(multibinding_set->elems_end - multibinding_set->elems_begin);
+  for (const NormalizedMultibinding* p = multibinding_set->elems_begin; p != multibinding_set->elems_end; ++p) {
+    FruitAssert(p->is_constructed);
+    s.push_back(reinterpret_cast<C*>(p->object));
   }
 
   std::shared_ptr<std::vector<C*>> vector_ptr = std::make_shared<std::vector<C*>>(std::move(s));
@@ -357,7 +372,6 @@ InjectorStorage::createInjectedObjectForBind(InjectorStorage& injector,
 
   InjectorStorage::Graph::node_iterator bindings_begin = injector.bindings.begin();
   const C* cPtr = injector.get<const C*>(injector.lazyGetPtr<AnnotatedC>(node_itr.neighborsBegin(), 0, bindings_begin));
-  node_itr.setTerminal();
   // This step is needed when the cast C->I changes the pointer
   // (e.g. for multiple inheritance).
   const I* iPtr = static_cast<const I*>(cPtr);
@@ -594,7 +608,6 @@ InjectorStorage::const_object_ptr_t InjectorStorage::createInjectedObjectForProv
                                                                                      Graph::node_iterator node_itr) {
   C* cPtr = InvokeLambdaWithInjectedArgVector<AnnotatedSignature, Lambda, std::is_pointer<T>::value>()(
       injector, injector.bindings, injector.allocator, node_itr.neighborsBegin());
-  node_itr.setTerminal();
   return reinterpret_cast<const_object_ptr_t>(cPtr);
 }
 
@@ -620,7 +633,7 @@ inline ComponentStorageEntry InjectorStorage::createComponentStorageEntryForProv
   result.type_id = getTypeId<AnnotatedC>();
   ComponentStorageEntry::BindingForObjectToConstruct& binding = result.binding_for_object_to_construct;
   binding.create = createInjectedObjectForProvider<C, T, AnnotatedSignature, Lambda>;
-  binding.deps = getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>>();
+  binding.deps = getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>, SignatureArgs<AnnotatedSignature>>();
 #if FRUIT_EXTRA_DEBUG
   binding.is_nonconst = true;
 #endif
@@ -632,7 +645,6 @@ InjectorStorage::const_object_ptr_t
 InjectorStorage::createInjectedObjectForCompressedProvider(InjectorStorage& injector, Graph::node_iterator node_itr) {
   C* cPtr = InvokeLambdaWithInjectedArgVector<AnnotatedSignature, Lambda, std::is_pointer<T>::value>()(
       injector, injector.bindings, injector.allocator, node_itr.neighborsBegin());
-  node_itr.setTerminal();
   I* iPtr = static_cast<I*>(cPtr);
   return reinterpret_cast<object_ptr_t>(iPtr);
 }
@@ -721,7 +733,6 @@ InjectorStorage::const_object_ptr_t InjectorStorage::createInjectedObjectForCons
                                                                                         Graph::node_iterator node_itr) {
   C* cPtr = InvokeConstructorWithInjectedArgVector<AnnotatedSignature>()(injector, injector.bindings,
                                                                          injector.allocator, node_itr.neighborsBegin());
-  node_itr.setTerminal();
   return reinterpret_cast<InjectorStorage::object_ptr_t>(cPtr);
 }
 
@@ -734,7 +745,7 @@ inline ComponentStorageEntry InjectorStorage::createComponentStorageEntryForCons
   result.type_id = getTypeId<AnnotatedC>();
   ComponentStorageEntry::BindingForObjectToConstruct& binding = result.binding_for_object_to_construct;
   binding.create = createInjectedObjectForConstructor<C, AnnotatedSignature>;
-  binding.deps = getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>>();
+  binding.deps = getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>, SignatureArgs<AnnotatedSignature>>();
 #if FRUIT_EXTRA_DEBUG
   binding.is_nonconst = true;
 #endif
@@ -747,7 +758,6 @@ InjectorStorage::createInjectedObjectForCompressedConstructor(InjectorStorage& i
                                                               Graph::node_iterator node_itr) {
   C* cPtr = InvokeConstructorWithInjectedArgVector<AnnotatedSignature>()(injector, injector.bindings,
                                                                          injector.allocator, node_itr.neighborsBegin());
-  node_itr.setTerminal();
   I* iPtr = static_cast<I*>(cPtr);
   return reinterpret_cast<object_ptr_t>(iPtr);
 }
@@ -776,6 +786,14 @@ inline ComponentStorageEntry InjectorStorage::createComponentStorageEntryForMult
   return result;
 }
 
+template <typename AnnotatedT>
+inline ComponentStorageEntry InjectorStorage::createComponentStorageEntryForTypeSharedAcrossInjectors() {
+  ComponentStorageEntry result;
+  result.kind = ComponentStorageEntry::Kind::TYPE_SHARED_ACROSS_INJECTORS;
+  result.type_id = getTypeId<AnnotatedT>();
+  return result;
+}
+
 template <typename I, typename C, typename AnnotatedCPtr>
 InjectorStorage::object_ptr_t InjectorStorage::createInjectedObjectForMultibinding(InjectorStorage& m) {
   C* cPtr = m.get<AnnotatedCPtr>();
@@ -840,7 +858,7 @@ inline ComponentStorageEntry InjectorStorage::createComponentStorageEntryForMult
   result.type_id = getTypeId<AnnotatedC>();
   ComponentStorageEntry::MultibindingForObjectToConstruct& binding = result.multibinding_for_object_to_construct;
   binding.create = createInjectedObjectForMultibindingProvider<C, T, AnnotatedSignature, Lambda>;
-  binding.deps = getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>>();
+  binding.deps = getBindingDeps<NormalizedSignatureArgs<AnnotatedSignature>, SignatureArgs<AnnotatedSignature>>();
   return result;
 }
 
@@ -18,10 +18,15 @@
 #define FRUIT_INJECTOR_STORAGE_H
 
 #include <fruit/fruit_forward_decls.h>
+#include <fruit/injector_options.h>
 #include <fruit/impl/data_structures/fixed_size_allocator.h>
+#include <fruit/impl/data_structures/fixed_size_vector.h>
+#include <fruit/impl/data_structures/region_allocator.h>
 #include <fruit/impl/meta/component.h>
 #include <fruit/impl/normalized_component_storage/normalized_bindings.h>
 
+#include <condition_variable>
+#include <initializer_list>
 #include <unordered_map>
 #include <vector>
 #include <mutex>
@@ -75,6 +80,10 @@ public:
   using SignatureType = fruit::impl::meta::UnwrapType<
       fruit::impl::meta::Eval<fruit::impl::meta::SignatureType(fruit::impl::meta::Type<Signature>)>>;
 
+  template <typename Signature>
+  using SignatureArgs =
+      fruit::impl::meta::Eval<fruit::impl::meta::SignatureArgs(fruit::impl::meta::Type<Signature>)>;
+
   template <typename Signature>
   using NormalizedSignatureArgs = fruit::impl::meta::Eval<fruit::impl::meta::NormalizeTypeVector(
       fruit::impl::meta::SignatureArgs(fruit::impl::meta::Type<Signature>))>;
@@ -118,11 +127,29 @@ public:
   template <typename AnnotatedSignature, typename Lambda>
   static ComponentStorageEntry createComponentStorageEntryForMultibindingProvider();
 
+  template <typename AnnotatedT>
+  static ComponentStorageEntry createComponentStorageEntryForTypeSharedAcrossInjectors();
+
+  // The create function used (in NormalizedComponentStorage::bindings) for types shared across injectors. This gets
+  // the object from the normalized component's shared objects injector, constructing it there if needed.
+  static const void* createSharedObject(InjectorStorage& injector, Graph::node_iterator node_itr);
+
+  // A chunk of memory allocated by create(), from `memory_resource' (or from the heap if that's nullptr).
+  struct MemoryBlock {
+    void* data = nullptr;
+    std::size_t size = 0;
+    MemoryResource* memory_resource = nullptr;
+  };
+
 private:
   // The NormalizedComponentStorage owned by this object (if any).
   // Only used for the 1-argument constructor, otherwise it's nullptr.
   std::unique_ptr<NormalizedComponentStorage> normalized_component_storage_ptr;
 
+  // The NormalizedComponentStorage that `bindings' is an overlay of. Only used for the 2-argument constructor,
+  // otherwise it's nullptr.
+  const NormalizedComponentStorage* base_normalized_component_storage = nullptr;
+
   FixedSizeAllocator allocator;
 
   // A graph with injected types as nodes (each node stores the NormalizedBindingData for the type) and dependencies as
@@ -130,19 +157,75 @@ private:
   // For types that have a constructed object already, the corresponding node is stored as terminal node.
   SemistaticGraph<TypeId, NormalizedBinding> bindings;
 
-  // Maps the type index of a type T to the corresponding NormalizedMultibindingSet object (that stores all
-  // multibindings).
-  std::unordered_map<TypeId, NormalizedMultibindingSet> multibindings;
+  // The multibindings for a type. This holds the same data as a NormalizedMultibindingSet, but the elements are a
+  // range of multibinding_elems, so that the multibindings of an injector are stored in two flat arrays.
+  struct MultibindingSet {
+    TypeId type_id;
+
+    NormalizedMultibinding* elems_begin;
+    NormalizedMultibinding* elems_end;
+
+    // See NormalizedMultibindingSet::get_multibindings_vector.
+    ComponentStorageEntry::MultibindingVectorCreator::get_multibindings_vector_t get_multibindings_vector;
+
+    // See NormalizedMultibindingSet::v.
+    std::shared_ptr<char> v;
+  };
+
+  // The multibindings of this injector, one element for each type with at least 1 multibinding, sorted by type_id.
+  // For injectors created with create(), this and multibinding_elems are allocated from the injector's MemoryRegion.
+  FixedSizeVector<MultibindingSet, RegionAllocator<MultibindingSet>> multibindings;
+
+  // The elements of all the MultibindingSet objects in `multibindings', in the same order.
+  FixedSizeVector<NormalizedMultibinding, RegionAllocator<NormalizedMultibinding>> multibinding_elems;
 
   // This mutex is used to synchronize concurrent accesses to this InjectorStorage object.
+  // get() doesn't lock it for nodes that are already terminal: the object pointer is published by setTerminal() (a
+  // release store) and never modified afterwards.
+  // When concurrent_construction is true, get() never locks it; it's still used for multibindings.
   std::recursive_mutex mutex;
 
+  // See InjectorOptions::concurrent_construction.
+  // If this is true, each non-terminal node is claimed (see SemistaticGraph::node_iterator::tryClaim()) by the thread
+  // that constructs its object, instead of constructing objects while holding `mutex'.
+  bool concurrent_construction = false;
+
+  // Only used when concurrent_construction is true. Guards the allocation of space in `allocator', but not the
+  // construction of objects.
+  std::mutex allocator_mutex;
+
+  // Only used when concurrent_construction is true (and during eagerlyInjectParallel()). Guards the materialization of
+  // nodes in `bindings' (see SemistaticGraph::setMutex()).
+  std::mutex bindings_mutex;
+
+  // Only used when concurrent_construction is true. Threads that need an object that is being constructed by another
+  // thread wait on construction_finished (with construction_mutex) until the node is no longer claimed.
+  std::mutex construction_mutex;
+  std::condition_variable construction_finished;
+
+  // Used by create(), after normalizing the bindings. All memory is allocated from `region'.
+  InjectorStorage(const NormalizedComponentStorage& normalized_storage,
+                  const FixedSizeAllocator::FixedSizeAllocatorData& fixed_size_allocator_data,
+                  std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& new_bindings_vector,
+                  const std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings_map,
+                  MemoryPool& memory_pool, const InjectorOptions& options, MemoryRegion& region,
+                  std::size_t num_node_slots);
+
+  // Fills `multibindings' and multibinding_elems with the multibindings in multibindings_map. If `region' is not
+  // nullptr, they're allocated from it, and it must have at least
+  // maximumRequiredSpaceForMultibindings(multibindings_map) bytes available.
+  void initMultibindings(const std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings_map,
+                         MemoryPool& memory_pool, MemoryRegion* region);
+
+  static std::size_t
+  maximumRequiredSpaceForMultibindings(const std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings_map);
+
 private:
   template <typename AnnotatedC>
   static std::shared_ptr<char> createMultibindingVector(InjectorStorage& storage);
 
   // If not bound, returns nullptr.
-  NormalizedMultibindingSet* getNormalizedMultibindingSet(TypeId type);
+  MultibindingSet* getMultibindingSet(TypeId type);
 
   // Looks up the location where the type is (or will be) stored, but does not construct the class.
   template <typename AnnotatedC>
@@ -155,6 +238,18 @@ private:
   // Similar to the previous, but takes a node_iterator. Use this when the node_iterator is known, it's faster.
   const void* getPtrInternal(Graph::node_iterator itr);
 
+  // Constructs the object for a non-terminal node, first constructing its (non-lazy) dependencies that haven't been
+  // constructed yet, in topological order. This doesn't recurse: the objects are constructed in a loop, each one when
+  // its dependencies are already constructed, so the stack usage doesn't depend on the length of dependency chains.
+  // Used when concurrent_construction is false, with `mutex' held.
+  // When this returns, the node is terminal.
+  void constructWithDependencies(Graph::node_iterator itr);
+
+  // Constructs the object for a non-terminal node (if no other thread constructs it first), or waits until another
+  // thread has constructed it. Used when concurrent_construction is true, and by eagerlyInjectParallel().
+  // When this returns, the node is terminal.
+  void constructConcurrently(Graph::node_iterator itr);
+
   // getPtr(typeInfo) is equivalent to getPtr(lazyGetPtr(typeInfo)).
   Graph::node_iterator lazyGetPtr(TypeId type);
 
@@ -170,7 +265,7 @@ private:
   void* getMultibindings(TypeId type);
 
   // Constructs any necessary instances, but NOT the instance set.
-  void ensureConstructedMultibinding(NormalizedMultibindingSet& multibinding_set);
+  void ensureConstructedMultibinding(MultibindingSet& multibinding_set);
 
   template <typename T>
   friend struct GetFirstStage;
@@ -226,23 +321,52 @@ public:
     bool isTerminal();
     const TypeId* getEdgesBegin();
     const TypeId* getEdgesEnd();
+    bool isLazyEdge(std::size_t i);
   };
 
   /**
    * The MemoryPool is only used during construction, the constructed object *can* outlive the memory pool.
    */
   InjectorStorage(ComponentStorage&& storage, const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
-                  MemoryPool& memory_pool);
+                  MemoryPool& memory_pool, const InjectorOptions& options);
+
+  // This is just the default destructor, but we declare it here to avoid including
+  // normalized_component_storage.h in fruit.h.
+  ~InjectorStorage();
 
   /**
+   * Creates an injector for the bindings in `normalized_storage' and `storage'.
+   * The returned object and all its data structures are carved out of a single chunk of memory, laid out after the
+   * normalization of `storage' (that is when their sizes are known).
+   *
+   * The chunk is allocated from options.memory_resource, if that's not nullptr.
+   *
+   * If `reusable_block' is not nullptr and the chunk of memory it points to is big enough (and was allocated from the
+   * same resource), that memory is used instead of allocating a new chunk (without clearing it, so this doesn't cost
+   * more for a bigger chunk), and *reusable_block is set to an empty MemoryBlock. Otherwise *reusable_block is not
+   * modified. If this throws, *reusable_block is left as it was.
+   *
    * The MemoryPool is only used during construction, the constructed object *can* outlive the memory pool.
    */
-  InjectorStorage(const NormalizedComponentStorage& normalized_storage, ComponentStorage&& storage,
-                  MemoryPool& memory_pool);
+  static std::unique_ptr<InjectorStorage> create(const NormalizedComponentStorage& normalized_storage,
+                                                 ComponentStorage&& storage, MemoryPool& memory_pool,
+                                                 const InjectorOptions& options,
+                                                 MemoryBlock* reusable_block = nullptr);
 
-  // This is just the default destructor, but we declare it here to avoid including
-  // normalized_component_storage.h in fruit.h.
-  ~InjectorStorage();
+  /**
+   * Destroys an injector returned by create() (destroying all the objects that it constructed, as the destructor does)
+   * and returns the chunk of memory that contained it. The memory can be passed to a later create() call, and must
+   * eventually be deallocated with deallocate().
+   */
+  static MemoryBlock destroyKeepingMemory(std::unique_ptr<InjectorStorage> injector);
+
+  static void deallocate(MemoryBlock block);
+
+  // InjectorStorage objects are allocated with malloc() (or from a MemoryResource), so that create() can
+  // allocate the memory for an object and its data structures at once. In both cases the object is preceded by the
+  // MemoryBlock that contains it, so that operator delete can deallocate the block.
+  static void* operator new(std::size_t size);
+  static void operator delete(void* p);
 
   InjectorStorage(InjectorStorage&&) = delete;
   InjectorStorage& operator=(InjectorStorage&&) = delete;
@@ -277,6 +401,15 @@ public:
   const std::vector<RemoveAnnotations<AnnotatedC>*>& getMultibindings();
 
   void eagerlyInjectMultibindings();
+
+  // Constructs the objects for all the types in `exposed_types' and their (direct or indirect) dependencies, using
+  // `num_threads' threads (including the current one). An object is only constructed after all its dependencies, but
+  // objects that don't depend on each other can be constructed concurrently.
+  // Multibindings are then constructed in the current thread (see eagerlyInjectMultibindings()).
+  void eagerlyInjectParallel(std::initializer_list<TypeId> exposed_types, std::size_t num_threads);
+
+  // See Injector::getNumRemovedUnreachableBindings().
+  std::size_t getNumRemovedUnreachableBindings() const;
 };
 
 } // namespace impl
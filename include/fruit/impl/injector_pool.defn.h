@@ -0,0 +1,87 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_INJECTOR_POOL_DEFN_H
+#define FRUIT_INJECTOR_POOL_DEFN_H
+
+#include <fruit/component.h>
+
+// Redundant, but makes KDevelop happy.
+#include <fruit/injector_pool.h>
+
+namespace fruit {
+
+template <typename... P>
+inline InjectorPool<P...>::PooledInjector::PooledInjector(
+    fruit::impl::InjectorPoolStorage& pool_storage, std::unique_ptr<fruit::impl::InjectorStorage> injector_storage)
+    : pool_storage(&pool_storage), injector(std::move(injector_storage)) {}
+
+template <typename... P>
+inline InjectorPool<P...>::PooledInjector::~PooledInjector() {
+  // The storage is nullptr if this PooledInjector was moved from.
+  if (injector.storage != nullptr) {
+    pool_storage->release(std::move(injector.storage));
+  }
+}
+
+template <typename... P>
+inline Injector<P...>& InjectorPool<P...>::PooledInjector::operator*() {
+  return injector;
+}
+
+template <typename... P>
+inline Injector<P...>* InjectorPool<P...>::PooledInjector::operator->() {
+  return &injector;
+}
+
+template <typename... P>
+constexpr std::size_t InjectorPool<P...>::default_max_idle_injectors;
+
+template <typename... P>
+inline InjectorPool<P...>::InjectorPool() : InjectorPool(InjectorOptions()) {}
+
+template <typename... P>
+inline InjectorPool<P...>::InjectorPool(const InjectorOptions& options)
+    : InjectorPool(options, default_max_idle_injectors) {}
+
+template <typename... P>
+inline InjectorPool<P...>::InjectorPool(const InjectorOptions& options, std::size_t max_idle_injectors)
+    : storage(options, max_idle_injectors) {}
+
+template <typename... P>
+template <typename... NormalizedComponentParams, typename... ComponentParams, typename... FormalArgs, typename... Args>
+inline typename InjectorPool<P...>::PooledInjector
+InjectorPool<P...>::get(const NormalizedComponent<NormalizedComponentParams...>& normalized_component,
+                        Component<ComponentParams...> (*getComponent)(FormalArgs...), Args&&... args) {
+  using NormalizedComp =
+      fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<NormalizedComponentParams>...);
+  using Comp1 = fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<ComponentParams>...);
+  // These are the same checks done by the corresponding Injector constructor.
+  using E = typename fruit::impl::meta::InjectorImplHelper<P...>::template CheckConstructionFromNormalizedComponent<
+      NormalizedComp, Comp1>::type;
+  (void)typename fruit::impl::meta::CheckIfError<E>::type();
+
+  Component<ComponentParams...> component = fruit::createComponent().install(getComponent, std::forward<Args>(args)...);
+
+  fruit::impl::MemoryPool memory_pool;
+  return PooledInjector(storage,
+                        storage.acquire(*(normalized_component.storage.storage), std::move(component.storage),
+                                        memory_pool));
+}
+
+} // namespace fruit
+
+#endif // FRUIT_INJECTOR_POOL_DEFN_H
@@ -31,16 +31,37 @@ inline NormalizedComponent<Params...>::NormalizedComponent(Component<Params...>
     : NormalizedComponent(std::move(fruit::Component<Params...>(
                                         fruit::createComponent().install(getComponent, std::forward<Args>(args)...))
                                         .storage),
-                          fruit::impl::MemoryPool()) {}
+                          fruit::impl::MemoryPool(), NormalizedComponentOptions()) {}
+
+template <typename... Params>
+template <typename... FormalArgs, typename... Args>
+inline NormalizedComponent<Params...>::NormalizedComponent(const NormalizedComponentOptions& options,
+                                                           Component<Params...> (*getComponent)(FormalArgs...),
+                                                           Args&&... args)
+    : NormalizedComponent(std::move(fruit::Component<Params...>(
+                                        fruit::createComponent().install(getComponent, std::forward<Args>(args)...))
+                                        .storage),
+                          fruit::impl::MemoryPool(), options) {}
 
 template <typename... Params>
 inline NormalizedComponent<Params...>::NormalizedComponent(fruit::impl::ComponentStorage&& storage,
-                                                           fruit::impl::MemoryPool memory_pool)
+                                                           fruit::impl::MemoryPool memory_pool,
+                                                           const NormalizedComponentOptions& options)
     : storage(std::move(storage),
               fruit::impl::getTypeIdsForList<typename fruit::impl::meta::Eval<fruit::impl::meta::SetToVector(
                   typename fruit::impl::meta::Eval<fruit::impl::meta::ConstructComponentImpl(
                       fruit::impl::meta::Type<Params>...)>::Ps)>>(memory_pool),
-              memory_pool, fruit::impl::NormalizedComponentStorageHolder::WithUndoableCompression()) {}
+              memory_pool, options, fruit::impl::NormalizedComponentStorageHolder::WithUndoableCompression()) {}
+
+template <typename... Params>
+inline std::uintptr_t NormalizedComponent<Params...>::getHashFunctionMultiplier() const {
+  return storage.getHashFunctionMultiplier();
+}
+
+template <typename... Params>
+inline std::size_t NormalizedComponent<Params...>::getNumHashFunctionRetries() const {
+  return storage.getNumHashFunctionRetries();
+}
 
 } // namespace fruit
 
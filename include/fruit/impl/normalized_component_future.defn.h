@@ -0,0 +1,83 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_NORMALIZED_COMPONENT_FUTURE_DEFN_H
+#define FRUIT_NORMALIZED_COMPONENT_FUTURE_DEFN_H
+
+#include <fruit/normalized_component_future.h>
+
+#include <fruit/component.h>
+
+#include <chrono>
+
+namespace fruit {
+
+template <typename... Params>
+template <typename... FormalArgs, typename... Args>
+inline NormalizedComponentFuture<Params...>::NormalizedComponentFuture(
+    Component<Params...> (*getComponent)(FormalArgs...), Args&&... args)
+    : NormalizedComponentFuture(NormalizedComponentOptions(), getComponent, std::forward<Args>(args)...) {}
+
+template <typename... Params>
+template <typename... FormalArgs, typename... Args>
+inline NormalizedComponentFuture<Params...>::NormalizedComponentFuture(
+    const NormalizedComponentOptions& options, Component<Params...> (*getComponent)(FormalArgs...), Args&&... args) {
+  // This only stores the (lazy) component function and its arguments, getComponent() is called by the other thread
+  // during the normalization.
+  Component<Params...> component = fruit::createComponent().install(getComponent, std::forward<Args>(args)...);
+  future = std::async(std::launch::async, &NormalizedComponentFuture::normalize, std::move(component.storage), options)
+               .share();
+}
+
+template <typename... Params>
+inline NormalizedComponent<Params...>
+NormalizedComponentFuture<Params...>::normalize(fruit::impl::ComponentStorage&& component_storage,
+                                                const NormalizedComponentOptions& options) {
+  return NormalizedComponent<Params...>(std::move(component_storage), fruit::impl::MemoryPool(), options);
+}
+
+template <typename... Params>
+inline bool NormalizedComponentFuture<Params...>::isReady() const {
+  return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+template <typename... Params>
+inline void NormalizedComponentFuture<Params...>::wait() const {
+  // Unlike future.wait(), this rethrows the exception thrown during the normalization (if any).
+  future.get();
+}
+
+template <typename... Params>
+inline const NormalizedComponent<Params...>& NormalizedComponentFuture<Params...>::get() const {
+  return future.get();
+}
+
+template <typename... Params, typename... FormalArgs, typename... Args>
+inline NormalizedComponentFuture<Params...> normalizeAsync(Component<Params...> (*getComponent)(FormalArgs...),
+                                                           Args&&... args) {
+  return NormalizedComponentFuture<Params...>(getComponent, std::forward<Args>(args)...);
+}
+
+template <typename... Params, typename... FormalArgs, typename... Args>
+inline NormalizedComponentFuture<Params...> normalizeAsync(const NormalizedComponentOptions& options,
+                                                           Component<Params...> (*getComponent)(FormalArgs...),
+                                                           Args&&... args) {
+  return NormalizedComponentFuture<Params...>(options, getComponent, std::forward<Args>(args)...);
+}
+
+} // namespace fruit
+
+#endif // FRUIT_NORMALIZED_COMPONENT_FUTURE_DEFN_H
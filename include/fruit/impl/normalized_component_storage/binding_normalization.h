@@ -26,6 +26,8 @@
 #include <fruit/impl/data_structures/arena_allocator.h>
 #include <fruit/impl/data_structures/fixed_size_allocator.h>
 #include <fruit/impl/normalized_component_storage/normalized_component_storage.h>
+#include <fruit/impl/normalized_component_storage/component_expansion_cache.h>
+#include <fruit/impl/normalized_component_storage/parallel_component_expander.h>
 #include <fruit/impl/util/hash_helpers.h>
 
 namespace fruit {
@@ -57,18 +59,29 @@ public:
    * Normalizes the toplevel entries and performs binding compression.
    * This does *not* keep track of what binding compressions were performed, so they can't be undone. When we might need
    * to undo the binding compression, use normalizeBindingsWithUndoableBindingCompression() instead.
+   * If num_threads > 1, the lazy components are expanded using a ParallelComponentExpander with that many threads.
+   * If component_expansion_cache is not nullptr, the lazy components are expanded through it.
+   * See InjectorOptions::lazy_normalization and InjectorOptions::strict_lazy_normalization for the next 2 params.
+   * If num_removed_unreachable_bindings is not nullptr, the bindings that are not reachable from the exposed types or
+   * from the multibindings are removed, and the number of removed bindings is stored there.
    */
   static void normalizeBindingsWithPermanentBindingCompression(
       FixedSizeVector<ComponentStorageEntry>&& toplevel_entries,
       FixedSizeAllocator::FixedSizeAllocatorData& fixed_size_allocator_data, MemoryPool& memory_pool,
       const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
       std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& bindings_vector,
-      std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings);
+      std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings, std::size_t num_threads,
+      ComponentExpansionCache* component_expansion_cache, bool lazy_normalization, bool strict_lazy_normalization,
+      std::size_t* num_removed_unreachable_bindings);
 
   /**
    * Normalizes the toplevel entries and performs binding compression, but keeps track of which compressions were
    * performed so that we can later undo some of them if needed.
    * This is more expensive than normalizeBindingsWithPermanentBindingCompression(), use that when it suffices.
+   * types_shared_across_injectors is an output parameter, it's set to the types marked with
+   * PartialComponent::shareAcrossInjectors() and all their (direct or indirect) dependencies.
+   * If num_threads > 1, the lazy components are expanded using a ParallelComponentExpander with that many threads.
+   * If component_expansion_cache is not nullptr, the lazy components are expanded through it.
    */
   static void normalizeBindingsWithUndoableBindingCompression(
       FixedSizeVector<ComponentStorageEntry>&& toplevel_entries,
@@ -78,12 +91,19 @@ public:
       const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
       std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& bindings_vector,
       std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings,
+      std::vector<TypeId, ArenaAllocator<TypeId>>& types_shared_across_injectors,
       BindingCompressionInfoMap& bindingCompressionInfoMap,
       LazyComponentWithNoArgsSet& fully_expanded_components_with_no_args,
       LazyComponentWithArgsSet& fully_expanded_components_with_args,
       LazyComponentWithNoArgsReplacementMap& component_with_no_args_replacements,
-      LazyComponentWithArgsReplacementMap& component_with_args_replacements);
+      LazyComponentWithArgsReplacementMap& component_with_args_replacements, std::size_t num_threads,
+      ComponentExpansionCache* component_expansion_cache);
 
+  /**
+   * Normalizes the toplevel entries, that will be added to base_normalized_component.
+   * When possible, this reuses (or saves) a NormalizedComponentStorage::InjectorPlan in base_normalized_component
+   * instead of normalizing the entries again.
+   */
   static void normalizeBindingsAndAddTo(
       FixedSizeVector<ComponentStorageEntry>&& toplevel_entries, MemoryPool& memory_pool,
       const NormalizedComponentStorage& base_normalized_component,
@@ -95,6 +115,59 @@ private:
   using multibindings_vector_elem_t = std::pair<ComponentStorageEntry, ComponentStorageEntry>;
   using multibindings_vector_t = std::vector<multibindings_vector_elem_t, ArenaAllocator<multibindings_vector_elem_t>>;
 
+  using InjectorPlan = NormalizedComponentStorage::InjectorPlan;
+
+  /**
+   * Same as normalizeBindingsAndAddTo(), but without using injector plans.
+   */
+  static void normalizeBindingsAndAddToWithoutInjectorPlan(
+      FixedSizeVector<ComponentStorageEntry>&& toplevel_entries, MemoryPool& memory_pool,
+      const NormalizedComponentStorage& base_normalized_component,
+      FixedSizeAllocator::FixedSizeAllocatorData& fixed_size_allocator_data,
+      std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& new_bindings_vector,
+      std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings);
+
+  /**
+   * If toplevel_entries is a single lazy component that would be expanded by normalizeBindingsAndAddTo(), expands it
+   * in the same way and returns true. In that case, expanded_entries is set to the corresponding *_END_MARKER entry
+   * (that now owns the lazy component) followed by the component's entries, and normalizing expanded_entries is
+   * equivalent to normalizing toplevel_entries.
+   * Otherwise returns false and leaves toplevel_entries unchanged.
+   */
+  static bool expandComponentForInjectorPlan(
+      FixedSizeVector<ComponentStorageEntry>& toplevel_entries,
+      const NormalizedComponentStorage& base_normalized_component,
+      std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& expanded_entries,
+      ComponentStorageEntry::LazyComponentWithNoArgs::erased_fun_t& component_fun);
+
+  /**
+   * Returns true if all the entries in [first, last) can be used in an InjectorPlan (e.g. they're not lazy components
+   * with args, whose args could be different for the next component).
+   */
+  static bool canUseInjectorPlan(const ComponentStorageEntry* first, const ComponentStorageEntry* last);
+
+  // Like operator== for the entries supported by canUseInjectorPlan(), except that the object_ptr of
+  // BINDING_FOR_CONSTRUCTED_OBJECT entries is ignored.
+  static bool isSameEntryForInjectorPlan(const ComponentStorageEntry& x, const ComponentStorageEntry& y);
+
+  static std::size_t hashEntriesForInjectorPlan(const ComponentStorageEntry* first, const ComponentStorageEntry* last);
+
+  // Returns nullptr if there's no matching plan. This doesn't lock injector_plans_mutex (see
+  // NormalizedComponentStorage::num_injector_plans).
+  static const InjectorPlan* findInjectorPlan(const NormalizedComponentStorage& base_normalized_component,
+                                              ComponentStorageEntry::LazyComponentWithNoArgs::erased_fun_t component_fun,
+                                              const ComponentStorageEntry* first, const ComponentStorageEntry* last,
+                                              std::size_t hash);
+
+  // Saves the result of a normalization of the entries [first, last) as a new InjectorPlan (if possible).
+  static void saveInjectorPlan(
+      const NormalizedComponentStorage& base_normalized_component,
+      ComponentStorageEntry::LazyComponentWithNoArgs::erased_fun_t component_fun, const ComponentStorageEntry* first,
+      const ComponentStorageEntry* last, std::size_t hash, MemoryPool& memory_pool,
+      const FixedSizeAllocator::FixedSizeAllocatorData& fixed_size_allocator_data,
+      const std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& new_bindings_vector,
+      const std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings);
+
   /**
    * Adds the multibindings in multibindings_vector to the `multibindings' map.
    * Each element of multibindings_vector is a pair, where the first element is the multibinding and the second is the
@@ -104,12 +177,43 @@ private:
                                FixedSizeAllocator::FixedSizeAllocatorData& fixed_size_allocator_data,
                                const multibindings_vector_t& multibindings_vector);
 
+  /**
+   * Adds to types_shared_across_injectors all the (direct or indirect) dependencies of the types in it, removing any
+   * duplicates. Reports a fatal error if one of these types is not bound in binding_data_map.
+   */
+  static void addDependenciesOfTypesSharedAcrossInjectors(
+      const HashMapWithArenaAllocator<TypeId, ComponentStorageEntry>& binding_data_map,
+      std::vector<TypeId, ArenaAllocator<TypeId>>& types_shared_across_injectors, MemoryPool& memory_pool);
+
+  /**
+   * Returns the types that are (directly or indirectly) reachable from the types in [first, last) through the bindings
+   * in binding_data_map, including the types in [first, last) and the reachable types that are not bound.
+   */
+  static HashSetWithArenaAllocator<TypeId>
+  findReachableTypes(const HashMapWithArenaAllocator<TypeId, ComponentStorageEntry>& binding_data_map,
+                     const TypeId* first, const TypeId* last, MemoryPool& memory_pool);
+
   static void printLazyComponentInstallationLoop(
       const std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& entries_to_process,
       const ComponentStorageEntry& last_entry);
 
+  /**
+   * The parameters of a lazy normalization, see InjectorOptions::lazy_normalization.
+   */
+  struct LazyNormalizationParams {
+    // Only the lazy components needed to inject these types (and the dependencies of the multibindings) are expanded.
+    const std::vector<TypeId, ArenaAllocator<TypeId>>* exposed_types;
+
+    // If this is true, the lazy components that are not needed are still expanded at the end, so that their bindings
+    // are checked too.
+    bool strict;
+  };
+
   /**
    * Normalizes the toplevel entries (but doesn't perform binding compression).
+   * If component_expander is not nullptr, the lazy components that it expanded are not expanded again.
+   * If component_expansion_cache is not nullptr, the other lazy components are expanded through it.
+   * If lazy_normalization is not nullptr, only the lazy components needed for the types in it are expanded.
    */
   template <typename... Functors>
   static void normalizeBindings(FixedSizeVector<ComponentStorageEntry>&& toplevel_entries,
@@ -117,7 +221,9 @@ private:
                                 MemoryPool& memory_pool, MemoryPool& memory_pool_for_fully_expanded_components_maps,
                                 MemoryPool& memory_pool_for_component_replacements_maps,
                                 HashMapWithArenaAllocator<TypeId, ComponentStorageEntry>& binding_data_map,
-                                Functors... functors);
+                                ParallelComponentExpander* component_expander,
+                                ComponentExpansionCache* component_expansion_cache,
+                                const LazyNormalizationParams* lazy_normalization, Functors... functors);
 
   struct BindingCompressionInfo {
     TypeId i_type_id;
@@ -129,6 +235,8 @@ private:
    * - SaveCompressedBindingUndoInfo should have an operator()(TypeId, CompressedBindingUndoInfo) that will be called
    *   with (c_type_id, undo_info) for each binding compression that was applied (and that therefore might need to be
    *   undone later).
+   * - If num_removed_unreachable_bindings is not nullptr, the unreachable bindings are removed before the binding
+   *   compression (see removeUnreachableBindings()) and the number of removed bindings is stored there.
    */
   template <typename SaveCompressedBindingUndoInfo, typename SaveFullyExpandedComponentsWithNoArgs,
             typename SaveFullyExpandedComponentsWithArgs, typename SaveComponentReplacementsWithNoArgs,
@@ -141,11 +249,14 @@ private:
       const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
       std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& bindings_vector,
       std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings,
+      std::vector<TypeId, ArenaAllocator<TypeId>>& types_shared_across_injectors,
       SaveCompressedBindingUndoInfo save_compressed_binding_undo_info,
       SaveFullyExpandedComponentsWithNoArgs save_fully_expanded_components_with_no_args,
       SaveFullyExpandedComponentsWithArgs save_fully_expanded_components_with_args,
       SaveComponentReplacementsWithNoArgs save_component_replacements_with_no_args,
-      SaveComponentReplacementsWithArgs save_component_replacements_with_args);
+      SaveComponentReplacementsWithArgs save_component_replacements_with_args, std::size_t num_threads,
+      ComponentExpansionCache* component_expansion_cache, const LazyNormalizationParams* lazy_normalization,
+      std::size_t* num_removed_unreachable_bindings);
 
   /**
    * bindingCompressionInfoMap is an output parameter. This function will store information on all performed binding
@@ -161,8 +272,24 @@ private:
                             HashMapWithArenaAllocator<TypeId, BindingCompressionInfo>&& compressed_bindings_map,
                             MemoryPool& memory_pool, const multibindings_vector_t& multibindings_vector,
                             const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
+                            const std::vector<TypeId, ArenaAllocator<TypeId>>& types_shared_across_injectors,
                             SaveCompressedBindingUndoInfo save_compressed_binding_undo_info);
 
+  /**
+   * Removes from binding_data_map the bindings that are not reachable from the exposed types, from the dependencies of
+   * the multibindings or from the types shared across injectors, since they can't be used. Also removes the
+   * compressed bindings involving these types, and the corresponding types from fixed_size_allocator_data.
+   * Returns the number of bindings removed.
+   */
+  static std::size_t
+  removeUnreachableBindings(HashMapWithArenaAllocator<TypeId, ComponentStorageEntry>& binding_data_map,
+                            HashMapWithArenaAllocator<TypeId, BindingCompressionInfo>& compressed_bindings_map,
+                            FixedSizeAllocator::FixedSizeAllocatorData& fixed_size_allocator_data,
+                            const multibindings_vector_t& multibindings_vector,
+                            const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
+                            const std::vector<TypeId, ArenaAllocator<TypeId>>& types_shared_across_injectors,
+                            MemoryPool& memory_pool);
+
   static void handlePreexistingLazyComponentWithArgsReplacement(ComponentStorageEntry& replaced_component_entry,
                                                                 const ComponentStorageEntry& preexisting_replacement,
                                                                 ComponentStorageEntry& new_replacement);
@@ -171,7 +298,8 @@ private:
                                                                   const ComponentStorageEntry& preexisting_replacement,
                                                                   ComponentStorageEntry& new_replacement);
 
-  template <typename HandleCompressedBinding, typename HandleMultibinding, typename FindNormalizedBinding,
+  template <typename HandleCompressedBinding, typename HandleMultibinding,
+            typename HandleTypeSharedAcrossInjectors, typename FindNormalizedBinding,
             typename IsValidItr, typename IsNormalizedBindingItrForConstructedObject, typename GetObjectPtr,
             typename GetCreate, typename IsComponentWithNoArgsAlreadyExpandedInNormalizedComponent,
             typename IsComponentWithArgsAlreadyExpandedInNormalizedComponent,
@@ -195,6 +323,12 @@ private:
      */
     HandleMultibinding handle_multibinding;
 
+    /**
+     * This should have an operator()(ComponentStorageEntry&) that will be called for each TYPE_SHARED_ACROSS_INJECTORS
+     * entry.
+     */
+    HandleTypeSharedAcrossInjectors handle_type_shared_across_injectors;
+
     /**
      * This should have a
      * NormalizedBindingItr operator()(TypeId)
@@ -270,11 +404,33 @@ private:
     MemoryPool& memory_pool_for_fully_expanded_components_maps;
     MemoryPool& memory_pool_for_component_replacements_maps;
     HashMapWithArenaAllocator<TypeId, ComponentStorageEntry>& binding_data_map;
+    ParallelComponentExpander* component_expander;
+    ComponentExpansionCache* component_expansion_cache;
+    const LazyNormalizationParams* lazy_normalization;
     BindingNormalizationFunctors<Functors...> functors;
 
     // These are in reversed order (note that toplevel_entries must also be in reverse order).
     std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>> entries_to_process;
 
+    // The fields below are only used if lazy_normalization is not nullptr.
+
+    // The types that must be injectable: the exposed types and the dependencies of the multibindings found so far.
+    std::vector<TypeId, ArenaAllocator<TypeId>> lazy_normalization_roots =
+        std::vector<TypeId, ArenaAllocator<TypeId>>(ArenaAllocator<TypeId>(memory_pool));
+
+    // The types reachable from lazy_normalization_roots that had no binding at the last check (see
+    // scheduleNeededDeferredComponents()). The lazy components that provide none of these are deferred.
+    HashSetWithArenaAllocator<TypeId> missing_types = createHashSetWithArenaAllocator<TypeId>(20 /* capacity */,
+                                                                                             memory_pool);
+
+    // The lazy components that were deferred and not expanded yet. For components with args, this owns the objects.
+    std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>> deferred_components =
+        std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>(
+            ArenaAllocator<ComponentStorageEntry>(memory_pool));
+
+    // When this is true, lazy components are always expanded (even if they're not needed).
+    bool expand_all_components = false;
+
     // These sets contain the lazy components whose expansion has already completed.
     LazyComponentWithNoArgsSet fully_expanded_components_with_no_args =
         NormalizedComponentStorage::createLazyComponentWithNoArgsSet(20 /* capacity */,
@@ -303,6 +459,9 @@ private:
                                 MemoryPool& memory_pool, MemoryPool& memory_pool_for_fully_expanded_components_maps,
                                 MemoryPool& memory_pool_for_component_replacements_maps,
                                 HashMapWithArenaAllocator<TypeId, ComponentStorageEntry>& binding_data_map,
+                                ParallelComponentExpander* component_expander,
+                                ComponentExpansionCache* component_expansion_cache,
+                                const LazyNormalizationParams* lazy_normalization,
                                 BindingNormalizationFunctors<Functors...> functors);
 
     BindingNormalizationContext(const BindingNormalizationContext&) = delete;
@@ -332,6 +491,9 @@ private:
   template <typename... Params>
   static void handleMultibindingVectorCreator(BindingNormalizationContext<Params...>& context);
 
+  template <typename... Params>
+  static void handleTypeSharedAcrossInjectors(BindingNormalizationContext<Params...>& context);
+
   template <typename... Params>
   static void handleComponentWithoutArgsEndMarker(BindingNormalizationContext<Params...>& context);
 
@@ -350,12 +512,31 @@ private:
   template <typename... Params>
   static void handleLazyComponentWithNoArgs(BindingNormalizationContext<Params...>& context);
 
+  // Lazy normalization only: returns true if a lazy component that provides these types must be expanded now (instead
+  // of being deferred).
+  template <typename... Params>
+  static bool isLazyComponentNeeded(const BindingNormalizationContext<Params...>& context,
+                                    const BindingDeps* provided_types);
+
+  // Lazy normalization only: adds the dependencies of this multibinding to context.lazy_normalization_roots.
+  template <typename... Params>
+  static void addMultibindingDepsToLazyNormalizationRoots(BindingNormalizationContext<Params...>& context,
+                                                          const ComponentStorageEntry& multibinding_entry);
+
+  // Lazy normalization only: called when context.entries_to_process is empty. Updates context.missing_types and moves
+  // the deferred components that are now needed to entries_to_process. Returns false if there are none, i.e. if the
+  // normalization is complete.
+  template <typename... Params>
+  static bool scheduleNeededDeferredComponents(BindingNormalizationContext<Params...>& context);
+
   template <typename... Params>
   static void performComponentReplacement(BindingNormalizationContext<Params...>& context,
                                           const ComponentStorageEntry& replacement);
 
   static void printMultipleBindingsError(TypeId type);
 
+  static void printTypeSharedAcrossInjectorsNotBoundError(TypeId shared_type, TypeId unbound_type);
+
   static void printIncompatibleComponentReplacementsError(const ComponentStorageEntry& replaced_component_entry,
                                                           const ComponentStorageEntry& replacement_component_entry1,
                                                           const ComponentStorageEntry& replacement_component_entry2);
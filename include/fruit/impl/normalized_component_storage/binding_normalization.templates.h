@@ -22,6 +22,9 @@
 #error "binding_normalization.templates.h included in non-cpp file."
 #endif
 
+#include <algorithm>
+#include <memory>
+
 #include <fruit/impl/component_storage/component_storage_entry.h>
 #include <fruit/impl/normalized_component_storage/binding_normalization.h>
 #include <fruit/impl/util/type_info.h>
@@ -37,15 +40,24 @@ BindingNormalization::BindingNormalizationContext<Functors...>::BindingNormaliza
     MemoryPool& memory_pool_for_fully_expanded_components_maps,
     MemoryPool& memory_pool_for_component_replacements_maps,
     HashMapWithArenaAllocator<TypeId, ComponentStorageEntry>& binding_data_map,
-    BindingNormalizationFunctors<Functors...> functors)
+    ParallelComponentExpander* component_expander, ComponentExpansionCache* component_expansion_cache,
+    const LazyNormalizationParams* lazy_normalization, BindingNormalizationFunctors<Functors...> functors)
     : fixed_size_allocator_data(fixed_size_allocator_data), memory_pool(memory_pool),
       memory_pool_for_fully_expanded_components_maps(memory_pool_for_fully_expanded_components_maps),
       memory_pool_for_component_replacements_maps(memory_pool_for_component_replacements_maps),
-      binding_data_map(binding_data_map), functors(functors),
-      entries_to_process(toplevel_entries.begin(), toplevel_entries.end(),
-                         ArenaAllocator<ComponentStorageEntry>(memory_pool)) {
+      binding_data_map(binding_data_map), component_expander(component_expander),
+      component_expansion_cache(component_expansion_cache), lazy_normalization(lazy_normalization),
+      functors(functors), entries_to_process(toplevel_entries.begin(), toplevel_entries.end(),
+                                             ArenaAllocator<ComponentStorageEntry>(memory_pool)) {
 
   toplevel_entries.clear();
+
+  if (lazy_normalization != nullptr) {
+    lazy_normalization_roots.insert(lazy_normalization_roots.end(), lazy_normalization->exposed_types->begin(),
+                                    lazy_normalization->exposed_types->end());
+    // None of these has a binding yet.
+    missing_types.insert(lazy_normalization_roots.begin(), lazy_normalization_roots.end());
+  }
 }
 
 template <typename... Functors>
@@ -53,6 +65,10 @@ BindingNormalization::BindingNormalizationContext<Functors...>::~BindingNormaliz
   FruitAssert(components_with_no_args_with_expansion_in_progress.empty());
   FruitAssert(components_with_args_with_expansion_in_progress.empty());
 
+  for (const ComponentStorageEntry& entry : deferred_components) {
+    entry.destroy();
+  }
+
   for (const ComponentStorageEntry::LazyComponentWithArgs& x : fully_expanded_components_with_args) {
     x.destroy();
   }
@@ -77,7 +93,9 @@ void BindingNormalization::normalizeBindings(FixedSizeVector<ComponentStorageEnt
                                              MemoryPool& memory_pool_for_fully_expanded_components_maps,
                                              MemoryPool& memory_pool_for_component_replacements_maps,
                                              HashMapWithArenaAllocator<TypeId, ComponentStorageEntry>& binding_data_map,
-                                             Functors... functors) {
+                                             ParallelComponentExpander* component_expander,
+                                             ComponentExpansionCache* component_expansion_cache,
+                                             const LazyNormalizationParams* lazy_normalization, Functors... functors) {
 
   FruitAssert(binding_data_map.empty());
 
@@ -85,70 +103,78 @@ void BindingNormalization::normalizeBindings(FixedSizeVector<ComponentStorageEnt
 
   Context context(toplevel_entries, fixed_size_allocator_data, memory_pool,
                   memory_pool_for_fully_expanded_components_maps, memory_pool_for_component_replacements_maps,
-                  binding_data_map, BindingNormalizationFunctors<Functors...>{functors...});
+                  binding_data_map, component_expander, component_expansion_cache, lazy_normalization,
+                  BindingNormalizationFunctors<Functors...>{functors...});
 
   // When we expand a lazy component, instead of removing it from the stack we change its kind (in entries_to_process)
   // to one of the *_END_MARKER kinds. This allows to keep track of the "call stack" for the expansion.
 
-  while (!context.entries_to_process.empty()) {
-    switch (context.entries_to_process.back().kind) { // LCOV_EXCL_BR_LINE
-    case ComponentStorageEntry::Kind::BINDING_FOR_CONSTRUCTED_OBJECT:
-      handleBindingForConstructedObject(context);
-      break;
-
-    case ComponentStorageEntry::Kind::BINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_ALLOCATION:
-      handleBindingForObjectToConstructThatNeedsAllocation(context);
-      break;
-
-    case ComponentStorageEntry::Kind::BINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_NO_ALLOCATION:
-      handleBindingForObjectToConstructThatNeedsNoAllocation(context);
-      break;
-
-    case ComponentStorageEntry::Kind::COMPRESSED_BINDING:
-      handleCompressedBinding(context);
-      break;
-
-    case ComponentStorageEntry::Kind::MULTIBINDING_FOR_CONSTRUCTED_OBJECT:
-    case ComponentStorageEntry::Kind::MULTIBINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_ALLOCATION:
-    case ComponentStorageEntry::Kind::MULTIBINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_NO_ALLOCATION:
-      handleMultibinding(context);
-      break;
-
-    case ComponentStorageEntry::Kind::MULTIBINDING_VECTOR_CREATOR:
-      handleMultibindingVectorCreator(context);
-      break;
-
-    case ComponentStorageEntry::Kind::COMPONENT_WITHOUT_ARGS_END_MARKER:
-      handleComponentWithoutArgsEndMarker(context);
-      break;
-
-    case ComponentStorageEntry::Kind::COMPONENT_WITH_ARGS_END_MARKER:
-      handleComponentWithArgsEndMarker(context);
-      break;
-
-    case ComponentStorageEntry::Kind::REPLACED_LAZY_COMPONENT_WITH_ARGS:
-      handleReplacedLazyComponentWithArgs(context);
-      break;
-
-    case ComponentStorageEntry::Kind::REPLACED_LAZY_COMPONENT_WITH_NO_ARGS:
-      handleReplacedLazyComponentWithNoArgs(context);
-      break;
-
-    case ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_ARGS:
-      handleLazyComponentWithArgs(context);
-      break;
-
-    case ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_NO_ARGS:
-      handleLazyComponentWithNoArgs(context);
-      break;
-
-    default:
+  // In a lazy normalization, this is repeated as long as some deferred components turn out to be needed.
+  do {
+    while (!context.entries_to_process.empty()) {
+      switch (context.entries_to_process.back().kind) { // LCOV_EXCL_BR_LINE
+      case ComponentStorageEntry::Kind::BINDING_FOR_CONSTRUCTED_OBJECT:
+        handleBindingForConstructedObject(context);
+        break;
+
+      case ComponentStorageEntry::Kind::BINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_ALLOCATION:
+        handleBindingForObjectToConstructThatNeedsAllocation(context);
+        break;
+
+      case ComponentStorageEntry::Kind::BINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_NO_ALLOCATION:
+        handleBindingForObjectToConstructThatNeedsNoAllocation(context);
+        break;
+
+      case ComponentStorageEntry::Kind::COMPRESSED_BINDING:
+        handleCompressedBinding(context);
+        break;
+
+      case ComponentStorageEntry::Kind::MULTIBINDING_FOR_CONSTRUCTED_OBJECT:
+      case ComponentStorageEntry::Kind::MULTIBINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_ALLOCATION:
+      case ComponentStorageEntry::Kind::MULTIBINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_NO_ALLOCATION:
+        handleMultibinding(context);
+        break;
+
+      case ComponentStorageEntry::Kind::MULTIBINDING_VECTOR_CREATOR:
+        handleMultibindingVectorCreator(context);
+        break;
+
+      case ComponentStorageEntry::Kind::TYPE_SHARED_ACROSS_INJECTORS:
+        handleTypeSharedAcrossInjectors(context);
+        break;
+
+      case ComponentStorageEntry::Kind::COMPONENT_WITHOUT_ARGS_END_MARKER:
+        handleComponentWithoutArgsEndMarker(context);
+        break;
+
+      case ComponentStorageEntry::Kind::COMPONENT_WITH_ARGS_END_MARKER:
+        handleComponentWithArgsEndMarker(context);
+        break;
+
+      case ComponentStorageEntry::Kind::REPLACED_LAZY_COMPONENT_WITH_ARGS:
+        handleReplacedLazyComponentWithArgs(context);
+        break;
+
+      case ComponentStorageEntry::Kind::REPLACED_LAZY_COMPONENT_WITH_NO_ARGS:
+        handleReplacedLazyComponentWithNoArgs(context);
+        break;
+
+      case ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_ARGS:
+        handleLazyComponentWithArgs(context);
+        break;
+
+      case ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_NO_ARGS:
+        handleLazyComponentWithNoArgs(context);
+        break;
+
+      default:
 #if FRUIT_EXTRA_DEBUG
-      std::cerr << "Unexpected kind: " << (std::size_t)context.entries_to_process.back().kind << std::endl;
+        std::cerr << "Unexpected kind: " << (std::size_t)context.entries_to_process.back().kind << std::endl;
 #endif
-      FRUIT_UNREACHABLE; // LCOV_EXCL_LINE
+        FRUIT_UNREACHABLE; // LCOV_EXCL_LINE
+      }
     }
-  }
+  } while (context.lazy_normalization != nullptr && scheduleNeededDeferredComponents(context));
 
   context.functors.save_fully_expanded_components_with_no_args(context.fully_expanded_components_with_no_args);
   context.functors.save_fully_expanded_components_with_args(context.fully_expanded_components_with_args);
@@ -284,6 +310,9 @@ void BindingNormalization::handleMultibinding(BindingNormalizationContext<Params
   ComponentStorageEntry vector_creator_entry = std::move(context.entries_to_process.back());
   context.entries_to_process.pop_back();
   FruitAssert(vector_creator_entry.kind == ComponentStorageEntry::Kind::MULTIBINDING_VECTOR_CREATOR);
+  if (context.lazy_normalization != nullptr) {
+    addMultibindingDepsToLazyNormalizationRoots(context, entry);
+  }
   context.functors.handle_multibinding(entry, vector_creator_entry);
 }
 
@@ -300,9 +329,21 @@ void BindingNormalization::handleMultibindingVectorCreator(BindingNormalizationC
                   ComponentStorageEntry::Kind::MULTIBINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_ALLOCATION ||
               multibinding_entry.kind ==
                   ComponentStorageEntry::Kind::MULTIBINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_NO_ALLOCATION);
+  if (context.lazy_normalization != nullptr) {
+    addMultibindingDepsToLazyNormalizationRoots(context, multibinding_entry);
+  }
   context.functors.handle_multibinding(multibinding_entry, entry);
 }
 
+template <typename... Params>
+FRUIT_ALWAYS_INLINE inline void
+BindingNormalization::handleTypeSharedAcrossInjectors(BindingNormalizationContext<Params...>& context) {
+  ComponentStorageEntry entry = context.entries_to_process.back();
+  FruitAssert(entry.kind == ComponentStorageEntry::Kind::TYPE_SHARED_ACROSS_INJECTORS);
+  context.entries_to_process.pop_back();
+  context.functors.handle_type_shared_across_injectors(entry);
+}
+
 template <typename... Params>
 FRUIT_ALWAYS_INLINE inline void
 BindingNormalization::handleComponentWithoutArgsEndMarker(BindingNormalizationContext<Params...>& context) {
@@ -478,6 +519,15 @@ BindingNormalization::handleLazyComponentWithArgs(BindingNormalizationContext<Pa
     return;
   }
 
+  if (context.lazy_normalization != nullptr &&
+      !isLazyComponentNeeded(context, entry.lazy_component_with_args.component->getProvidedTypes())) {
+    // This component might be expanded later, see scheduleNeededDeferredComponents().
+    // The object is now owned by deferred_components.
+    context.deferred_components.push_back(entry);
+    context.entries_to_process.pop_back();
+    return;
+  }
+
   bool actually_inserted =
       context.components_with_args_with_expansion_in_progress.insert(entry.lazy_component_with_args).second;
   if (!actually_inserted) {
@@ -496,7 +546,15 @@ BindingNormalization::handleLazyComponentWithArgs(BindingNormalizationContext<Pa
 
   // Note that this can also add other lazy components, so the resulting bindings can have a non-intuitive
   // (although deterministic) order.
-  context.entries_to_process.back().lazy_component_with_args.component->addBindings(context.entries_to_process);
+  if (context.component_expander != nullptr &&
+      context.component_expander->takeBindings(entry.lazy_component_with_args, context.entries_to_process)) {
+    return;
+  }
+  if (context.component_expansion_cache != nullptr) {
+    context.component_expansion_cache->addBindings(entry.lazy_component_with_args, context.entries_to_process);
+  } else {
+    entry.lazy_component_with_args.component->addBindings(context.entries_to_process);
+  }
 }
 
 template <typename... Params>
@@ -530,6 +588,14 @@ BindingNormalization::handleLazyComponentWithNoArgs(BindingNormalizationContext<
     return;
   }
 
+  if (context.lazy_normalization != nullptr &&
+      !isLazyComponentNeeded(context, entry.lazy_component_with_no_args.getProvidedTypes())) {
+    // This component might be expanded later, see scheduleNeededDeferredComponents().
+    context.deferred_components.push_back(entry);
+    context.entries_to_process.pop_back();
+    return;
+  }
+
   bool actually_inserted =
       context.components_with_no_args_with_expansion_in_progress.insert(entry.lazy_component_with_no_args).second;
   if (!actually_inserted) {
@@ -548,7 +614,97 @@ BindingNormalization::handleLazyComponentWithNoArgs(BindingNormalizationContext<
 
   // Note that this can also add other lazy components, so the resulting bindings can have a non-intuitive
   // (although deterministic) order.
-  context.entries_to_process.back().lazy_component_with_no_args.addBindings(context.entries_to_process);
+  if (context.component_expander != nullptr &&
+      context.component_expander->takeBindings(entry.lazy_component_with_no_args, context.entries_to_process)) {
+    return;
+  }
+  if (context.component_expansion_cache != nullptr) {
+    context.component_expansion_cache->addBindings(entry.lazy_component_with_no_args, context.entries_to_process);
+  } else {
+    entry.lazy_component_with_no_args.addBindings(context.entries_to_process);
+  }
+}
+
+template <typename... Params>
+bool BindingNormalization::isLazyComponentNeeded(const BindingNormalizationContext<Params...>& context,
+                                                 const BindingDeps* provided_types) {
+  if (context.expand_all_components) {
+    return true;
+  }
+  for (std::size_t i = 0; i < provided_types->num_deps; ++i) {
+    if (context.missing_types.count(provided_types->deps[i]) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename... Params>
+void BindingNormalization::addMultibindingDepsToLazyNormalizationRoots(
+    BindingNormalizationContext<Params...>& context, const ComponentStorageEntry& multibinding_entry) {
+  if (multibinding_entry.kind == ComponentStorageEntry::Kind::MULTIBINDING_FOR_CONSTRUCTED_OBJECT) {
+    return;
+  }
+  const BindingDeps* deps = multibinding_entry.multibinding_for_object_to_construct.deps;
+  context.lazy_normalization_roots.insert(context.lazy_normalization_roots.end(), deps->deps,
+                                          deps->deps + deps->num_deps);
+}
+
+template <typename... Params>
+bool BindingNormalization::scheduleNeededDeferredComponents(BindingNormalizationContext<Params...>& context) {
+  FruitAssert(context.entries_to_process.empty());
+  if (context.deferred_components.empty()) {
+    return false;
+  }
+
+  // Find the types that are reachable from the roots (through the bindings found so far) but that have no binding.
+  context.missing_types.clear();
+  HashSetWithArenaAllocator<TypeId> reachable_types =
+      findReachableTypes(context.binding_data_map, context.lazy_normalization_roots.data(),
+                         context.lazy_normalization_roots.data() + context.lazy_normalization_roots.size(),
+                         context.memory_pool);
+  for (TypeId type : reachable_types) {
+    if (context.binding_data_map.count(type) == 0) {
+      context.missing_types.insert(type);
+    }
+  }
+
+  if (context.missing_types.empty() && !context.lazy_normalization->strict) {
+    // All the needed types are bound, the remaining components are not expanded.
+    for (const ComponentStorageEntry& entry : context.deferred_components) {
+      entry.destroy();
+    }
+    context.deferred_components.clear();
+    return false;
+  }
+
+  // The components are pushed in reverse order, so that they're expanded in the order in which they were deferred.
+  std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>> still_deferred_components(
+      ArenaAllocator<ComponentStorageEntry>(context.memory_pool));
+  for (auto itr = context.deferred_components.rbegin(); itr != context.deferred_components.rend(); ++itr) {
+    const ComponentStorageEntry& entry = *itr;
+    const BindingDeps* provided_types = entry.kind == ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_NO_ARGS
+                                            ? entry.lazy_component_with_no_args.getProvidedTypes()
+                                            : entry.lazy_component_with_args.component->getProvidedTypes();
+    if (isLazyComponentNeeded(context, provided_types)) {
+      context.entries_to_process.push_back(entry);
+    } else {
+      still_deferred_components.push_back(entry);
+    }
+  }
+
+  if (context.entries_to_process.empty()) {
+    // Either this is a strict normalization and all the needed types are bound, or no deferred component provides the
+    // missing types in its signature (they might be bound by a component that doesn't expose them). Either way, all
+    // the remaining components must be expanded.
+    context.expand_all_components = true;
+    context.entries_to_process.insert(context.entries_to_process.end(), still_deferred_components.begin(),
+                                      still_deferred_components.end());
+    still_deferred_components.clear();
+  }
+
+  context.deferred_components.assign(still_deferred_components.rbegin(), still_deferred_components.rend());
+  return true;
 }
 
 template <typename SaveCompressedBindingUndoInfo>
@@ -558,6 +714,7 @@ BindingNormalization::performBindingCompression(
     HashMapWithArenaAllocator<TypeId, BindingCompressionInfo>&& compressed_bindings_map, MemoryPool& memory_pool,
     const multibindings_vector_t& multibindings_vector,
     const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
+    const std::vector<TypeId, ArenaAllocator<TypeId>>& types_shared_across_injectors,
     SaveCompressedBindingUndoInfo save_compressed_binding_undo_info) {
   using result_t = std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>;
   result_t result = result_t(ArenaAllocator<ComponentStorageEntry>(memory_pool));
@@ -591,6 +748,30 @@ BindingNormalization::performBindingCompression(
 #endif
   }
 
+  // We can't compress the binding if I or C are shared across injectors: the shared object must be constructed only
+  // once (in the normalized component), but the injectors created from it might need to undo the compression.
+  for (TypeId type : types_shared_across_injectors) {
+    compressed_bindings_map.erase(type);
+#if FRUIT_EXTRA_DEBUG
+    std::cout << "InjectorStorage: ignoring compressed binding for " << type
+              << " because it's shared across injectors." << std::endl;
+#endif
+  }
+  if (!types_shared_across_injectors.empty()) {
+    for (auto itr = compressed_bindings_map.begin(); itr != compressed_bindings_map.end();) {
+      if (std::find(types_shared_across_injectors.begin(), types_shared_across_injectors.end(),
+                    itr->second.i_type_id) != types_shared_across_injectors.end()) {
+#if FRUIT_EXTRA_DEBUG
+        std::cout << "InjectorStorage: ignoring compressed binding for " << itr->first << " because "
+                  << itr->second.i_type_id << " is shared across injectors." << std::endl;
+#endif
+        itr = compressed_bindings_map.erase(itr);
+      } else {
+        ++itr;
+      }
+    }
+  }
+
   // We can't compress the binding if some type X depends on C and X!=I.
   for (auto& binding_data_map_entry : binding_data_map) {
     TypeId x_id = binding_data_map_entry.first;
@@ -674,11 +855,23 @@ void BindingNormalization::normalizeBindingsWithBindingCompression(
     const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
     std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& bindings_vector,
     std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings,
+    std::vector<TypeId, ArenaAllocator<TypeId>>& types_shared_across_injectors,
     SaveCompressedBindingUndoInfo save_compressed_binding_undo_info,
     SaveFullyExpandedComponentsWithNoArgs save_fully_expanded_components_with_no_args,
     SaveFullyExpandedComponentsWithArgs save_fully_expanded_components_with_args,
     SaveComponentReplacementsWithNoArgs save_component_replacements_with_no_args,
-    SaveComponentReplacementsWithArgs save_component_replacements_with_args) {
+    SaveComponentReplacementsWithArgs save_component_replacements_with_args, std::size_t num_threads,
+    ComponentExpansionCache* component_expansion_cache, const LazyNormalizationParams* lazy_normalization,
+    std::size_t* num_removed_unreachable_bindings) {
+
+  // This must outlive the normalization below, since it owns the precomputed entries that were not used.
+  // A lazy normalization doesn't use it, since it would expand all the components.
+  std::unique_ptr<ParallelComponentExpander> component_expander;
+  if (num_threads > 1 && lazy_normalization == nullptr) {
+    component_expander.reset(
+        new ParallelComponentExpander(toplevel_entries.begin(), toplevel_entries.end(), num_threads,
+                                      component_expansion_cache));
+  }
 
   HashMapWithArenaAllocator<TypeId, ComponentStorageEntry> binding_data_map =
       createHashMapWithArenaAllocator<TypeId, ComponentStorageEntry>(20 /* capacity */, memory_pool);
@@ -694,6 +887,7 @@ void BindingNormalization::normalizeBindingsWithBindingCompression(
   normalizeBindings(
       std::move(toplevel_entries), fixed_size_allocator_data, memory_pool,
       memory_pool_for_fully_expanded_components_maps, memory_pool_for_component_replacements_maps, binding_data_map,
+      component_expander.get(), component_expansion_cache, lazy_normalization,
       [&compressed_bindings_map](ComponentStorageEntry entry) {
         BindingCompressionInfo& compression_info = compressed_bindings_map[entry.compressed_binding.c_type_id];
         compression_info.i_type_id = entry.type_id;
@@ -702,6 +896,9 @@ void BindingNormalization::normalizeBindingsWithBindingCompression(
       [&multibindings_vector](ComponentStorageEntry multibinding, ComponentStorageEntry multibinding_vector_creator) {
         multibindings_vector.emplace_back(multibinding, multibinding_vector_creator);
       },
+      [&types_shared_across_injectors](ComponentStorageEntry entry) {
+        types_shared_across_injectors.push_back(entry.type_id);
+      },
       [](TypeId) { return DummyIterator(); }, [](DummyIterator) { return false; }, [](DummyIterator) { return false; },
       [](DummyIterator) { return nullptr; }, [](DummyIterator) { return nullptr; },
       [](const LazyComponentWithNoArgs&) { return false; }, [](const LazyComponentWithArgs&) { return false; },
@@ -712,9 +909,17 @@ void BindingNormalization::normalizeBindingsWithBindingCompression(
       [](ComponentStorageEntry* p) { return *p; }, [](ComponentStorageEntry* p) { return *p; },
       save_component_replacements_with_no_args, save_component_replacements_with_args);
 
+  addDependenciesOfTypesSharedAcrossInjectors(binding_data_map, types_shared_across_injectors, memory_pool);
+
+  if (num_removed_unreachable_bindings != nullptr) {
+    *num_removed_unreachable_bindings =
+        removeUnreachableBindings(binding_data_map, compressed_bindings_map, fixed_size_allocator_data,
+                                  multibindings_vector, exposed_types, types_shared_across_injectors, memory_pool);
+  }
+
   bindings_vector = BindingNormalization::performBindingCompression(
       std::move(binding_data_map), std::move(compressed_bindings_map), memory_pool, multibindings_vector, exposed_types,
-      save_compressed_binding_undo_info);
+      types_shared_across_injectors, save_compressed_binding_undo_info);
 
   addMultibindings(multibindings, fixed_size_allocator_data, multibindings_vector);
 }
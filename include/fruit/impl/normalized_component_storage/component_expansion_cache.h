@@ -0,0 +1,94 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_COMPONENT_EXPANSION_CACHE_H
+#define FRUIT_COMPONENT_EXPANSION_CACHE_H
+
+#if !IN_FRUIT_CPP_FILE
+// We don't want to include it in public headers to save some compile time.
+#error "component_expansion_cache.h included in non-cpp file."
+#endif
+
+#include <fruit/impl/component_storage/component_storage_entry.h>
+#include <fruit/impl/data_structures/arena_allocator.h>
+#include <fruit/impl/normalized_component_storage/normalized_component_storage.h>
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace fruit {
+namespace impl {
+
+/**
+ * A process-wide cache of the entries that each lazy component adds when it's expanded, used when
+ * NormalizedComponentOptions::use_component_expansion_cache (or the corresponding InjectorOptions field) is true.
+ *
+ * The first normalization that expands a component calls the component's function and saves (a copy of) the resulting
+ * entries here; later normalizations that expand the same component (i.e. the same function, called with equal args)
+ * append a copy of the saved entries instead of calling the function again.
+ *
+ * Only the component's own entries are saved, not the ones of the components that it installs: those are saved (and
+ * looked up) separately when they're expanded, so a component's replacements are still applied as usual.
+ *
+ * Entries are never removed from the cache. This class is thread-safe.
+ */
+class ComponentExpansionCache {
+public:
+  using LazyComponentWithNoArgs = ComponentStorageEntry::LazyComponentWithNoArgs;
+  using LazyComponentWithArgs = ComponentStorageEntry::LazyComponentWithArgs;
+  using entry_vector_t = std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>;
+
+  /**
+   * Returns the cache shared by all normalizations in this process.
+   */
+  static ComponentExpansionCache& getInstance();
+
+  ComponentExpansionCache() = default;
+
+  ComponentExpansionCache(const ComponentExpansionCache&) = delete;
+  ComponentExpansionCache(ComponentExpansionCache&&) = delete;
+
+  ComponentExpansionCache& operator=(const ComponentExpansionCache&) = delete;
+  ComponentExpansionCache& operator=(ComponentExpansionCache&&) = delete;
+
+  ~ComponentExpansionCache();
+
+  /**
+   * Appends the entries of `component' to `entries', that then owns them. This has the same effect as
+   * component.addBindings(entries), but the component's function is only called if the entries weren't cached yet.
+   */
+  void addBindings(const LazyComponentWithNoArgs& component, entry_vector_t& entries);
+  void addBindings(const LazyComponentWithArgs& component, entry_vector_t& entries);
+
+private:
+  // The cached entries are owned by this object, and so are the keys of expansions_with_args.
+  std::unordered_map<LazyComponentWithNoArgs, std::vector<ComponentStorageEntry>,
+                     NormalizedComponentStorage::HashLazyComponentWithNoArgs>
+      expansions_with_no_args;
+  std::unordered_map<LazyComponentWithArgs, std::vector<ComponentStorageEntry>,
+                     NormalizedComponentStorage::HashLazyComponentWithArgs,
+                     NormalizedComponentStorage::LazyComponentWithArgsEqualTo>
+      expansions_with_args;
+
+  // Guards the fields above. The component functions are called without holding this.
+  std::mutex mutex;
+};
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_COMPONENT_EXPANSION_CACHE_H
@@ -50,6 +50,18 @@ NormalizedComponentStorage::createLazyComponentWithArgsReplacementMap(size_t cap
       NormalizedComponentStorage::LazyComponentWithArgsEqualTo());
 }
 
+inline std::uintptr_t NormalizedComponentStorage::getHashFunctionMultiplier() const {
+  return bindings.getHashMultiplier();
+}
+
+inline std::size_t NormalizedComponentStorage::getNumHashFunctionRetries() const {
+  return bindings.getNumHashFunctionRetries();
+}
+
+inline std::size_t NormalizedComponentStorage::getNumRemovedUnreachableBindings() const {
+  return num_removed_unreachable_bindings;
+}
+
 } // namespace impl
 } // namespace fruit
 
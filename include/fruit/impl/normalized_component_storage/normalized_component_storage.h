@@ -30,9 +30,14 @@
 #include <fruit/impl/normalized_component_storage/normalized_bindings.h>
 #include <fruit/impl/util/hash_helpers.h>
 #include <fruit/impl/util/type_info.h>
+#include <fruit/injector_options.h>
+#include <fruit/normalized_component_options.h>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace fruit {
 namespace impl {
@@ -90,6 +95,37 @@ public:
                                 NormalizedComponentStorage::HashLazyComponentWithArgs,
                                 NormalizedComponentStorage::LazyComponentWithArgsEqualTo>;
 
+  /**
+   * The result of BindingNormalization::normalizeBindingsAndAddTo() for a component added to this normalized component
+   * when creating an injector.
+   * Components that expand to the same entries (except for the objects bound with bindInstance()) have the same
+   * normalized bindings, so injectors created with them can reuse this instead of normalizing their component again.
+   */
+  struct InjectorPlan {
+    // The function of the (lazy) component that was added to this normalized component.
+    ComponentStorageEntry::LazyComponentWithNoArgs::erased_fun_t component_fun;
+
+    // The entries that component_fun expanded to (see BindingNormalization::expandComponentForInjectorPlan()), used to
+    // check whether a component can use this plan. The object_ptr of BINDING_FOR_CONSTRUCTED_OBJECT entries is
+    // ignored.
+    std::vector<ComponentStorageEntry> component_entries;
+    std::size_t component_entries_hash;
+
+    // The normalized bindings that have to be added to the normalized component's bindings.
+    std::vector<ComponentStorageEntry> bindings;
+
+    // Pairs (i, j) such that bindings[j] is the normalized binding for the BINDING_FOR_CONSTRUCTED_OBJECT entry
+    // component_entries[i], so the object for bindings[j] must be taken from the new component.
+    std::vector<std::pair<std::size_t, std::size_t>> constructed_object_bindings;
+
+    FixedSizeAllocator::FixedSizeAllocatorData fixed_size_allocator_data;
+
+    std::unordered_map<TypeId, NormalizedMultibindingSet> multibindings;
+  };
+
+  // The maximum number of InjectorPlan objects stored in a NormalizedComponentStorage.
+  static constexpr std::size_t max_num_injector_plans = 16;
+
   static LazyComponentWithNoArgsSet createLazyComponentWithNoArgsSet(size_t capacity, MemoryPool& memory_pool);
   static LazyComponentWithArgsSet createLazyComponentWithArgsSet(size_t capacity, MemoryPool& memory_pool);
 
@@ -109,6 +145,14 @@ private:
   // Contains data on the set of types that can be allocated using this component.
   FixedSizeAllocator::FixedSizeAllocatorData fixed_size_allocator_data;
 
+  // See InjectorOptions::remove_unreachable_bindings. Always 0 for a NormalizedComponent.
+  std::size_t num_removed_unreachable_bindings = 0;
+
+  // The slots of the nodes of `bindings' materialized by the injectors created from this normalized component (see
+  // SemistaticGraph::NodeSlots). Each injector assigns slots to the nodes that it materialized when it's destroyed, so
+  // the next ones can find them by direct indexing.
+  mutable SemistaticGraph<TypeId, NormalizedBinding>::NodeSlots node_slots;
+
   // The MemoryPool used to allocate bindingCompressionInfoMap, fully_expanded_components_with_no_args and
   // fully_expanded_components_with_args.
   MemoryPool normalized_component_memory_pool;
@@ -123,6 +167,37 @@ private:
   LazyComponentWithNoArgsReplacementMap component_with_no_args_replacements;
   LazyComponentWithArgsReplacementMap component_with_args_replacements;
 
+  // These are populated when creating injectors from this normalized component, which can happen concurrently in
+  // multiple threads. Plans are only appended (never modified or removed), so they're looked up without locking: the
+  // first num_injector_plans elements of injector_plans are set, and num_injector_plans is stored with a release
+  // operation after setting the new element. injector_plans_mutex serializes the threads that save a plan.
+  mutable std::mutex injector_plans_mutex;
+  mutable std::unique_ptr<InjectorPlan> injector_plans[max_num_injector_plans];
+  mutable std::atomic<std::size_t> num_injector_plans{0};
+
+  // The original binding of a type shared across injectors (see PartialComponent::shareAcrossInjectors()). In
+  // `bindings', the create function of these types is replaced with InjectorStorage::createSharedObject().
+  struct SharedObjectBinding {
+    TypeId type_id;
+    ComponentStorageEntry::BindingForObjectToConstruct::create_t create;
+  };
+
+  // Maps the index of a node in `bindings' (i.e. node_itr - bindings.begin(), that's the same in injectors created
+  // from this normalized component) to the original binding of the type, for each type shared across injectors
+  // (except the ones bound to an already-constructed object).
+  std::unordered_map<std::ptrdiff_t, SharedObjectBinding> shared_object_bindings;
+
+  // The injector that constructs (and owns) the objects shared across injectors. This is an injector created from this
+  // normalized component and an empty component; it's only created when the first shared object is needed.
+  mutable std::mutex shared_objects_injector_mutex;
+  mutable std::unique_ptr<InjectorStorage> shared_objects_injector;
+
+  // See NormalizedComponentOptions::memory_resource. Used for shared_objects_injector.
+  MemoryResource* shared_objects_memory_resource = nullptr;
+
+  // Returns shared_objects_injector, creating it if needed.
+  InjectorStorage& getSharedObjectsInjector() const;
+
   friend class InjectorStorage;
   friend class BindingNormalization;
 
@@ -146,18 +221,27 @@ public:
    */
   NormalizedComponentStorage(ComponentStorage&& component,
                              const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types, MemoryPool& memory_pool,
-                             WithUndoableCompression);
+                             const NormalizedComponentOptions& options, WithUndoableCompression);
 
   /**
    * The MemoryPool is only used during construction, the constructed object *can* outlive the memory pool.
+   * Only the options that affect the normalization (num_normalization_threads, use_component_expansion_cache,
+   * lazy_normalization, strict_lazy_normalization and remove_unreachable_bindings) are used here.
    */
   NormalizedComponentStorage(ComponentStorage&& component,
                              const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types, MemoryPool& memory_pool,
-                             WithPermanentCompression);
+                             const InjectorOptions& options, WithPermanentCompression);
 
   // We don't use the default destructor because that will require the inclusion of
   // the Boost's hashmap header. We define this in the cpp file instead.
   ~NormalizedComponentStorage() noexcept;
+
+  // See NormalizedComponent::getHashFunctionMultiplier() and NormalizedComponent::getNumHashFunctionRetries().
+  std::uintptr_t getHashFunctionMultiplier() const;
+  std::size_t getNumHashFunctionRetries() const;
+
+  // See Injector::getNumRemovedUnreachableBindings().
+  std::size_t getNumRemovedUnreachableBindings() const;
 };
 
 } // namespace impl
@@ -22,6 +22,8 @@
 #include <fruit/impl/data_structures/memory_pool.h>
 #include <fruit/impl/fruit_internal_forward_decls.h>
 
+#include <cstdint>
+
 namespace fruit {
 namespace impl {
 
@@ -43,6 +45,9 @@ private:
   template <typename... P>
   friend class fruit::Injector;
 
+  template <typename... P>
+  friend class fruit::InjectorPool;
+
 public:
   // These are just used as tags to select the desired constructor.
   struct WithUndoableCompression {};
@@ -55,7 +60,8 @@ public:
    */
   NormalizedComponentStorageHolder(ComponentStorage&& component,
                                    const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
-                                   MemoryPool& memory_pool, WithUndoableCompression);
+                                   MemoryPool& memory_pool, const NormalizedComponentOptions& options,
+                                   WithUndoableCompression);
 
   NormalizedComponentStorageHolder(NormalizedComponentStorageHolder&& other) noexcept
       : storage(other.storage) {
@@ -67,6 +73,9 @@ public:
   NormalizedComponentStorageHolder& operator=(const NormalizedComponentStorageHolder&) = delete;
 
   ~NormalizedComponentStorageHolder() noexcept;
+
+  std::uintptr_t getHashFunctionMultiplier() const;
+  std::size_t getNumHashFunctionRetries() const;
 };
 
 } // namespace impl
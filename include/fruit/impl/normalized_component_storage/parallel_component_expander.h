@@ -0,0 +1,133 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_PARALLEL_COMPONENT_EXPANDER_H
+#define FRUIT_PARALLEL_COMPONENT_EXPANDER_H
+
+#if !IN_FRUIT_CPP_FILE
+// We don't want to include it in public headers to save some compile time.
+#error "parallel_component_expander.h included in non-cpp file."
+#endif
+
+#include <fruit/impl/component_storage/component_storage_entry.h>
+#include <fruit/impl/data_structures/arena_allocator.h>
+#include <fruit/impl/data_structures/memory_pool.h>
+#include <fruit/impl/normalized_component_storage/component_expansion_cache.h>
+#include <fruit/impl/normalized_component_storage/normalized_component_storage.h>
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace fruit {
+namespace impl {
+
+/**
+ * Calls the functions of the lazy components reachable from some toplevel entries on multiple threads, before binding
+ * normalization.
+ *
+ * This only computes the entries that each lazy component would add when expanded, the normalization still processes
+ * them in the usual (deterministic) order in a single thread, so it performs the same duplicate/conflict checks and
+ * reports the same errors. When the normalization expands a lazy component, it takes the precomputed entries from
+ * here (see takeBindings()) instead of calling the component's function.
+ *
+ * Component replacements are only known during the normalization, so this might also call the functions of
+ * components that are then replaced, and whose entries are never used.
+ */
+class ParallelComponentExpander {
+public:
+  using LazyComponentWithNoArgs = ComponentStorageEntry::LazyComponentWithNoArgs;
+  using LazyComponentWithArgs = ComponentStorageEntry::LazyComponentWithArgs;
+  using entry_vector_t = std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>;
+
+  /**
+   * Expands the lazy components in [first, last) and (recursively) the ones that they install, using up to
+   * `num_threads' threads (including the current one). The entries in [first, last) are not modified.
+   * If component_expansion_cache is not nullptr, the components are expanded through it.
+   * If a component function throws, the threads stop expanding other components, and the first exception is rethrown
+   * here once all of them are done.
+   */
+  ParallelComponentExpander(const ComponentStorageEntry* first, const ComponentStorageEntry* last,
+                            std::size_t num_threads, ComponentExpansionCache* component_expansion_cache);
+
+  ParallelComponentExpander(const ParallelComponentExpander&) = delete;
+  ParallelComponentExpander(ParallelComponentExpander&&) = delete;
+
+  ParallelComponentExpander& operator=(const ParallelComponentExpander&) = delete;
+  ParallelComponentExpander& operator=(ParallelComponentExpander&&) = delete;
+
+  ~ParallelComponentExpander();
+
+  /**
+   * If the entries of `component' were computed by this object (and not taken yet), appends them to `entries', that
+   * then owns them, and returns true. Otherwise returns false and doesn't modify `entries'.
+   */
+  bool takeBindings(const LazyComponentWithNoArgs& component, entry_vector_t& entries);
+  bool takeBindings(const LazyComponentWithArgs& component, entry_vector_t& entries);
+
+private:
+  // One for each thread, so that the threads can allocate the expanded entries without synchronization.
+  std::vector<MemoryPool> memory_pools;
+
+  ComponentExpansionCache* component_expansion_cache;
+
+  // These map each lazy component found so far to its entries. The value is nullptr if the component was not
+  // expanded yet, if it was replaced by another component or if its entries were already taken.
+  // The keys of expansions_with_args are owned by this object.
+  std::unordered_map<LazyComponentWithNoArgs, entry_vector_t*, NormalizedComponentStorage::HashLazyComponentWithNoArgs>
+      expansions_with_no_args;
+  std::unordered_map<LazyComponentWithArgs, entry_vector_t*, NormalizedComponentStorage::HashLazyComponentWithArgs,
+                     NormalizedComponentStorage::LazyComponentWithArgsEqualTo>
+      expansions_with_args;
+
+  // The lazy components that still need to be expanded. For components with args, the keys of expansions_with_args
+  // own the objects.
+  std::vector<ComponentStorageEntry> components_to_expand;
+  std::size_t num_components_being_expanded = 0;
+
+  // Set when a component function throws: then the threads don't expand any other component.
+  bool stopped = false;
+#if FRUIT_HAS_EXCEPTIONS
+  // The first exception thrown by a component function.
+  std::exception_ptr exception;
+#endif
+
+  // Guards all the fields above (except memory_pools) while the threads are running.
+  std::mutex mutex;
+  std::condition_variable components_to_expand_changed;
+
+  // Adds the lazy components in [first, last) that weren't seen before to components_to_expand.
+  // The mutex must be locked.
+  void addComponentsToExpand(const ComponentStorageEntry* first, const ComponentStorageEntry* last);
+
+  // Expands components from components_to_expand until there are none left (or until `stopped' is set), allocating
+  // the entries in memory_pool.
+  void expandComponents(MemoryPool& memory_pool);
+
+  // Expands a single component from components_to_expand, allocating the entries in memory_pool. Returns the entries.
+  // The mutex must *not* be locked.
+  entry_vector_t* expandComponent(const ComponentStorageEntry& component_entry, MemoryPool& memory_pool);
+
+  // Destroys the entries owned by this object.
+  void destroyEntries();
+};
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_PARALLEL_COMPONENT_EXPANDER_H
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_ATOMIC_HELPERS_H
+#define FRUIT_ATOMIC_HELPERS_H
+
+#include <fruit/impl/fruit-config.h>
+
+#include <cstdint>
+
+#if !FRUIT_HAS_GCC_ATOMIC_BUILTINS
+#include <atomic>
+#endif
+
+namespace fruit {
+namespace impl {
+
+// Atomic accesses to a plain std::uintptr_t (or std::uint32_t) field.
+// These are used for fields of trivially-copyable structs (that therefore can't contain a std::atomic<>) that are
+// published by one thread and then read by other threads without holding a lock.
+
+inline std::uintptr_t atomicLoadAcquire(const std::uintptr_t* p) {
+#if FRUIT_HAS_GCC_ATOMIC_BUILTINS
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#else
+  static_assert(sizeof(std::atomic<std::uintptr_t>) == sizeof(std::uintptr_t), "");
+  return reinterpret_cast<const std::atomic<std::uintptr_t>*>(p)->load(std::memory_order_acquire);
+#endif
+}
+
+inline std::uintptr_t atomicLoadRelaxed(const std::uintptr_t* p) {
+#if FRUIT_HAS_GCC_ATOMIC_BUILTINS
+  return __atomic_load_n(p, __ATOMIC_RELAXED);
+#else
+  static_assert(sizeof(std::atomic<std::uintptr_t>) == sizeof(std::uintptr_t), "");
+  return reinterpret_cast<const std::atomic<std::uintptr_t>*>(p)->load(std::memory_order_relaxed);
+#endif
+}
+
+inline std::uint32_t atomicLoadRelaxed(const std::uint32_t* p) {
+#if FRUIT_HAS_GCC_ATOMIC_BUILTINS
+  return __atomic_load_n(p, __ATOMIC_RELAXED);
+#else
+  static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "");
+  return reinterpret_cast<const std::atomic<std::uint32_t>*>(p)->load(std::memory_order_relaxed);
+#endif
+}
+
+inline void atomicStoreRelease(std::uintptr_t* p, std::uintptr_t value) {
+#if FRUIT_HAS_GCC_ATOMIC_BUILTINS
+  __atomic_store_n(p, value, __ATOMIC_RELEASE);
+#else
+  static_assert(sizeof(std::atomic<std::uintptr_t>) == sizeof(std::uintptr_t), "");
+  reinterpret_cast<std::atomic<std::uintptr_t>*>(p)->store(value, std::memory_order_release);
+#endif
+}
+
+inline void atomicStoreRelease(std::uint32_t* p, std::uint32_t value) {
+#if FRUIT_HAS_GCC_ATOMIC_BUILTINS
+  __atomic_store_n(p, value, __ATOMIC_RELEASE);
+#else
+  static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "");
+  reinterpret_cast<std::atomic<std::uint32_t>*>(p)->store(value, std::memory_order_release);
+#endif
+}
+
+// Atomically sets *p to (*p | bits). This is a release operation.
+inline void atomicFetchOrRelease(std::uintptr_t* p, std::uintptr_t bits) {
+#if FRUIT_HAS_GCC_ATOMIC_BUILTINS
+  __atomic_fetch_or(p, bits, __ATOMIC_RELEASE);
+#else
+  static_assert(sizeof(std::atomic<std::uintptr_t>) == sizeof(std::uintptr_t), "");
+  reinterpret_cast<std::atomic<std::uintptr_t>*>(p)->fetch_or(bits, std::memory_order_release);
+#endif
+}
+
+// If *p==expected, atomically sets *p to `desired' and returns true. Otherwise returns false.
+// This is an acquire-release operation if it succeeds, and an acquire operation otherwise.
+inline bool atomicCompareExchange(std::uintptr_t* p, std::uintptr_t expected, std::uintptr_t desired) {
+#if FRUIT_HAS_GCC_ATOMIC_BUILTINS
+  return __atomic_compare_exchange_n(p, &expected, desired, false /* weak */, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#else
+  static_assert(sizeof(std::atomic<std::uintptr_t>) == sizeof(std::uintptr_t), "");
+  return reinterpret_cast<std::atomic<std::uintptr_t>*>(p)->compare_exchange_strong(
+      expected, desired, std::memory_order_acq_rel, std::memory_order_acquire);
+#endif
+}
+
+} // namespace impl
+} // namespace fruit
+
+#endif // FRUIT_ATOMIC_HELPERS_H
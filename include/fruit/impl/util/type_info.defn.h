@@ -24,6 +24,7 @@
 #include <fruit/impl/data_structures/memory_pool.h>
 #include <fruit/impl/fruit-config.h>
 #include <fruit/impl/fruit_assert.h>
+#include <fruit/impl/util/atomic_helpers.h>
 
 #include <type_traits>
 
@@ -59,10 +60,10 @@ struct GetConcreteTypeInfo<T, true> {
 
 // This should only be used if RTTI is disabled. Use the other constructor if possible.
 inline constexpr TypeInfo::TypeInfo(ConcreteTypeInfo concrete_type_info)
-    : info(nullptr), concrete_type_info(concrete_type_info) {}
+    : info(nullptr), concrete_type_info(concrete_type_info), dense_index(0) {}
 
 inline constexpr TypeInfo::TypeInfo(const std::type_info& info, ConcreteTypeInfo concrete_type_info)
-    : info(&info), concrete_type_info(concrete_type_info) {}
+    : info(&info), concrete_type_info(concrete_type_info), dense_index(0) {}
 
 inline std::string TypeInfo::name() const {
   if (info != nullptr) // LCOV_EXCL_BR_LINE
@@ -92,6 +93,12 @@ inline bool TypeInfo::isTriviallyDestructible() const {
   return concrete_type_info.is_trivially_destructible;
 }
 
+inline std::size_t TypeInfo::denseIndex() const {
+  // This doesn't need to synchronize with the thread that assigned the index: a thread that uses an array indexed by
+  // dense indexes is already synchronized with the one that filled it (and therefore assigned the indexes).
+  return atomicLoadRelaxed(&dense_index);
+}
+
 inline TypeId::operator std::string() const {
   return type_info->name();
 }
@@ -19,6 +19,9 @@
 
 #include <fruit/impl/meta/vector.h>
 #include <fruit/impl/util/demangle_type_name.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <typeinfo>
 
 #include <vector>
@@ -54,11 +57,31 @@ struct alignas(1) alignas(void*) TypeInfo {
 
   bool isTriviallyDestructible() const;
 
+  // Returns the dense index of the type (see getOrAssignDenseIndex()), or 0 if it doesn't have one yet.
+  std::size_t denseIndex() const;
+
+  // Returns the dense index of the type, assigning one if it doesn't have one yet.
+  // Dense indexes are assigned in increasing order (starting from 1) to the types of all the injection graphs
+  // constructed in this process, so they can be used to index small arrays instead of hashing the TypeId.
+  // The counter is shared by the whole process (not per NormalizedComponent or Injector), so the indexes of the types
+  // of a graph are only contiguous if no other graph assigned indexes to other types in the meantime. A graph whose
+  // types have very sparse indexes (see SemistaticGraph::maxNumDenseNodeIds()) doesn't use them, and looks up its types
+  // by hashing the TypeId instead.
+  std::size_t getOrAssignDenseIndex() const;
+
 private:
   // The std::type_info struct associated with the type, or nullptr if RTTI is disabled.
   // This is only used for the type name.
   const std::type_info* info;
   ConcreteTypeInfo concrete_type_info;
+
+  // The dense index of the type, or 0 if not assigned yet. This is assigned at runtime even though the TypeInfo object
+  // is constexpr, hence the `mutable'. It's a plain integer (accessed with the functions in atomic_helpers.h) so that
+  // TypeInfo can still be copied.
+  mutable std::uintptr_t dense_index;
+
+  // The last dense index assigned to a type.
+  static std::atomic<std::size_t> last_dense_index;
 };
 
 struct TypeId {
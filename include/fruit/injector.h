@@ -21,7 +21,9 @@
 #include <fruit/impl/injection_errors.h>
 
 #include <fruit/component.h>
+#include <fruit/injector_options.h>
 #include <fruit/normalized_component.h>
+#include <fruit/normalized_component_future.h>
 #include <fruit/provider.h>
 #include <fruit/impl/meta_operation_wrappers.h>
 
@@ -81,6 +83,19 @@ public:
   template <typename... FormalArgs, typename... Args>
   explicit Injector(Component<P...> (*)(FormalArgs...), Args&&... args);
 
+  /**
+   * Similar to the previous constructor, but also takes some InjectorOptions that tweak the runtime behavior of the
+   * injector (e.g. how the construction of objects is synchronized across threads).
+   *
+   * Example usage:
+   *
+   * fruit::InjectorOptions options;
+   * options.concurrent_construction = true;
+   * Injector<Foo, Bar> injector(options, getFooBarComponent);
+   */
+  template <typename... FormalArgs, typename... Args>
+  Injector(const InjectorOptions& options, Component<P...> (*)(FormalArgs...), Args&&... args);
+
   /**
    * This creates an injector from a normalized component and a component function.
    * See the documentation of NormalizedComponent for more details.
@@ -125,6 +140,67 @@ public:
   Injector(NormalizedComponent<NormalizedComponentParams...>&& normalized_component,
            Component<ComponentParams...> (*)(FormalArgs...), Args&&... args) = delete;
 
+  /**
+   * Similar to the previous constructor, but also takes some InjectorOptions that tweak the runtime behavior of the
+   * injector. See the documentation of InjectorOptions for more details.
+   */
+  template <typename... NormalizedComponentParams, typename... ComponentParams, typename... FormalArgs,
+            typename... Args>
+  Injector(const InjectorOptions& options,
+           const NormalizedComponent<NormalizedComponentParams...>& normalized_component,
+           Component<ComponentParams...> (*)(FormalArgs...), Args&&... args);
+
+  /**
+   * Deleted constructor, to ensure that constructing an Injector from a temporary NormalizedComponent doesn't compile.
+   */
+  template <typename... NormalizedComponentParams, typename... ComponentParams, typename... FormalArgs,
+            typename... Args>
+  Injector(const InjectorOptions& options, NormalizedComponent<NormalizedComponentParams...>&& normalized_component,
+           Component<ComponentParams...> (*)(FormalArgs...), Args&&... args) = delete;
+
+  /**
+   * Similar to the constructor that takes a NormalizedComponent, but takes a NormalizedComponentFuture (returned by
+   * fruit::normalizeAsync()). This waits for the construction of the NormalizedComponent to complete (if it didn't
+   * already), so the normalization can overlap with any work done between the normalizeAsync() call and the
+   * construction of the first injector. If a component function threw during the normalization, this rethrows that
+   * exception.
+   *
+   * The NormalizedComponentFuture must remain valid during the lifetime of any Injector object constructed with it.
+   */
+  template <typename... NormalizedComponentParams, typename... ComponentParams, typename... FormalArgs,
+            typename... Args>
+  Injector(const NormalizedComponentFuture<NormalizedComponentParams...>& normalized_component_future,
+           Component<ComponentParams...> (*)(FormalArgs...), Args&&... args);
+
+  /**
+   * Deleted constructor, to ensure that constructing an Injector from a temporary NormalizedComponentFuture doesn't
+   * compile.
+   */
+  template <typename... NormalizedComponentParams, typename... ComponentParams, typename... FormalArgs,
+            typename... Args>
+  Injector(NormalizedComponentFuture<NormalizedComponentParams...>&& normalized_component_future,
+           Component<ComponentParams...> (*)(FormalArgs...), Args&&... args) = delete;
+
+  /**
+   * Similar to the previous constructor, but also takes some InjectorOptions that tweak the runtime behavior of the
+   * injector. See the documentation of InjectorOptions for more details.
+   */
+  template <typename... NormalizedComponentParams, typename... ComponentParams, typename... FormalArgs,
+            typename... Args>
+  Injector(const InjectorOptions& options,
+           const NormalizedComponentFuture<NormalizedComponentParams...>& normalized_component_future,
+           Component<ComponentParams...> (*)(FormalArgs...), Args&&... args);
+
+  /**
+   * Deleted constructor, to ensure that constructing an Injector from a temporary NormalizedComponentFuture doesn't
+   * compile.
+   */
+  template <typename... NormalizedComponentParams, typename... ComponentParams, typename... FormalArgs,
+            typename... Args>
+  Injector(const InjectorOptions& options,
+           NormalizedComponentFuture<NormalizedComponentParams...>&& normalized_component_future,
+           Component<ComponentParams...> (*)(FormalArgs...), Args&&... args) = delete;
+
   /**
    * Returns an instance of the specified type. For any class C in the Injector's template parameters, the following
    * variations are allowed:
@@ -219,6 +295,32 @@ public:
    */
   FRUIT_DEPRECATED_DECLARATION(void eagerlyInjectAll());
 
+  /**
+   * Eagerly injects all reachable bindings and multibindings of this injector, using up to `num_threads' threads
+   * (including the current one). This is useful when some constructors are slow (e.g. they perform I/O), so that the
+   * total time is closer to the longest chain of dependent constructors than to the sum of all the constructors.
+   *
+   * Each object is constructed after all its dependencies. Objects that don't depend on each other can be constructed
+   * concurrently by different threads, so their constructors must not have any unsynchronized side effects on shared
+   * data. Multibindings are constructed afterwards, in the current thread.
+   *
+   * Unlike eagerlyInjectAll(), this also constructs the objects of types that are only injected lazily (using a
+   * Provider) by reachable bindings.
+   *
+   * If a constructor throws (in any of the threads), no other construction is started: this waits for the ones already
+   * running to finish and then rethrows the first exception in the current thread. Multibindings are not constructed
+   * in that case. The objects constructed before the exception stay in the injector, and the others are constructed
+   * as usual when they're first needed (so e.g. eagerlyInjectAllParallel() can be called again).
+   */
+  void eagerlyInjectAllParallel(std::size_t num_threads);
+
+  /**
+   * Returns the number of bindings that were removed when constructing this injector because they're unreachable (see
+   * InjectorOptions::remove_unreachable_bindings). This is 0 if that option was false, or if this injector was
+   * constructed from a NormalizedComponent.
+   */
+  std::size_t getNumRemovedUnreachableBindings() const;
+
 private:
   using Check1 = typename fruit::impl::meta::CheckIfError<fruit::impl::meta::Eval<
       fruit::impl::meta::CheckNoRequiredTypesInInjectorArguments(fruit::impl::meta::Type<P>...)>>::type;
@@ -239,8 +341,14 @@ private:
   // Force instantiation of Check3.
   static_assert(true || sizeof(Check3), "");
 
+  // Used by InjectorPool.
+  explicit Injector(std::unique_ptr<fruit::impl::InjectorStorage> storage);
+
   friend struct fruit::impl::InjectorAccessorForTests;
 
+  template <typename... OtherP>
+  friend class InjectorPool;
+
   std::unique_ptr<fruit::impl::InjectorStorage> storage;
 };
 
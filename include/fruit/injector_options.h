@@ -0,0 +1,151 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_INJECTOR_OPTIONS_H
+#define FRUIT_INJECTOR_OPTIONS_H
+
+#include <fruit/fruit_forward_decls.h>
+
+#include <cstddef>
+
+namespace fruit {
+
+/**
+ * Options that tweak the runtime behavior of an Injector. These don't affect which types can be injected, only how
+ * they are constructed.
+ *
+ * The default-constructed options give the same behavior as the Injector constructors that don't take any options.
+ *
+ * Example usage:
+ *
+ * fruit::InjectorOptions options;
+ * options.concurrent_construction = true;
+ * Injector<Foo, Bar> injector(options, getFooBarComponent);
+ */
+struct InjectorOptions {
+  /**
+   * By default, the construction of injected objects is serialized using a single mutex for the whole injector, so
+   * two threads that call get() on an injector at the same time (for objects that are not constructed yet) block each
+   * other even if the two objects have no dependencies in common.
+   *
+   * If this is true, objects are instead constructed using a separate synchronization state for each binding, so
+   * independent objects can be constructed concurrently by different threads. A thread that needs an object that is
+   * being constructed by another thread waits for that construction to complete.
+   *
+   * This has a small overhead for each constructed object, so it's only useful for injectors that are accessed
+   * concurrently by multiple threads before all the needed objects are constructed. It doesn't affect the performance
+   * of get() calls for objects that were already constructed.
+   */
+  bool concurrent_construction = false;
+
+  /**
+   * If this is not nullptr, the memory for the objects constructed by the injector (and for the injector's own data
+   * structures, if it's created from a NormalizedComponent) is allocated from this resource instead of the heap. The
+   * memory is deallocated when the injector is destroyed, after destroying the objects.
+   *
+   * Note that this doesn't affect objects that are allocated by user code (e.g. by a provider that returns a pointer)
+   * nor the vectors returned by getMultibindings().
+   *
+   * The resource must outlive the injector (and, for InjectorPool, the pool).
+   */
+  MemoryResource* memory_resource = nullptr;
+
+  /**
+   * If this is true, the objects constructed by the injector are not destroyed when the injector is destroyed: their
+   * destructors are not run, and the objects returned as pointers by providers (that the injector would otherwise
+   * delete) are leaked. The injector's own memory is still released, so destroying the injector takes the same time
+   * regardless of the number of objects.
+   *
+   * This is meant for injectors that live until the end of the process (e.g. a root injector), whose objects don't
+   * need to be destroyed before exiting, to make the shutdown faster. Don't use this if any of the objects has a
+   * destructor with side effects that must happen (e.g. flushing a file).
+   *
+   * This is ignored by InjectorPool: the injectors that it returns are short-lived, so their objects are always
+   * destroyed (otherwise they'd be leaked every time an injector goes back to the pool).
+   */
+  bool skip_object_destruction = false;
+
+  /**
+   * If this is greater than 1, the functions of the installed components are called using up to this many threads
+   * (including the current one) before the bindings are normalized, as described in
+   * NormalizedComponentOptions::num_normalization_threads (that has the same requirements on the component
+   * functions).
+   *
+   * This is only used by the Injector constructors that take a component function and no NormalizedComponent. The
+   * components passed together with a NormalizedComponent are always expanded in the current thread.
+   */
+  std::size_t num_normalization_threads = 1;
+
+  /**
+   * If this is true, the bindings added by the installed component functions are saved in (or taken from) the
+   * process-wide cache described in NormalizedComponentOptions::use_component_expansion_cache (that has the same
+   * requirements on the component functions).
+   *
+   * As for num_normalization_threads, this is only used by the Injector constructors that take a component function
+   * and no NormalizedComponent.
+   */
+  bool use_component_expansion_cache = false;
+
+  /**
+   * By default, all the installed components are expanded (i.e. their functions are called) and all their bindings
+   * are normalized, even if the injector only needs a few of them.
+   *
+   * If this is true, only the components needed to inject the types in the Injector's signature are expanded: a
+   * component is expanded only if some type in its signature (e.g. Foo for a fruit::Component<fruit::Required<Bar>,
+   * Foo>) is a (direct or indirect) dependency of the injector's types or of the multibindings found so far, and has no
+   * binding yet. This can make the construction of the injector much faster when the installed components provide
+   * many more types than the ones that are used.
+   *
+   * The bindings (and replacements) in the components that are not expanded are ignored. In particular:
+   * - errors in those components (e.g. multiple bindings for the same type or installation loops) are not reported
+   * - their multibindings are not available in getMultibindings()
+   * - their bindings are not injected by eagerlyInjectAll()
+   * So this is only appropriate when the injector doesn't use multibindings contributed by components whose types are
+   * not needed. See strict_lazy_normalization for a way to check that the bindings have no errors.
+   *
+   * This is only used by the Injector constructors that take a component function and no NormalizedComponent. If this
+   * is true, num_normalization_threads is ignored.
+   */
+  bool lazy_normalization = false;
+
+  /**
+   * This is only used if lazy_normalization is true. If this is also true, the components that are not needed are
+   * still expanded after the needed ones, so that their bindings are checked (and their multibindings are available)
+   * exactly as if lazy_normalization was false.
+   *
+   * This makes the construction as slow as with lazy_normalization=false; it's meant for tests and debug builds of
+   * programs that use lazy_normalization in production, to check that it doesn't hide any error.
+   */
+  bool strict_lazy_normalization = false;
+
+  /**
+   * If this is true, after the normalization the bindings that are not reachable from the types in the Injector's
+   * signature or from the multibindings (i.e. the bindings that eagerlyInjectAll() would not inject) are removed, so
+   * that no memory is reserved for their objects and the injector's binding graph is smaller. This is useful when the
+   * installed components bind many types that this injector doesn't use.
+   *
+   * The bindings are checked for errors (e.g. multiple bindings for the same type) before being removed.
+   * The number of removed bindings is returned by Injector::getNumRemovedUnreachableBindings().
+   *
+   * As for num_normalization_threads, this is only used by the Injector constructors that take a component function
+   * and no NormalizedComponent.
+   */
+  bool remove_unreachable_bindings = false;
+};
+
+} // namespace fruit
+
+#endif // FRUIT_INJECTOR_OPTIONS_H
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_INJECTOR_POOL_H
+#define FRUIT_INJECTOR_POOL_H
+
+// This include is not required here, but having it here shortens the include trace in error messages.
+#include <fruit/impl/injection_errors.h>
+
+#include <fruit/component.h>
+#include <fruit/injector.h>
+#include <fruit/injector_options.h>
+#include <fruit/normalized_component.h>
+#include <fruit/impl/injector/injector_pool_storage.h>
+
+#include <cstddef>
+
+namespace fruit {
+
+/**
+ * An InjectorPool creates injectors from a NormalizedComponent (like the Injector constructors that take a
+ * NormalizedComponent), but when an injector is no longer used its memory is kept by the pool and reused for the
+ * next injectors, instead of being deallocated.
+ *
+ * This is useful when many short-lived injectors are created from the same NormalizedComponent (e.g. one for each
+ * request in a server), to avoid allocating and deallocating memory for each of them.
+ *
+ * Example usage:
+ *
+ * // In the global scope.
+ * Component<Request> getRequestComponent(Request* request) {
+ *   return fruit::createComponent()
+ *       .bindInstance(*request);
+ * }
+ *
+ * // At startup (e.g. inside main()).
+ * NormalizedComponent<Required<Request>, Bar, Bar2> normalizedComponent = ...;
+ * InjectorPool<Foo, Bar> injectorPool;
+ *
+ * ...
+ * for (...) {
+ *   // For each request.
+ *   Request request = ...;
+ *
+ *   InjectorPool<Foo, Bar>::PooledInjector injector = injectorPool.get(normalizedComponent, getRequestComponent,
+ *                                                                      &request);
+ *   Foo* foo = injector->get<Foo*>();
+ *   ...
+ *   // Here `injector' is destroyed, so the objects that it constructed are destroyed and its memory goes back to
+ *   // the pool.
+ * }
+ *
+ * The injectors returned by get() can be used concurrently, and get() itself can be called concurrently by multiple
+ * threads. The pool must outlive all the injectors returned by get(), but it does *not* need to be destroyed before the
+ * NormalizedComponents used with it.
+ *
+ * All the injectors returned by a pool use the InjectorOptions passed to the pool's constructor (if any), except for
+ * InjectorOptions::skip_object_destruction, that is ignored: the objects constructed by a pooled injector are always
+ * destroyed when it goes back to the pool.
+ *
+ * The pool keeps the memory of at most `max_idle_injectors' unused injectors (see the constructors), so after a burst
+ * of concurrent injectors the memory of the ones beyond that limit is deallocated when they're destroyed.
+ */
+template <typename... P>
+class InjectorPool {
+public:
+  /**
+   * An injector obtained from an InjectorPool. This is used as a pointer to an Injector<P...>, e.g.:
+   *
+   * Foo* foo = pooledInjector->get<Foo*>();
+   *
+   * When this is destroyed, the objects constructed by the injector are destroyed (as when an Injector is destroyed,
+   * even if the pool's options have skip_object_destruction set) and its memory goes back to the pool.
+   */
+  class PooledInjector {
+  public:
+    PooledInjector(PooledInjector&&) noexcept = default;
+    PooledInjector(const PooledInjector&) = delete;
+
+    PooledInjector& operator=(PooledInjector&&) = delete;
+    PooledInjector& operator=(const PooledInjector&) = delete;
+
+    ~PooledInjector();
+
+    Injector<P...>& operator*();
+    Injector<P...>* operator->();
+
+  private:
+    PooledInjector(fruit::impl::InjectorPoolStorage& pool_storage,
+                   std::unique_ptr<fruit::impl::InjectorStorage> injector_storage);
+
+    fruit::impl::InjectorPoolStorage* pool_storage;
+    Injector<P...> injector;
+
+    friend class InjectorPool;
+  };
+
+  /**
+   * The maximum number of unused injectors whose memory is kept by the pool, when not specified in the constructor.
+   */
+  static constexpr std::size_t default_max_idle_injectors = 64;
+
+  InjectorPool();
+
+  /**
+   * Similar to the previous constructor, but also takes some InjectorOptions that tweak the runtime behavior of the
+   * injectors returned by get(). See the documentation of InjectorOptions for more details.
+   * options.skip_object_destruction is ignored: pooled injectors always destroy their objects.
+   */
+  explicit InjectorPool(const InjectorOptions& options);
+
+  /**
+   * Similar to the previous constructor, but the pool keeps the memory of at most `max_idle_injectors' unused
+   * injectors instead of default_max_idle_injectors. When an injector is destroyed and the pool already has that many,
+   * its memory is deallocated instead. This should be at least the number of injectors typically used concurrently
+   * (e.g. the number of threads serving requests); with 0 the pool never reuses memory.
+   */
+  InjectorPool(const InjectorOptions& options, std::size_t max_idle_injectors);
+
+  InjectorPool(InjectorPool&&) = delete;
+  InjectorPool(const InjectorPool&) = delete;
+
+  InjectorPool& operator=(InjectorPool&&) = delete;
+  InjectorPool& operator=(const InjectorPool&) = delete;
+
+  /**
+   * Returns an injector equivalent to:
+   *
+   * Injector<P...> injector(normalized_component, getComponent, args...);
+   *
+   * reusing the memory of an injector previously returned by this pool (if any of those has already been destroyed).
+   * The same constraints on the arguments of that Injector constructor apply here.
+   */
+  template <typename... NormalizedComponentParams, typename... ComponentParams, typename... FormalArgs,
+            typename... Args>
+  PooledInjector get(const NormalizedComponent<NormalizedComponentParams...>& normalized_component,
+                     Component<ComponentParams...> (*getComponent)(FormalArgs...), Args&&... args);
+
+  /**
+   * Deleted overload, to ensure that getting an injector for a temporary NormalizedComponent doesn't compile.
+   */
+  template <typename... NormalizedComponentParams, typename... ComponentParams, typename... FormalArgs,
+            typename... Args>
+  PooledInjector get(NormalizedComponent<NormalizedComponentParams...>&& normalized_component,
+                     Component<ComponentParams...> (*getComponent)(FormalArgs...), Args&&... args) = delete;
+
+private:
+  fruit::impl::InjectorPoolStorage storage;
+};
+
+} // namespace fruit
+
+#include <fruit/impl/injector_pool.defn.h>
+
+#endif // FRUIT_INJECTOR_POOL_H
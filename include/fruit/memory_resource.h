@@ -0,0 +1,67 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_MEMORY_RESOURCE_H
+#define FRUIT_MEMORY_RESOURCE_H
+
+#include <cstddef>
+
+namespace fruit {
+
+/**
+ * A source of memory that an injector can use for the objects that it constructs (see
+ * InjectorOptions::memory_resource), instead of allocating it from the heap. E.g. this allows to put the objects of a
+ * short-lived injector in a monotonic buffer or in an arena, and to release all of them at once.
+ *
+ * This has the same interface as std::pmr::memory_resource (that is not available in C++11). A std::pmr resource can
+ * be used by wrapping it:
+ *
+ * class PmrMemoryResource : public fruit::MemoryResource {
+ * public:
+ *   explicit PmrMemoryResource(std::pmr::memory_resource* resource) : resource(resource) {}
+ *
+ *   void* allocate(std::size_t bytes, std::size_t alignment) override {
+ *     return resource->allocate(bytes, alignment);
+ *   }
+ *
+ *   void deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+ *     resource->deallocate(p, bytes, alignment);
+ *   }
+ *
+ * private:
+ *   std::pmr::memory_resource* resource;
+ * };
+ */
+class MemoryResource {
+public:
+  virtual ~MemoryResource() = default;
+
+  /**
+   * Returns a chunk of (at least) `bytes' bytes of memory, aligned to `alignment' (that is a power of 2).
+   * If the memory can't be allocated, this can either throw an exception or return nullptr; in the latter case Fruit
+   * throws std::bad_alloc (or aborts the program, if exceptions are disabled).
+   */
+  virtual void* allocate(std::size_t bytes, std::size_t alignment) = 0;
+
+  /**
+   * Deallocates a chunk of memory returned by allocate(bytes, alignment) on this object.
+   */
+  virtual void deallocate(void* p, std::size_t bytes, std::size_t alignment) = 0;
+};
+
+} // namespace fruit
+
+#endif // FRUIT_MEMORY_RESOURCE_H
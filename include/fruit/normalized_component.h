@@ -24,6 +24,8 @@
 #include <fruit/impl/fruit_internal_forward_decls.h>
 #include <fruit/impl/meta/component.h>
 #include <fruit/impl/normalized_component_storage/normalized_component_storage_holder.h>
+#include <fruit/normalized_component_options.h>
+#include <cstdint>
 #include <memory>
 
 namespace fruit {
@@ -113,14 +115,43 @@ public:
   template <typename... FormalArgs, typename... Args>
   explicit NormalizedComponent(Component<Params...> (*)(FormalArgs...), Args&&... args);
 
+  /**
+   * Similar to the previous constructor, but also takes some NormalizedComponentOptions that tweak how the normalized
+   * component is constructed. See the documentation of NormalizedComponentOptions for more details.
+   *
+   * Example usage:
+   *
+   * fruit::NormalizedComponentOptions options;
+   * options.deterministic_hashing = true;
+   * fruit::NormalizedComponent<Required<Request>, Foo> normalized_component(options, getFooComponent);
+   */
+  template <typename... FormalArgs, typename... Args>
+  NormalizedComponent(const NormalizedComponentOptions& options, Component<Params...> (*)(FormalArgs...),
+                      Args&&... args);
+
   NormalizedComponent(NormalizedComponent&& storage) noexcept : storage(std::move(storage.storage)) {}
   NormalizedComponent(const NormalizedComponent&) = delete;
 
   NormalizedComponent& operator=(NormalizedComponent&&) = delete;
   NormalizedComponent& operator=(const NormalizedComponent&) = delete;
 
+  /**
+   * Returns the multiplier of the hash function chosen to look up the bindings of this normalized component. This can
+   * be passed as NormalizedComponentOptions::hash_function_multiplier when constructing another NormalizedComponent
+   * with the same bindings, to skip the search for a suitable hash function.
+   */
+  std::uintptr_t getHashFunctionMultiplier() const;
+
+  /**
+   * Returns the number of candidate hash functions that were discarded (due to too many collisions) before choosing
+   * the one returned by getHashFunctionMultiplier(). This is 0 if the hash_function_multiplier passed in the
+   * NormalizedComponentOptions was used.
+   */
+  std::size_t getNumHashFunctionRetries() const;
+
 private:
-  NormalizedComponent(fruit::impl::ComponentStorage&& storage, fruit::impl::MemoryPool memory_pool);
+  NormalizedComponent(fruit::impl::ComponentStorage&& storage, fruit::impl::MemoryPool memory_pool,
+                      const NormalizedComponentOptions& options);
 
   // This is held via a unique_ptr to avoid including normalized_component_storage.h
   // in fruit.h.
@@ -129,6 +160,12 @@ private:
   template <typename... OtherParams>
   friend class Injector;
 
+  template <typename... OtherParams>
+  friend class InjectorPool;
+
+  template <typename... OtherParams>
+  friend class NormalizedComponentFuture;
+
   using Comp = fruit::impl::meta::Eval<fruit::impl::meta::ConstructComponentImpl(fruit::impl::meta::Type<Params>...)>;
 
   using Check1 = typename fruit::impl::meta::CheckIfError<Comp>::type;
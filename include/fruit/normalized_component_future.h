@@ -0,0 +1,129 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRUIT_NORMALIZED_COMPONENT_FUTURE_H
+#define FRUIT_NORMALIZED_COMPONENT_FUTURE_H
+
+// This include is not required here, but having it here shortens the include trace in error messages.
+#include <fruit/impl/injection_errors.h>
+
+#include <fruit/fruit_forward_decls.h>
+#include <fruit/normalized_component.h>
+#include <fruit/normalized_component_options.h>
+
+#include <future>
+
+namespace fruit {
+
+/**
+ * A NormalizedComponent that is being constructed in another thread. This is returned by fruit::normalizeAsync().
+ *
+ * This allows to do other work (e.g. parsing the configuration or opening sockets at startup) while the bindings are
+ * normalized, instead of blocking the current thread during the construction of the NormalizedComponent.
+ *
+ * Injectors can be constructed directly from a NormalizedComponentFuture (see the corresponding Injector
+ * constructors), and their construction waits for the normalization to complete (if it didn't already).
+ *
+ * The NormalizedComponent is owned by this object, so this object must remain valid during the lifetime of any
+ * Injector object constructed with it. The destructor waits for the normalization to complete (if it didn't already).
+ *
+ * The const methods of this class can be called concurrently from multiple threads.
+ *
+ * Example usage:
+ *
+ * fruit::NormalizedComponentFuture<Required<Request>, Bar> normalized_component_future =
+ *     fruit::normalizeAsync(getBarComponent);
+ * Config config = parseConfig();
+ * ...
+ * fruit::Injector<Foo, Bar> injector(normalized_component_future, getRequestComponent, &request);
+ */
+template <typename... Params>
+class NormalizedComponentFuture {
+public:
+  /**
+   * Starts the construction of a NormalizedComponent<Params...> with the given component function and arguments in
+   * another thread. The constraints on the argument types are the same as for the NormalizedComponent constructor.
+   *
+   * The component function is called in the other thread (together with the functions of the components that it
+   * installs), so it must not have any unsynchronized side effects on shared data.
+   * If a component function throws, the exception is stored and rethrown by get() and wait() and by the Injector
+   * constructors that take this NormalizedComponentFuture (in each call).
+   */
+  template <typename... FormalArgs, typename... Args>
+  explicit NormalizedComponentFuture(Component<Params...> (*)(FormalArgs...), Args&&... args);
+
+  /**
+   * Similar to the previous constructor, but the NormalizedComponent is constructed with the given options.
+   */
+  template <typename... FormalArgs, typename... Args>
+  NormalizedComponentFuture(const NormalizedComponentOptions& options, Component<Params...> (*)(FormalArgs...),
+                            Args&&... args);
+
+  NormalizedComponentFuture(NormalizedComponentFuture&&) noexcept = default;
+  NormalizedComponentFuture(const NormalizedComponentFuture&) = delete;
+
+  NormalizedComponentFuture& operator=(NormalizedComponentFuture&&) = delete;
+  NormalizedComponentFuture& operator=(const NormalizedComponentFuture&) = delete;
+
+  /**
+   * Returns true if the construction of the NormalizedComponent has completed, so that get() won't block.
+   */
+  bool isReady() const;
+
+  /**
+   * Blocks until the construction of the NormalizedComponent has completed.
+   * If a component function threw, this rethrows that exception.
+   */
+  void wait() const;
+
+  /**
+   * Blocks until the construction of the NormalizedComponent has completed, and then returns it.
+   * The returned reference is valid as long as this object.
+   * If a component function threw, this rethrows that exception.
+   */
+  const NormalizedComponent<Params...>& get() const;
+
+private:
+  static NormalizedComponent<Params...> normalize(fruit::impl::ComponentStorage&& component_storage,
+                                                  const NormalizedComponentOptions& options);
+
+  std::shared_future<NormalizedComponent<Params...>> future;
+};
+
+/**
+ * Starts the construction of a NormalizedComponent in another thread, and returns a NormalizedComponentFuture that
+ * can be used to construct injectors (or to wait for the NormalizedComponent). See the documentation of
+ * NormalizedComponentFuture for more details.
+ *
+ * Example usage:
+ *
+ * auto normalized_component_future = fruit::normalizeAsync(getRootComponent, config_path);
+ */
+template <typename... Params, typename... FormalArgs, typename... Args>
+NormalizedComponentFuture<Params...> normalizeAsync(Component<Params...> (*)(FormalArgs...), Args&&... args);
+
+/**
+ * Similar to the previous function, but the NormalizedComponent is constructed with the given options.
+ */
+template <typename... Params, typename... FormalArgs, typename... Args>
+NormalizedComponentFuture<Params...> normalizeAsync(const NormalizedComponentOptions& options,
+                                                    Component<Params...> (*)(FormalArgs...), Args&&... args);
+
+} // namespace fruit
+
+#include <fruit/impl/normalized_component_future.defn.h>
+
+#endif // FRUIT_NORMALIZED_COMPONENT_FUTURE_H
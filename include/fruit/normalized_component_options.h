@@ -0,0 +1,108 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef FRUIT_NORMALIZED_COMPONENT_OPTIONS_H
+#define FRUIT_NORMALIZED_COMPONENT_OPTIONS_H
+
+#include <fruit/fruit_forward_decls.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fruit {
+
+/**
+ * Options that tweak how a NormalizedComponent is constructed. These don't affect which types can be injected.
+ *
+ * The default-constructed options give the same behavior as the NormalizedComponent constructor that doesn't take any
+ * options.
+ *
+ * Example usage:
+ *
+ * fruit::NormalizedComponentOptions options;
+ * options.deterministic_hashing = true;
+ * fruit::NormalizedComponent<Required<Request>, Foo> normalized_component(options, getFooComponent);
+ */
+struct NormalizedComponentOptions {
+  /**
+   * A NormalizedComponent uses a hash table with a randomly-chosen hash function to look up the bindings of each type.
+   * Candidate hash functions are tried until one is found that doesn't have too many collisions, so the construction
+   * time can vary.
+   *
+   * By default the random generator is seeded with the current time. If this is true, a fixed seed is used instead, so
+   * that constructing a NormalizedComponent with the same bindings in the same process always tries the same
+   * candidates (and picks the same hash function).
+   */
+  bool deterministic_hashing = false;
+
+  /**
+   * If this is not 0, it's tried as the hash function multiplier before any randomly-generated one, and it's used if
+   * it's suitable for the bindings (in that case, no search is performed).
+   *
+   * This is typically the result of getHashFunctionMultiplier() on a NormalizedComponent with the same bindings
+   * constructed earlier in the same process. Note that the hash of a type is based on its address in memory, so a
+   * multiplier is not guaranteed to be suitable for the same bindings in a different run of the program.
+   */
+  std::uintptr_t hash_function_multiplier = 0;
+
+  /**
+   * If this is not nullptr, the memory for the objects shared across injectors (see
+   * PartialComponent::shareAcrossInjectors()) is allocated from this resource instead of the heap. These objects are
+   * owned by the NormalizedComponent, so the resource must outlive it.
+   *
+   * This doesn't affect the objects owned by each injector; see InjectorOptions::memory_resource for those.
+   */
+  MemoryResource* memory_resource = nullptr;
+
+  /**
+   * If this is greater than 1, the functions of the components installed (directly or indirectly) by the component
+   * passed to the NormalizedComponent constructor are called using up to this many threads (including the current
+   * one), before the bindings are normalized. This can reduce the construction time when many components are
+   * installed.
+   *
+   * The bindings are still normalized in the current thread, in the same order, so this doesn't change the result nor
+   * the errors that are reported (e.g. for multiple bindings of the same type).
+   *
+   * Component functions (and the copy, hashing and equality operations of their arguments) can then be called
+   * concurrently, so they must not have any unsynchronized side effects on shared data. Note that the functions of
+   * components that are then replaced (see PartialComponent::replace()) might also be called.
+   * If a component function throws, the components that are not being expanded yet are skipped, and the first
+   * exception propagates out of the NormalizedComponent constructor once the functions that were already running (in
+   * other threads) have returned, as it would with a single thread.
+   */
+  std::size_t num_normalization_threads = 1;
+
+  /**
+   * If this is true, the bindings added by each component function are saved in a cache shared by the whole process,
+   * and later normalizations (with this option set) that install the same component function with equal arguments
+   * reuse them instead of calling the function again. This is useful when constructing many NormalizedComponent or
+   * Injector objects (e.g. in tests, or one for each tenant of a server) whose components install the same large
+   * subcomponents.
+   *
+   * This is only correct if each component function always returns the same bindings when called with equal
+   * arguments (e.g. it must not bind a different instance each time). Replacements (see PartialComponent::replace())
+   * still work as usual, since each component is cached separately from the ones that it installs.
+   *
+   * The cached bindings are never removed (they're kept until the end of the program), so avoid this for components
+   * with arguments that can take many different values.
+   */
+  bool use_component_expansion_cache = false;
+};
+
+} // namespace fruit
+
+#endif // FRUIT_NORMALIZED_COMPONENT_OPTIONS_H
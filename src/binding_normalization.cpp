@@ -21,6 +21,7 @@
 #include <fruit/impl/util/type_info.h>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <fruit/impl/data_structures/semistatic_graph.templates.h>
@@ -94,6 +95,150 @@ void BindingNormalization::printMultipleBindingsError(TypeId type) {
   exit(1);
 }
 
+void BindingNormalization::printTypeSharedAcrossInjectorsNotBoundError(TypeId shared_type, TypeId unbound_type) {
+  std::cerr << "Fatal injection error: the type " << shared_type.type_info->name()
+            << " is shared across injectors, but ";
+  if (shared_type == unbound_type) {
+    std::cerr << "it's not bound in the normalized component." << std::endl;
+  } else {
+    std::cerr << "it (directly or indirectly) depends on " << unbound_type.type_info->name()
+              << ", that's not bound in the normalized component." << std::endl;
+  }
+  std::cerr << "The types passed to shareAcrossInjectors() and all their dependencies must be bound in the "
+            << "NormalizedComponent, they can't be provided by the components used to create the injectors."
+            << std::endl;
+  exit(1);
+}
+
+void BindingNormalization::addDependenciesOfTypesSharedAcrossInjectors(
+    const HashMapWithArenaAllocator<TypeId, ComponentStorageEntry>& binding_data_map,
+    std::vector<TypeId, ArenaAllocator<TypeId>>& types_shared_across_injectors, MemoryPool& memory_pool) {
+  if (types_shared_across_injectors.empty()) {
+    return;
+  }
+
+  // Maps each type that was found to the type passed to shareAcrossInjectors() that (directly or indirectly) depends
+  // on it, for error messages.
+  HashMapWithArenaAllocator<TypeId, TypeId> shared_type_by_type = createHashMapWithArenaAllocator<TypeId, TypeId>(
+      types_shared_across_injectors.size(), memory_pool);
+
+  std::vector<TypeId, ArenaAllocator<TypeId>> types_to_visit = std::move(types_shared_across_injectors);
+  types_shared_across_injectors = std::vector<TypeId, ArenaAllocator<TypeId>>(ArenaAllocator<TypeId>(memory_pool));
+  for (TypeId type : types_to_visit) {
+    shared_type_by_type.insert(std::make_pair(type, type));
+  }
+
+  HashSetWithArenaAllocator<TypeId> visited_types =
+      createHashSetWithArenaAllocator<TypeId>(types_to_visit.size(), memory_pool);
+  while (!types_to_visit.empty()) {
+    TypeId type = types_to_visit.back();
+    types_to_visit.pop_back();
+    if (!visited_types.insert(type).second) {
+      continue;
+    }
+    TypeId shared_type = shared_type_by_type.at(type);
+
+    auto itr = binding_data_map.find(type);
+    if (itr == binding_data_map.end()) {
+      printTypeSharedAcrossInjectorsNotBoundError(shared_type, type);
+      FRUIT_UNREACHABLE; // LCOV_EXCL_LINE
+    }
+    types_shared_across_injectors.push_back(type);
+
+    const ComponentStorageEntry& entry = itr->second;
+    if (entry.kind != ComponentStorageEntry::Kind::BINDING_FOR_CONSTRUCTED_OBJECT) {
+      const BindingDeps* deps = entry.binding_for_object_to_construct.deps;
+      for (std::size_t i = 0; i < deps->num_deps; ++i) {
+        shared_type_by_type.insert(std::make_pair(deps->deps[i], shared_type));
+        types_to_visit.push_back(deps->deps[i]);
+      }
+    }
+  }
+}
+
+HashSetWithArenaAllocator<TypeId> BindingNormalization::findReachableTypes(
+    const HashMapWithArenaAllocator<TypeId, ComponentStorageEntry>& binding_data_map, const TypeId* first,
+    const TypeId* last, MemoryPool& memory_pool) {
+  HashSetWithArenaAllocator<TypeId> reachable_types =
+      createHashSetWithArenaAllocator<TypeId>(binding_data_map.size(), memory_pool);
+  std::vector<TypeId, ArenaAllocator<TypeId>> types_to_visit(first, last, ArenaAllocator<TypeId>(memory_pool));
+  while (!types_to_visit.empty()) {
+    TypeId type = types_to_visit.back();
+    types_to_visit.pop_back();
+    if (!reachable_types.insert(type).second) {
+      continue;
+    }
+    auto itr = binding_data_map.find(type);
+    if (itr == binding_data_map.end()) {
+      continue;
+    }
+    const ComponentStorageEntry& entry = itr->second;
+    if (entry.kind != ComponentStorageEntry::Kind::BINDING_FOR_CONSTRUCTED_OBJECT) {
+      const BindingDeps* deps = entry.binding_for_object_to_construct.deps;
+      types_to_visit.insert(types_to_visit.end(), deps->deps, deps->deps + deps->num_deps);
+    }
+  }
+  return reachable_types;
+}
+
+std::size_t BindingNormalization::removeUnreachableBindings(
+    HashMapWithArenaAllocator<TypeId, ComponentStorageEntry>& binding_data_map,
+    HashMapWithArenaAllocator<TypeId, BindingCompressionInfo>& compressed_bindings_map,
+    FixedSizeAllocator::FixedSizeAllocatorData& fixed_size_allocator_data,
+    const multibindings_vector_t& multibindings_vector,
+    const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
+    const std::vector<TypeId, ArenaAllocator<TypeId>>& types_shared_across_injectors, MemoryPool& memory_pool) {
+  std::vector<TypeId, ArenaAllocator<TypeId>> roots(exposed_types.begin(), exposed_types.end(),
+                                                    ArenaAllocator<TypeId>(memory_pool));
+  roots.insert(roots.end(), types_shared_across_injectors.begin(), types_shared_across_injectors.end());
+  for (const multibindings_vector_elem_t& multibinding : multibindings_vector) {
+    if (multibinding.first.kind != ComponentStorageEntry::Kind::MULTIBINDING_FOR_CONSTRUCTED_OBJECT) {
+      const BindingDeps* deps = multibinding.first.multibinding_for_object_to_construct.deps;
+      roots.insert(roots.end(), deps->deps, deps->deps + deps->num_deps);
+    }
+  }
+
+  HashSetWithArenaAllocator<TypeId> reachable_types =
+      findReachableTypes(binding_data_map, roots.data(), roots.data() + roots.size(), memory_pool);
+
+  std::size_t num_removed_bindings = 0;
+  for (auto itr = binding_data_map.begin(); itr != binding_data_map.end();) {
+    if (reachable_types.count(itr->first) != 0) {
+      ++itr;
+      continue;
+    }
+#if FRUIT_EXTRA_DEBUG
+    std::cout << "InjectorStorage: removing the binding for " << itr->first << " because it's unreachable."
+              << std::endl;
+#endif
+    switch (itr->second.kind) { // LCOV_EXCL_BR_LINE
+    case ComponentStorageEntry::Kind::BINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_ALLOCATION:
+      fixed_size_allocator_data.removeType(itr->first);
+      break;
+
+    case ComponentStorageEntry::Kind::BINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_NO_ALLOCATION:
+      fixed_size_allocator_data.removeExternallyAllocatedType(itr->first);
+      break;
+
+    default:
+      break;
+    }
+    itr = binding_data_map.erase(itr);
+    ++num_removed_bindings;
+  }
+
+  // A compressed binding can't be performed if the binding for I or C was removed.
+  for (auto itr = compressed_bindings_map.begin(); itr != compressed_bindings_map.end();) {
+    if (binding_data_map.count(itr->first) == 0 || binding_data_map.count(itr->second.i_type_id) == 0) {
+      itr = compressed_bindings_map.erase(itr);
+    } else {
+      ++itr;
+    }
+  }
+
+  return num_removed_bindings;
+}
+
 void BindingNormalization::printIncompatibleComponentReplacementsError(
     const ComponentStorageEntry& replaced_component_entry, const ComponentStorageEntry& replacement_component_entry1,
     const ComponentStorageEntry& replacement_component_entry2) {
@@ -275,18 +420,20 @@ void BindingNormalization::normalizeBindingsWithUndoableBindingCompression(
     const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
     std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& bindings_vector,
     std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings,
+    std::vector<TypeId, ArenaAllocator<TypeId>>& types_shared_across_injectors,
     BindingCompressionInfoMap& bindingCompressionInfoMap,
     LazyComponentWithNoArgsSet& fully_expanded_components_with_no_args,
     LazyComponentWithArgsSet& fully_expanded_components_with_args,
     LazyComponentWithNoArgsReplacementMap& component_with_no_args_replacements,
-    LazyComponentWithArgsReplacementMap& component_with_args_replacements) {
+    LazyComponentWithArgsReplacementMap& component_with_args_replacements, std::size_t num_threads,
+    ComponentExpansionCache* component_expansion_cache) {
 
   FruitAssert(bindingCompressionInfoMap.empty());
 
   normalizeBindingsWithBindingCompression(
       std::move(toplevel_entries), fixed_size_allocator_data, memory_pool,
       memory_pool_for_fully_expanded_components_maps, memory_pool_for_component_replacements_maps, exposed_types,
-      bindings_vector, multibindings,
+      bindings_vector, multibindings, types_shared_across_injectors,
       [&bindingCompressionInfoMap](TypeId c_type_id, NormalizedComponentStorage::CompressedBindingUndoInfo undo_info) {
         bindingCompressionInfoMap[c_type_id] = undo_info;
       },
@@ -305,7 +452,9 @@ void BindingNormalization::normalizeBindingsWithUndoableBindingCompression(
       [&component_with_args_replacements, &memory_pool](LazyComponentWithArgsReplacementMap& component_replacements) {
         component_with_args_replacements = std::move(component_replacements);
         component_replacements = NormalizedComponentStorage::createLazyComponentWithArgsReplacementMap(0, memory_pool);
-      });
+      },
+      num_threads, component_expansion_cache, nullptr /* lazy_normalization */,
+      nullptr /* num_removed_unreachable_bindings */);
 }
 
 void BindingNormalization::normalizeBindingsWithPermanentBindingCompression(
@@ -313,12 +462,22 @@ void BindingNormalization::normalizeBindingsWithPermanentBindingCompression(
     FixedSizeAllocator::FixedSizeAllocatorData& fixed_size_allocator_data, MemoryPool& memory_pool,
     const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
     std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& bindings_vector,
-    std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings) {
+    std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings, std::size_t num_threads,
+    ComponentExpansionCache* component_expansion_cache, bool lazy_normalization, bool strict_lazy_normalization,
+    std::size_t* num_removed_unreachable_bindings) {
+  // There's only 1 injector here, so the types shared across injectors just don't need any special handling (other
+  // than not being compressed).
+  std::vector<TypeId, ArenaAllocator<TypeId>> types_shared_across_injectors =
+      std::vector<TypeId, ArenaAllocator<TypeId>>(ArenaAllocator<TypeId>(memory_pool));
+  LazyNormalizationParams lazy_normalization_params = {&exposed_types, strict_lazy_normalization};
   normalizeBindingsWithBindingCompression(
       std::move(toplevel_entries), fixed_size_allocator_data, memory_pool, memory_pool, memory_pool, exposed_types,
-      bindings_vector, multibindings, [](TypeId, NormalizedComponentStorage::CompressedBindingUndoInfo) {},
+      bindings_vector, multibindings, types_shared_across_injectors,
+      [](TypeId, NormalizedComponentStorage::CompressedBindingUndoInfo) {},
       [](LazyComponentWithNoArgsSet&) {}, [](LazyComponentWithArgsSet&) {},
-      [](LazyComponentWithNoArgsReplacementMap&) {}, [](LazyComponentWithArgsReplacementMap&) {});
+      [](LazyComponentWithNoArgsReplacementMap&) {}, [](LazyComponentWithArgsReplacementMap&) {}, num_threads,
+      component_expansion_cache, lazy_normalization ? &lazy_normalization_params : nullptr,
+      num_removed_unreachable_bindings);
 }
 
 void BindingNormalization::normalizeBindingsAndAddTo(
@@ -328,6 +487,278 @@ void BindingNormalization::normalizeBindingsAndAddTo(
     std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& new_bindings_vector,
     std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings) {
 
+  using entries_vector_t = std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>;
+  entries_vector_t expanded_entries = entries_vector_t(ArenaAllocator<ComponentStorageEntry>(memory_pool));
+  ComponentStorageEntry::LazyComponentWithNoArgs::erased_fun_t component_fun;
+  if (!expandComponentForInjectorPlan(toplevel_entries, base_normalized_component, expanded_entries, component_fun)) {
+    normalizeBindingsAndAddToWithoutInjectorPlan(std::move(toplevel_entries), memory_pool, base_normalized_component,
+                                                 fixed_size_allocator_data, new_bindings_vector, multibindings);
+    return;
+  }
+
+  // The first element is the end marker for the expanded component, that's not part of the plan's key.
+  const ComponentStorageEntry* component_entries_begin = expanded_entries.data() + 1;
+  const ComponentStorageEntry* component_entries_end = expanded_entries.data() + expanded_entries.size();
+  bool can_use_injector_plan = canUseInjectorPlan(component_entries_begin, component_entries_end);
+  std::size_t hash = 0;
+
+  if (can_use_injector_plan) {
+    hash = hashEntriesForInjectorPlan(component_entries_begin, component_entries_end);
+    const InjectorPlan* injector_plan = findInjectorPlan(base_normalized_component, component_fun,
+                                                         component_entries_begin, component_entries_end, hash);
+    if (injector_plan != nullptr) {
+      fixed_size_allocator_data = injector_plan->fixed_size_allocator_data;
+      multibindings = injector_plan->multibindings;
+      new_bindings_vector.assign(injector_plan->bindings.begin(), injector_plan->bindings.end());
+      for (const std::pair<std::size_t, std::size_t>& p : injector_plan->constructed_object_bindings) {
+        new_bindings_vector[p.second].binding_for_constructed_object =
+            component_entries_begin[p.first].binding_for_constructed_object;
+      }
+      // The end marker owns the lazy component (if it has args), normally this is done by normalizeBindings().
+      if (expanded_entries[0].kind == ComponentStorageEntry::Kind::COMPONENT_WITH_ARGS_END_MARKER) {
+        expanded_entries[0].lazy_component_with_args.destroy();
+      }
+      return;
+    }
+  }
+
+  FixedSizeVector<ComponentStorageEntry> entries_to_normalize(expanded_entries.size());
+  for (const ComponentStorageEntry& entry : expanded_entries) {
+    entries_to_normalize.push_back(entry);
+  }
+  normalizeBindingsAndAddToWithoutInjectorPlan(std::move(entries_to_normalize), memory_pool,
+                                               base_normalized_component, fixed_size_allocator_data,
+                                               new_bindings_vector, multibindings);
+
+  if (can_use_injector_plan) {
+    saveInjectorPlan(base_normalized_component, component_fun, component_entries_begin, component_entries_end, hash,
+                     memory_pool, fixed_size_allocator_data, new_bindings_vector, multibindings);
+  }
+}
+
+bool BindingNormalization::expandComponentForInjectorPlan(
+    FixedSizeVector<ComponentStorageEntry>& toplevel_entries,
+    const NormalizedComponentStorage& base_normalized_component,
+    std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& expanded_entries,
+    ComponentStorageEntry::LazyComponentWithNoArgs::erased_fun_t& component_fun) {
+  if (toplevel_entries.size() != 1) {
+    return false;
+  }
+  ComponentStorageEntry entry = toplevel_entries[0];
+
+  // These are the same checks done in handleLazyComponentWith[No]Args(): if the component was already expanded or is
+  // replaced, we let normalizeBindings() handle it.
+  // There's no need to check for component replacements in the component itself since it's the only toplevel entry.
+  switch (entry.kind) {
+  case ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_ARGS:
+    if (base_normalized_component.fully_expanded_components_with_args.count(entry.lazy_component_with_args) != 0 ||
+        base_normalized_component.component_with_args_replacements.find(entry.lazy_component_with_args) !=
+            base_normalized_component.component_with_args_replacements.end()) {
+      return false;
+    }
+    component_fun = entry.lazy_component_with_args.component->erased_fun;
+    expanded_entries.push_back(entry);
+    expanded_entries.back().kind = ComponentStorageEntry::Kind::COMPONENT_WITH_ARGS_END_MARKER;
+    entry.lazy_component_with_args.component->addBindings(expanded_entries);
+    break;
+
+  case ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_NO_ARGS:
+    if (base_normalized_component.fully_expanded_components_with_no_args.count(entry.lazy_component_with_no_args) !=
+            0 ||
+        base_normalized_component.component_with_no_args_replacements.find(entry.lazy_component_with_no_args) !=
+            base_normalized_component.component_with_no_args_replacements.end()) {
+      return false;
+    }
+    component_fun = entry.lazy_component_with_no_args.erased_fun;
+    expanded_entries.push_back(entry);
+    expanded_entries.back().kind = ComponentStorageEntry::Kind::COMPONENT_WITHOUT_ARGS_END_MARKER;
+    entry.lazy_component_with_no_args.addBindings(expanded_entries);
+    break;
+
+  default:
+    return false;
+  }
+
+  // The lazy component is now owned by the end marker in expanded_entries.
+  toplevel_entries.clear();
+  return true;
+}
+
+bool BindingNormalization::canUseInjectorPlan(const ComponentStorageEntry* first, const ComponentStorageEntry* last) {
+  for (const ComponentStorageEntry* itr = first; itr != last; ++itr) {
+    switch (itr->kind) { // LCOV_EXCL_BR_LINE
+    case ComponentStorageEntry::Kind::BINDING_FOR_CONSTRUCTED_OBJECT:
+    case ComponentStorageEntry::Kind::BINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_ALLOCATION:
+    case ComponentStorageEntry::Kind::BINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_NO_ALLOCATION:
+    case ComponentStorageEntry::Kind::COMPRESSED_BINDING:
+    case ComponentStorageEntry::Kind::MULTIBINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_ALLOCATION:
+    case ComponentStorageEntry::Kind::MULTIBINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_NO_ALLOCATION:
+    case ComponentStorageEntry::Kind::MULTIBINDING_VECTOR_CREATOR:
+    case ComponentStorageEntry::Kind::TYPE_SHARED_ACROSS_INJECTORS:
+    // Lazy components with no args always expand to the same bindings, except that they might bind different objects
+    // (e.g. with bindInstance()); saveInjectorPlan() doesn't save plans in that case.
+    case ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_NO_ARGS:
+      break;
+
+    default:
+      // Lazy components with args and component replacements might expand differently in the next component, and
+      // patching multibindings for constructed objects is not supported.
+      return false;
+    }
+  }
+  return true;
+}
+
+bool BindingNormalization::isSameEntryForInjectorPlan(const ComponentStorageEntry& x, const ComponentStorageEntry& y) {
+  if (x.kind != y.kind || !(x.type_id == y.type_id)) {
+    return false;
+  }
+  switch (x.kind) { // LCOV_EXCL_BR_LINE
+  case ComponentStorageEntry::Kind::BINDING_FOR_CONSTRUCTED_OBJECT:
+#if FRUIT_EXTRA_DEBUG
+    return x.binding_for_constructed_object.is_nonconst == y.binding_for_constructed_object.is_nonconst;
+#else
+    return true;
+#endif
+
+  case ComponentStorageEntry::Kind::BINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_ALLOCATION:
+  case ComponentStorageEntry::Kind::BINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_NO_ALLOCATION:
+    return x.binding_for_object_to_construct.create == y.binding_for_object_to_construct.create &&
+           x.binding_for_object_to_construct.deps == y.binding_for_object_to_construct.deps
+#if FRUIT_EXTRA_DEBUG
+           && x.binding_for_object_to_construct.is_nonconst == y.binding_for_object_to_construct.is_nonconst
+#endif
+        ;
+
+  case ComponentStorageEntry::Kind::COMPRESSED_BINDING:
+    return x.compressed_binding.c_type_id == y.compressed_binding.c_type_id &&
+           x.compressed_binding.create == y.compressed_binding.create;
+
+  case ComponentStorageEntry::Kind::MULTIBINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_ALLOCATION:
+  case ComponentStorageEntry::Kind::MULTIBINDING_FOR_OBJECT_TO_CONSTRUCT_THAT_NEEDS_NO_ALLOCATION:
+    return x.multibinding_for_object_to_construct.create == y.multibinding_for_object_to_construct.create &&
+           x.multibinding_for_object_to_construct.deps == y.multibinding_for_object_to_construct.deps;
+
+  case ComponentStorageEntry::Kind::MULTIBINDING_VECTOR_CREATOR:
+    return x.multibinding_vector_creator.get_multibindings_vector ==
+           y.multibinding_vector_creator.get_multibindings_vector;
+
+  case ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_NO_ARGS:
+    return x.lazy_component_with_no_args == y.lazy_component_with_no_args;
+
+  case ComponentStorageEntry::Kind::TYPE_SHARED_ACROSS_INJECTORS:
+    return true;
+
+  default:
+    FRUIT_UNREACHABLE; // LCOV_EXCL_LINE
+  }
+}
+
+std::size_t BindingNormalization::hashEntriesForInjectorPlan(const ComponentStorageEntry* first,
+                                                             const ComponentStorageEntry* last) {
+  // This only hashes the kind and type_id of each entry, the other fields are only compared in
+  // isSameEntryForInjectorPlan().
+  std::size_t hash = 0;
+  for (const ComponentStorageEntry* itr = first; itr != last; ++itr) {
+    hash = hash * 31 + static_cast<std::size_t>(itr->kind);
+    hash = hash * 31 + std::hash<TypeId>()(itr->type_id);
+  }
+  return hash;
+}
+
+const BindingNormalization::InjectorPlan* BindingNormalization::findInjectorPlan(
+    const NormalizedComponentStorage& base_normalized_component,
+    ComponentStorageEntry::LazyComponentWithNoArgs::erased_fun_t component_fun, const ComponentStorageEntry* first,
+    const ComponentStorageEntry* last, std::size_t hash) {
+  // Pairs with the release operation in saveInjectorPlan(), so that the plans are visible without locking.
+  std::size_t num_injector_plans = base_normalized_component.num_injector_plans.load(std::memory_order_acquire);
+  for (std::size_t i = 0; i < num_injector_plans; ++i) {
+    const InjectorPlan* injector_plan = base_normalized_component.injector_plans[i].get();
+    if (injector_plan->component_fun == component_fun && injector_plan->component_entries_hash == hash &&
+        injector_plan->component_entries.size() == static_cast<std::size_t>(last - first) &&
+        std::equal(first, last, injector_plan->component_entries.begin(), isSameEntryForInjectorPlan)) {
+      return injector_plan;
+    }
+  }
+  return nullptr;
+}
+
+void BindingNormalization::saveInjectorPlan(
+    const NormalizedComponentStorage& base_normalized_component,
+    ComponentStorageEntry::LazyComponentWithNoArgs::erased_fun_t component_fun, const ComponentStorageEntry* first,
+    const ComponentStorageEntry* last, std::size_t hash, MemoryPool& memory_pool,
+    const FixedSizeAllocator::FixedSizeAllocatorData& fixed_size_allocator_data,
+    const std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& new_bindings_vector,
+    const std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings) {
+
+  std::unique_ptr<InjectorPlan> injector_plan(new InjectorPlan());
+  injector_plan->component_fun = component_fun;
+  injector_plan->component_entries.assign(first, last);
+  injector_plan->component_entries_hash = hash;
+  injector_plan->bindings.assign(new_bindings_vector.begin(), new_bindings_vector.end());
+  injector_plan->fixed_size_allocator_data = fixed_size_allocator_data;
+  injector_plan->multibindings = multibindings;
+
+  // Find the normalized binding for each BINDING_FOR_CONSTRUCTED_OBJECT entry.
+  HashMapWithArenaAllocator<TypeId, std::size_t> binding_index_by_type =
+      createHashMapWithArenaAllocator<TypeId, std::size_t>(new_bindings_vector.size(), memory_pool);
+  for (std::size_t j = 0; j < new_bindings_vector.size(); ++j) {
+    if (new_bindings_vector[j].kind == ComponentStorageEntry::Kind::BINDING_FOR_CONSTRUCTED_OBJECT) {
+      binding_index_by_type[new_bindings_vector[j].type_id] = j;
+    }
+  }
+  for (std::size_t i = 0; i < injector_plan->component_entries.size(); ++i) {
+    const ComponentStorageEntry& entry = injector_plan->component_entries[i];
+    if (entry.kind != ComponentStorageEntry::Kind::BINDING_FOR_CONSTRUCTED_OBJECT) {
+      continue;
+    }
+    auto itr = binding_index_by_type.find(entry.type_id);
+    if (itr == binding_index_by_type.end()) {
+      // The object is also bound in the normalized component, the next component might bind a different object (and
+      // that's an error that we'd fail to report if we used the plan).
+      return;
+    }
+    injector_plan->constructed_object_bindings.emplace_back(i, itr->second);
+    // This ensures that the same type isn't bound twice in the component (the objects might be different next time).
+    binding_index_by_type.erase(itr);
+  }
+  if (!binding_index_by_type.empty()) {
+    // Some objects were bound by a component installed by this one. These are not in component_entries, so they
+    // couldn't be patched and the next injector would get the objects bound for this one.
+    return;
+  }
+  for (const auto& p : multibindings) {
+    for (const NormalizedMultibinding& multibinding : p.second.elems) {
+      if (multibinding.is_constructed) {
+        // Same for multibindings for constructed objects (these can only come from an installed component, since the
+        // plan is only used if there are none in the component itself).
+        return;
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(base_normalized_component.injector_plans_mutex);
+  // Only modified while holding the lock, so this doesn't need to be an acquire operation.
+  std::size_t num_injector_plans = base_normalized_component.num_injector_plans.load(std::memory_order_relaxed);
+  if (num_injector_plans >= NormalizedComponentStorage::max_num_injector_plans) {
+    return;
+  }
+  if (findInjectorPlan(base_normalized_component, component_fun, first, last, hash) != nullptr) {
+    // Another thread saved an equivalent plan in the meantime.
+    return;
+  }
+  base_normalized_component.injector_plans[num_injector_plans] = std::move(injector_plan);
+  // Publishes the new plan to findInjectorPlan().
+  base_normalized_component.num_injector_plans.store(num_injector_plans + 1, std::memory_order_release);
+}
+
+void BindingNormalization::normalizeBindingsAndAddToWithoutInjectorPlan(
+    FixedSizeVector<ComponentStorageEntry>&& toplevel_entries, MemoryPool& memory_pool,
+    const NormalizedComponentStorage& base_normalized_component,
+    FixedSizeAllocator::FixedSizeAllocatorData& fixed_size_allocator_data,
+    std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& new_bindings_vector,
+    std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings) {
+
   multibindings = base_normalized_component.multibindings;
 
   fixed_size_allocator_data = base_normalized_component.fixed_size_allocator_data;
@@ -342,10 +773,13 @@ void BindingNormalization::normalizeBindingsAndAddTo(
 
   normalizeBindings(
       std::move(toplevel_entries), fixed_size_allocator_data, memory_pool, memory_pool, memory_pool, binding_data_map,
+      nullptr /* component_expander */, nullptr /* component_expansion_cache */, nullptr /* lazy_normalization */,
       [](ComponentStorageEntry) {},
       [&multibindings_vector](ComponentStorageEntry multibinding, ComponentStorageEntry multibinding_vector_creator) {
         multibindings_vector.emplace_back(multibinding, multibinding_vector_creator);
       },
+      // Types can only be shared across injectors in the normalized component itself.
+      [](ComponentStorageEntry) {},
       [&base_normalized_component](TypeId type_id) { return base_normalized_component.bindings.find(type_id); },
       [&base_normalized_component](Graph::const_node_iterator itr) {
         return !(itr == base_normalized_component.bindings.end());
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE 1
+
+#include <fruit/impl/normalized_component_storage/component_expansion_cache.h>
+
+namespace fruit {
+namespace impl {
+
+namespace {
+
+// Appends a copy of the entries in [first, last) to `entries'.
+template <typename Iterator, typename EntryVector>
+void copyEntries(Iterator first, Iterator last, EntryVector& entries) {
+  for (Iterator itr = first; itr != last; ++itr) {
+    entries.push_back(itr->copy());
+  }
+}
+
+void destroyEntries(const std::vector<ComponentStorageEntry>& entries) {
+  for (const ComponentStorageEntry& entry : entries) {
+    entry.destroy();
+  }
+}
+
+} // namespace
+
+ComponentExpansionCache& ComponentExpansionCache::getInstance() {
+  static ComponentExpansionCache instance;
+  return instance;
+}
+
+ComponentExpansionCache::~ComponentExpansionCache() {
+  for (const auto& pair : expansions_with_no_args) {
+    destroyEntries(pair.second);
+  }
+  for (const auto& pair : expansions_with_args) {
+    destroyEntries(pair.second);
+    pair.first.destroy();
+  }
+}
+
+void ComponentExpansionCache::addBindings(const LazyComponentWithNoArgs& component, entry_vector_t& entries) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto itr = expansions_with_no_args.find(component);
+    if (itr != expansions_with_no_args.end()) {
+      copyEntries(itr->second.begin(), itr->second.end(), entries);
+      return;
+    }
+  }
+
+  std::size_t num_entries_before_expansion = entries.size();
+  component.addBindings(entries);
+  std::vector<ComponentStorageEntry> expansion;
+  expansion.reserve(entries.size() - num_entries_before_expansion);
+  copyEntries(entries.begin() + num_entries_before_expansion, entries.end(), expansion);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (expansions_with_no_args.count(component) == 0) {
+    expansions_with_no_args.emplace(component, std::move(expansion));
+  } else {
+    // Another thread expanded the same component in the meantime.
+    destroyEntries(expansion);
+  }
+}
+
+void ComponentExpansionCache::addBindings(const LazyComponentWithArgs& component, entry_vector_t& entries) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto itr = expansions_with_args.find(component);
+    if (itr != expansions_with_args.end()) {
+      copyEntries(itr->second.begin(), itr->second.end(), entries);
+      return;
+    }
+  }
+
+  std::size_t num_entries_before_expansion = entries.size();
+  component.component->addBindings(entries);
+  std::vector<ComponentStorageEntry> expansion;
+  expansion.reserve(entries.size() - num_entries_before_expansion);
+  copyEntries(entries.begin() + num_entries_before_expansion, entries.end(), expansion);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (expansions_with_args.count(component) == 0) {
+    expansions_with_args.emplace(component.copy(), std::move(expansion));
+  } else {
+    // Another thread expanded the same component in the meantime.
+    destroyEntries(expansion);
+  }
+}
+
+} // namespace impl
+} // namespace fruit
@@ -29,7 +29,13 @@ FixedSizeAllocator::~FixedSizeAllocator() {
     --p;
     p->first(p->second);
   }
-  delete[] storage_begin;
+  if (storage_begin != nullptr) {
+    if (memory_resource != nullptr) {
+      memory_resource->deallocate(storage_begin, storage_size, 1);
+    } else {
+      storage_allocator.deallocate(storage_begin, storage_size);
+    }
+  }
 }
 
 } // namespace impl
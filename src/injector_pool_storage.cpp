@@ -0,0 +1,90 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE 1
+
+#include <fruit/impl/component_storage/component_storage.h>
+#include <fruit/impl/injector/injector_pool_storage.h>
+#include <fruit/impl/normalized_component_storage/normalized_component_storage.h>
+
+namespace fruit {
+namespace impl {
+
+InjectorPoolStorage::InjectorPoolStorage(const InjectorOptions& options, std::size_t max_idle_injectors)
+    : options(options), max_idle_injectors(max_idle_injectors) {
+  // Pooled injectors are short-lived (e.g. one per request), so skipping the destruction of their objects would leak
+  // them at every release() instead of only at exit. The objects are always destroyed instead.
+  this->options.skip_object_destruction = false;
+}
+
+InjectorPoolStorage::~InjectorPoolStorage() {
+  for (InjectorStorage::MemoryBlock block : idle_blocks) {
+    InjectorStorage::deallocate(block);
+  }
+}
+
+std::unique_ptr<InjectorStorage> InjectorPoolStorage::acquire(const NormalizedComponentStorage& normalized_storage,
+                                                              ComponentStorage&& storage, MemoryPool& memory_pool) {
+  InjectorStorage::MemoryBlock block;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!idle_blocks.empty()) {
+      block = idle_blocks.back();
+      idle_blocks.pop_back();
+    }
+  }
+
+  std::unique_ptr<InjectorStorage> injector;
+#if FRUIT_HAS_EXCEPTIONS
+  try {
+#endif
+    injector = InjectorStorage::create(normalized_storage, std::move(storage), memory_pool, options, &block);
+#if FRUIT_HAS_EXCEPTIONS
+  } catch (...) {
+    // E.g. a component function threw. create() doesn't take the block in that case, so it goes back to the pool.
+    if (block.data != nullptr) {
+      keepOrDeallocate(block);
+    }
+    throw;
+  }
+#endif
+  if (block.data != nullptr) {
+    // The block was too small for this injector.
+    InjectorStorage::deallocate(block);
+  }
+  return injector;
+}
+
+void InjectorPoolStorage::release(std::unique_ptr<InjectorStorage> injector) {
+  // This runs the destructors of the injected objects, so we must not hold `mutex' here: they can run arbitrary code.
+  InjectorStorage::MemoryBlock block = InjectorStorage::destroyKeepingMemory(std::move(injector));
+  keepOrDeallocate(block);
+}
+
+void InjectorPoolStorage::keepOrDeallocate(InjectorStorage::MemoryBlock block) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (idle_blocks.size() < max_idle_injectors) {
+      idle_blocks.push_back(block);
+      return;
+    }
+  }
+  // The pool is full. This doesn't need the lock.
+  InjectorStorage::deallocate(block);
+}
+
+} // namespace impl
+} // namespace fruit
@@ -18,9 +18,13 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <exception>
 #include <fruit/impl/util/type_info.h>
 #include <iostream>
 #include <memory>
+#include <new>
+#include <system_error>
+#include <thread>
 #include <vector>
 
 #include <fruit/impl/component_storage/component_storage.h>
@@ -56,6 +60,9 @@ struct DummyNode {
   Id* getEdgesEnd() {
     return nullptr;
   }
+  bool isLazyEdge(std::size_t) {
+    return false;
+  }
   Value getValue() {
     return Value();
   }
@@ -65,51 +72,384 @@ struct DummyNode {
 
 InjectorStorage::InjectorStorage(ComponentStorage&& component,
                                  const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
-                                 MemoryPool& memory_pool)
+                                 MemoryPool& memory_pool, const InjectorOptions& options)
     : normalized_component_storage_ptr(new NormalizedComponentStorage(
-          std::move(component), exposed_types, memory_pool, NormalizedComponentStorage::WithPermanentCompression())),
-      allocator(normalized_component_storage_ptr->fixed_size_allocator_data),
+          std::move(component), exposed_types, memory_pool, options,
+          NormalizedComponentStorage::WithPermanentCompression())),
+      allocator(normalized_component_storage_ptr->fixed_size_allocator_data, options.memory_resource,
+                options.skip_object_destruction),
       bindings(normalized_component_storage_ptr->bindings, (DummyNode<TypeId, NormalizedBinding>*)nullptr,
                (DummyNode<TypeId, NormalizedBinding>*)nullptr, memory_pool),
-      multibindings(std::move(normalized_component_storage_ptr->multibindings)) {
+      concurrent_construction(options.concurrent_construction) {
+
+  initMultibindings(normalized_component_storage_ptr->multibindings, memory_pool, nullptr /* region */);
+
+  if (concurrent_construction) {
+    allocator.setMutex(&allocator_mutex);
+    bindings.setMutex(&bindings_mutex);
+  }
+
+#if FRUIT_EXTRA_DEBUG
+  bindings.checkFullyConstructed();
+#endif
+}
+
+InjectorStorage::InjectorStorage(
+    const NormalizedComponentStorage& normalized_component,
+    const FixedSizeAllocator::FixedSizeAllocatorData& fixed_size_allocator_data,
+    std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>& new_bindings_vector,
+    const std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings_map, MemoryPool& memory_pool,
+    const InjectorOptions& options, MemoryRegion& region, std::size_t num_node_slots)
+    : base_normalized_component_storage(&normalized_component),
+      allocator(fixed_size_allocator_data, &region, options.skip_object_destruction),
+      bindings(normalized_component.bindings, BindingDataNodeIter{new_bindings_vector.begin()},
+               BindingDataNodeIter{new_bindings_vector.end()}, memory_pool, &region, &normalized_component.node_slots,
+               num_node_slots),
+      concurrent_construction(options.concurrent_construction) {
+
+  initMultibindings(multibindings_map, memory_pool, &region);
+
+  if (concurrent_construction) {
+    allocator.setMutex(&allocator_mutex);
+    bindings.setMutex(&bindings_mutex);
+  }
 
 #if FRUIT_EXTRA_DEBUG
   bindings.checkFullyConstructed();
 #endif
 }
 
-InjectorStorage::InjectorStorage(const NormalizedComponentStorage& normalized_component, ComponentStorage&& component,
-                                 MemoryPool& memory_pool) {
+void InjectorStorage::initMultibindings(const std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings_map,
+                                        MemoryPool& memory_pool, MemoryRegion* region) {
+  using multibindings_map_elem_t = std::pair<const TypeId, NormalizedMultibindingSet>;
+  using sorted_sets_t = std::vector<const multibindings_map_elem_t*, ArenaAllocator<const multibindings_map_elem_t*>>;
+  sorted_sets_t sorted_sets = sorted_sets_t(ArenaAllocator<const multibindings_map_elem_t*>(memory_pool));
+  sorted_sets.reserve(multibindings_map.size());
+  std::size_t num_elems = 0;
+  for (const multibindings_map_elem_t& p : multibindings_map) {
+    sorted_sets.push_back(&p);
+    num_elems += p.second.elems.size();
+  }
+  std::sort(sorted_sets.begin(), sorted_sets.end(),
+            [](const multibindings_map_elem_t* x, const multibindings_map_elem_t* y) { return x->first < y->first; });
 
+  multibindings = FixedSizeVector<MultibindingSet, RegionAllocator<MultibindingSet>>(
+      sorted_sets.size(), RegionAllocator<MultibindingSet>(region));
+  multibinding_elems = FixedSizeVector<NormalizedMultibinding, RegionAllocator<NormalizedMultibinding>>(
+      num_elems, RegionAllocator<NormalizedMultibinding>(region));
+  for (const multibindings_map_elem_t* p : sorted_sets) {
+    MultibindingSet multibinding_set;
+    multibinding_set.type_id = p->first;
+    multibinding_set.elems_begin = multibinding_elems.end();
+    for (const NormalizedMultibinding& multibinding : p->second.elems) {
+      multibinding_elems.push_back(multibinding);
+    }
+    multibinding_set.elems_end = multibinding_elems.end();
+    multibinding_set.get_multibindings_vector = p->second.get_multibindings_vector;
+    multibindings.push_back(std::move(multibinding_set));
+  }
+}
+
+std::size_t InjectorStorage::maximumRequiredSpaceForMultibindings(
+    const std::unordered_map<TypeId, NormalizedMultibindingSet>& multibindings_map) {
+  std::size_t num_elems = 0;
+  for (const auto& p : multibindings_map) {
+    num_elems += p.second.elems.size();
+  }
+  return MemoryRegion::maximumRequiredSpace<MultibindingSet>(multibindings_map.size()) +
+         MemoryRegion::maximumRequiredSpace<NormalizedMultibinding>(num_elems);
+}
+
+namespace {
+// Precedes each InjectorStorage object, in the same chunk of memory (see InjectorStorage::operator new).
+struct alignas(InjectorStorage) MemoryBlockHeader {
+  InjectorStorage::MemoryBlock block;
+};
+
+MemoryBlockHeader* getMemoryBlockHeader(InjectorStorage* injector) {
+  return reinterpret_cast<MemoryBlockHeader*>(injector) - 1;
+}
+
+// Returns a chunk of memory of the specified size, with the alignment required for MemoryBlockHeader.
+// The memory is not initialized: everything allocated from a MemoryRegion is initialized explicitly.
+InjectorStorage::MemoryBlock allocateMemoryBlock(std::size_t size, MemoryResource* memory_resource) {
+  InjectorStorage::MemoryBlock block;
+  block.size = size;
+  block.memory_resource = memory_resource;
+  if (memory_resource == nullptr) {
+    // malloc() returns memory suitably aligned for MemoryBlockHeader.
+    block.data = std::malloc(size);
+  } else {
+    block.data = memory_resource->allocate(size, alignof(MemoryBlockHeader));
+  }
+  if (block.data == nullptr) {
+#if FRUIT_HAS_EXCEPTIONS
+    throw std::bad_alloc();
+#else
+    std::abort(); // LCOV_EXCL_LINE
+#endif
+  }
+  return block;
+}
+} // namespace
+
+std::unique_ptr<InjectorStorage> InjectorStorage::create(const NormalizedComponentStorage& normalized_component,
+                                                         ComponentStorage&& component, MemoryPool& memory_pool,
+                                                         const InjectorOptions& options,
+                                                         MemoryBlock* reusable_block) {
   FixedSizeAllocator::FixedSizeAllocatorData fixed_size_allocator_data;
   using new_bindings_vector_t = std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>;
   new_bindings_vector_t new_bindings_vector = new_bindings_vector_t(ArenaAllocator<ComponentStorageEntry>(memory_pool));
+  std::unordered_map<TypeId, NormalizedMultibindingSet> multibindings;
 
   BindingNormalization::normalizeBindingsAndAddTo(std::move(component).release(), memory_pool, normalized_component,
                                                   fixed_size_allocator_data, new_bindings_vector, multibindings);
 
-  allocator = FixedSizeAllocator(fixed_size_allocator_data);
+  // Space is reserved for the nodes materialized by the injectors destroyed so far, so that injectors created in a loop
+  // (e.g. one per request) usually don't need any other allocation. This is read once since it can grow concurrently.
+  std::size_t num_node_slots = normalized_component.node_slots.size();
 
-  bindings = Graph(normalized_component.bindings, BindingDataNodeIter{new_bindings_vector.begin()},
-                   BindingDataNodeIter{new_bindings_vector.end()}, memory_pool);
-#if FRUIT_EXTRA_DEBUG
-  bindings.checkFullyConstructed();
+  // The memory layout is: the MemoryBlockHeader, the InjectorStorage object, then the MemoryRegion used for its data
+  // structures.
+  std::size_t block_size = sizeof(MemoryBlockHeader) + sizeof(InjectorStorage) +
+                           FixedSizeAllocator::maximumRequiredSpace(fixed_size_allocator_data,
+                                                                    options.skip_object_destruction) +
+                           Graph::maximumRequiredSpaceForOverlay(normalized_component.bindings,
+                                                                 BindingDataNodeIter{new_bindings_vector.begin()},
+                                                                 BindingDataNodeIter{new_bindings_vector.end()},
+                                                                 num_node_slots) +
+                           maximumRequiredSpaceForMultibindings(multibindings);
+
+  MemoryBlock block;
+  bool reused_block = false;
+  if (reusable_block != nullptr && reusable_block->size >= block_size &&
+      reusable_block->memory_resource == options.memory_resource) {
+    // The block is reused as is, without clearing it: the data structures carved out of it only read memory that
+    // they've written.
+    block = *reusable_block;
+    *reusable_block = MemoryBlock();
+    reused_block = true;
+  } else {
+    block = allocateMemoryBlock(block_size, options.memory_resource);
+  }
+
+  char* block_begin = static_cast<char*>(block.data);
+  ::new (block_begin) MemoryBlockHeader{block};
+  char* injector_begin = block_begin + sizeof(MemoryBlockHeader);
+  MemoryRegion region(injector_begin + sizeof(InjectorStorage),
+                      block.size - sizeof(MemoryBlockHeader) - sizeof(InjectorStorage));
+#if FRUIT_HAS_EXCEPTIONS
+  try {
+#endif
+    return std::unique_ptr<InjectorStorage>(::new (injector_begin) InjectorStorage(
+        normalized_component, fixed_size_allocator_data, new_bindings_vector, multibindings, memory_pool, options,
+        region, num_node_slots));
+#if FRUIT_HAS_EXCEPTIONS
+  } catch (...) {
+    // The block is not owned by an InjectorStorage object yet, so it must be handed back or deallocated here.
+    if (reused_block) {
+      *reusable_block = block;
+    } else {
+      deallocate(block);
+    }
+    throw;
+  }
+#endif
+}
+
+InjectorStorage::MemoryBlock InjectorStorage::destroyKeepingMemory(std::unique_ptr<InjectorStorage> injector) {
+  InjectorStorage* injector_ptr = injector.release();
+  MemoryBlock block = getMemoryBlockHeader(injector_ptr)->block;
+  injector_ptr->~InjectorStorage();
+  return block;
+}
+
+void InjectorStorage::deallocate(MemoryBlock block) {
+  if (block.memory_resource == nullptr) {
+    std::free(block.data);
+  } else {
+    block.memory_resource->deallocate(block.data, block.size, alignof(MemoryBlockHeader));
+  }
+}
+
+void* InjectorStorage::operator new(std::size_t size) {
+  MemoryBlock block;
+  block.size = sizeof(MemoryBlockHeader) + size;
+  block.data = std::malloc(block.size);
+  if (block.data == nullptr) {
+#if FRUIT_HAS_EXCEPTIONS
+    throw std::bad_alloc();
+#else
+    std::abort(); // LCOV_EXCL_LINE
 #endif
+  }
+  MemoryBlockHeader* header = ::new (block.data) MemoryBlockHeader{block};
+  return header + 1;
+}
+
+void InjectorStorage::operator delete(void* p) {
+  deallocate(getMemoryBlockHeader(static_cast<InjectorStorage*>(p))->block);
+}
+
+InjectorStorage::~InjectorStorage() {
+  if (base_normalized_component_storage != nullptr) {
+    // So that the next injectors created from the same normalized component find the nodes materialized by this one
+    // by direct indexing.
+    bindings.assignNodeSlots(base_normalized_component_storage->node_slots);
+  }
+}
+
+const void* InjectorStorage::createSharedObject(InjectorStorage& injector, Graph::node_iterator node_itr) {
+  // Only the normalized component's graph uses this create function, so this is an overlay on it.
+  FruitAssert(injector.base_normalized_component_storage != nullptr);
+  const NormalizedComponentStorage& normalized_component = *injector.base_normalized_component_storage;
+  const NormalizedComponentStorage::SharedObjectBinding& shared_object_binding =
+      normalized_component.shared_object_bindings.at(node_itr - injector.bindings.begin());
+
+  InjectorStorage& shared_objects_injector = normalized_component.getSharedObjectsInjector();
+  if (&injector == &shared_objects_injector) {
+    return shared_object_binding.create(injector, node_itr);
+  }
+  return shared_objects_injector.getPtrInternal(shared_objects_injector.bindings.at(shared_object_binding.type_id));
+}
+
+namespace {
+// Constructs the object of a non-terminal node and makes the node terminal.
+void constructNode(InjectorStorage& injector, InjectorStorage::Graph::node_iterator node_itr) {
+  NormalizedBinding normalized_binding = node_itr.getNode();
+  normalized_binding.object = normalized_binding.create(injector, node_itr);
+  // This stores `object' before marking the node as terminal, since get() reads it without locking `mutex' once the
+  // node is terminal.
+  node_itr.setTerminal(normalized_binding);
 }
 
-InjectorStorage::~InjectorStorage() {}
+// Returns true if some non-lazy dependency of the (non-terminal) node is not terminal.
+bool hasDepsToConstruct(InjectorStorage::Graph::node_iterator node_itr,
+                        InjectorStorage::Graph::node_iterator nodes_begin) {
+  for (InjectorStorage::Graph::edge_iterator i = node_itr.neighborsBegin(), end = node_itr.neighborsEnd();
+       !(i == end); ++i) {
+    if (!i.isLazy() && !i.getNodeIterator(nodes_begin).isTerminal()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+struct DepthFirstVisitStackElem {
+  InjectorStorage::Graph::node_iterator node_itr;
+  // The edges of node_itr that have not been visited yet.
+  InjectorStorage::Graph::edge_iterator next_edge;
+  InjectorStorage::Graph::edge_iterator edges_end;
+};
+} // namespace
+
+void InjectorStorage::constructWithDependencies(Graph::node_iterator node_itr) {
+  Graph::node_iterator nodes_begin = bindings.begin();
+  if (!hasDepsToConstruct(node_itr, nodes_begin)) {
+    // The common case, e.g. when the dependencies were injected earlier. No need to allocate anything.
+    constructNode(*this, node_itr);
+    return;
+  }
+
+  // Step 1: a depth-first visit (with an explicit stack) of the non-terminal nodes reachable from node_itr through
+  // non-lazy edges, that lists them in post-order, i.e. each node after its dependencies.
+  // The visited nodes are claimed (see SemistaticGraph::node_iterator::tryClaim()) so that each node is listed once.
+  // Claims are otherwise only used with concurrent_construction, and no other thread can construct objects here since
+  // `mutex' is held.
+  std::vector<DepthFirstVisitStackElem> stack;
+  std::vector<Graph::node_iterator> nodes_to_construct;
+  node_itr.tryClaim();
+  stack.push_back(DepthFirstVisitStackElem{node_itr, node_itr.neighborsBegin(), node_itr.neighborsEnd()});
+  while (!stack.empty()) {
+    DepthFirstVisitStackElem& elem = stack.back();
+    if (elem.next_edge == elem.edges_end) {
+      nodes_to_construct.push_back(elem.node_itr);
+      stack.pop_back();
+      continue;
+    }
+    Graph::edge_iterator edge = elem.next_edge;
+    ++elem.next_edge;
+    if (edge.isLazy()) {
+      // This is injected as a Provider<>, so it must only be constructed if the Provider is used.
+      continue;
+    }
+    Graph::node_iterator dep_itr = edge.getNodeIterator(nodes_begin);
+    if (!dep_itr.isTerminal() && dep_itr.tryClaim()) {
+      // Note that this invalidates `elem'.
+      stack.push_back(DepthFirstVisitStackElem{dep_itr, dep_itr.neighborsBegin(), dep_itr.neighborsEnd()});
+    }
+  }
 
-void InjectorStorage::ensureConstructedMultibinding(NormalizedMultibindingSet& multibinding_set) {
-  for (NormalizedMultibinding& multibinding : multibinding_set.elems) {
-    if (!multibinding.is_constructed) {
-      multibinding.object = multibinding.create(*this);
-      multibinding.is_constructed = true;
+  // Step 2: construct the objects in that order. When each create() function runs its dependencies are already
+  // terminal, so it doesn't construct any other object (unless it uses a Provider<>).
+  for (Graph::node_iterator itr : nodes_to_construct) {
+    itr.unclaim();
+  }
+  for (Graph::node_iterator itr : nodes_to_construct) {
+    // A Provider<> used in a constructor might have already constructed this object.
+    if (!itr.isTerminal()) {
+      constructNode(*this, itr);
+    }
+  }
+}
+
+namespace {
+// Releases the claim on a node if the construction of its object doesn't complete (i.e. if it throws), so that other
+// threads waiting for it can retry.
+struct ClaimedNodeGuard {
+  InjectorStorage::Graph::node_iterator node_itr;
+  std::mutex& construction_mutex;
+  std::condition_variable& construction_finished;
+  bool completed = false;
+
+  ClaimedNodeGuard(InjectorStorage::Graph::node_iterator node_itr, std::mutex& construction_mutex,
+                   std::condition_variable& construction_finished)
+      : node_itr(node_itr), construction_mutex(construction_mutex), construction_finished(construction_finished) {}
+
+  ~ClaimedNodeGuard() {
+    if (!completed) {
+      node_itr.unclaim(); // LCOV_EXCL_LINE
+    }
+    {
+      // This ensures that a thread can't check the node state and then start waiting between our change of the node
+      // state and the notification.
+      std::lock_guard<std::mutex> lock(construction_mutex);
+    }
+    construction_finished.notify_all();
+  }
+};
+} // namespace
+
+void InjectorStorage::constructConcurrently(Graph::node_iterator node_itr) {
+  while (!node_itr.isTerminal()) {
+    if (node_itr.tryClaim()) {
+      // This thread is now the only one that can construct this object.
+      ClaimedNodeGuard guard(node_itr, construction_mutex, construction_finished);
+      NormalizedBinding normalized_binding = node_itr.getNode();
+      // This doesn't deadlock: while constructing this object we only claim (or wait for) nodes reachable from this
+      // one, and a thread that claimed one of those can't be waiting for this node since the graph is acyclic.
+      normalized_binding.object = normalized_binding.create(*this, node_itr);
+      node_itr.setTerminal(normalized_binding);
+      guard.completed = true;
+      return;
+    }
+    // Another thread is constructing this object, wait until it's done.
+    std::unique_lock<std::mutex> lock(construction_mutex);
+    construction_finished.wait(lock, [&node_itr]() { return !node_itr.isClaimed(); });
+  }
+}
+
+void InjectorStorage::ensureConstructedMultibinding(MultibindingSet& multibinding_set) {
+  for (NormalizedMultibinding* p = multibinding_set.elems_begin; p != multibinding_set.elems_end; ++p) {
+    if (!p->is_constructed) {
+      p->object = p->create(*this);
+      p->is_constructed = true;
     }
   }
 }
 
 void* InjectorStorage::getMultibindings(TypeId typeInfo) {
-  NormalizedMultibindingSet* multibinding_set = getNormalizedMultibindingSet(typeInfo);
+  MultibindingSet* multibinding_set = getMultibindingSet(typeInfo);
   if (multibinding_set == nullptr) {
     // Not registered.
     return nullptr;
@@ -119,9 +459,157 @@ void* InjectorStorage::getMultibindings(TypeId typeInfo) {
 
 void InjectorStorage::eagerlyInjectMultibindings() {
   std::lock_guard<std::recursive_mutex> lock(mutex);
-  for (auto& typeInfoInfoPair : multibindings) {
-    typeInfoInfoPair.second.get_multibindings_vector(*this);
+  for (MultibindingSet& multibinding_set : multibindings) {
+    multibinding_set.get_multibindings_vector(*this);
+  }
+}
+
+void InjectorStorage::eagerlyInjectParallel(std::initializer_list<TypeId> exposed_types, std::size_t num_threads) {
+  std::unique_lock<std::recursive_mutex> lock(mutex, std::defer_lock);
+  if (!concurrent_construction) {
+    // Other threads construct objects while holding `mutex' (without claiming nodes), so we hold it until all the
+    // worker threads are done. The objects constructed by the worker threads only need (already constructed)
+    // dependencies, so they never need to lock it.
+    lock.lock();
+    allocator.setMutex(&allocator_mutex);
+    bindings.setMutex(&bindings_mutex);
+  }
+
+  Graph::node_iterator nodes_begin = bindings.begin();
+  std::size_t num_nodes = bindings.end() - nodes_begin;
+
+  // Step 1: find the non-terminal nodes reachable from `exposed_types', and for each of them count the edges to other
+  // non-terminal nodes and record the reverse edges.
+  // A node is "scheduled" if it will be processed by a worker thread below.
+  // All edges count here, including the lazy ones (for types injected through a Provider): so an object is only
+  // constructed after the objects that it can get from its Providers, and then the constructor doesn't need to
+  // construct them itself.
+  std::vector<bool> scheduled(num_nodes, false);
+  std::vector<std::size_t> num_pending_deps(num_nodes, 0);
+  std::vector<std::vector<Graph::node_iterator>> dependents(num_nodes);
+  std::vector<Graph::node_iterator> ready_nodes;
+  std::vector<Graph::node_iterator> nodes_to_visit;
+  std::size_t num_scheduled_nodes = 0;
+
+  for (TypeId type : exposed_types) {
+    Graph::node_iterator node_itr = bindings.at(type);
+    if (!node_itr.isTerminal() && !scheduled[node_itr - nodes_begin]) {
+      scheduled[node_itr - nodes_begin] = true;
+      nodes_to_visit.push_back(node_itr);
+    }
+  }
+  while (!nodes_to_visit.empty()) {
+    Graph::node_iterator node_itr = nodes_to_visit.back();
+    nodes_to_visit.pop_back();
+    ++num_scheduled_nodes;
+    std::size_t& node_num_pending_deps = num_pending_deps[node_itr - nodes_begin];
+    for (Graph::edge_iterator i = node_itr.neighborsBegin(), end = node_itr.neighborsEnd(); !(i == end); ++i) {
+      Graph::node_iterator dep_itr = i.getNodeIterator(nodes_begin);
+      if (dep_itr.isTerminal()) {
+        continue;
+      }
+      ++node_num_pending_deps;
+      dependents[dep_itr - nodes_begin].push_back(node_itr);
+      if (!scheduled[dep_itr - nodes_begin]) {
+        scheduled[dep_itr - nodes_begin] = true;
+        nodes_to_visit.push_back(dep_itr);
+      }
+    }
+    if (node_num_pending_deps == 0) {
+      ready_nodes.push_back(node_itr);
+    }
+  }
+
+  // Step 2: construct the scheduled nodes, each one as soon as all its dependencies have been constructed.
+  // ready_nodes, num_pending_deps, num_scheduled_nodes, stopped and exception are guarded by queue_mutex.
+  std::mutex queue_mutex;
+  std::condition_variable queue_changed;
+  // Set when a constructor throws: then the workers don't start any other construction.
+  bool stopped = false;
+#if FRUIT_HAS_EXCEPTIONS
+  // The first exception thrown by a constructor, rethrown in this thread once all the workers are done.
+  std::exception_ptr exception;
+#endif
+  auto worker = [&]() {
+    std::unique_lock<std::mutex> queue_lock(queue_mutex);
+    while (true) {
+      queue_changed.wait(queue_lock, [&]() { return stopped || !ready_nodes.empty() || num_scheduled_nodes == 0; });
+      if (stopped || ready_nodes.empty()) {
+        // All the scheduled nodes have been constructed, or a constructor threw.
+        return;
+      }
+      Graph::node_iterator node_itr = ready_nodes.back();
+      ready_nodes.pop_back();
+      queue_lock.unlock();
+
+      // If another thread is constructing the same object (this can only happen with concurrent_construction), this
+      // waits for it to finish instead.
+#if FRUIT_HAS_EXCEPTIONS
+      try {
+        constructConcurrently(node_itr);
+      } catch (...) {
+        // The nodes that depend on this one will never be ready, so the other workers would wait forever if they
+        // weren't stopped.
+        queue_lock.lock();
+        if (!exception) {
+          exception = std::current_exception();
+        }
+        stopped = true;
+        queue_changed.notify_all();
+        return;
+      }
+#else
+      constructConcurrently(node_itr);
+#endif
+
+      queue_lock.lock();
+      --num_scheduled_nodes;
+      for (Graph::node_iterator dependent_itr : dependents[node_itr - nodes_begin]) {
+        if (--num_pending_deps[dependent_itr - nodes_begin] == 0) {
+          ready_nodes.push_back(dependent_itr);
+        }
+      }
+      queue_changed.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+#if FRUIT_HAS_EXCEPTIONS
+  try {
+#endif
+    for (std::size_t i = 1; i < num_threads; ++i) {
+      threads.emplace_back(worker);
+    }
+#if FRUIT_HAS_EXCEPTIONS
+  } catch (const std::system_error&) {
+    // A thread couldn't be started. The ones already started (and this one) still construct all the objects.
+  }
+#endif
+  worker();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  if (!concurrent_construction) {
+    allocator.setMutex(nullptr);
+    bindings.setMutex(nullptr);
+  }
+
+#if FRUIT_HAS_EXCEPTIONS
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+#endif
+
+  eagerlyInjectMultibindings();
+}
+
+std::size_t InjectorStorage::getNumRemovedUnreachableBindings() const {
+  if (normalized_component_storage_ptr == nullptr) {
+    // This injector was created from a NormalizedComponent.
+    return 0;
   }
+  return normalized_component_storage_ptr->getNumRemovedUnreachableBindings();
 }
 
 } // namespace impl
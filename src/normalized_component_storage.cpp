@@ -39,7 +39,8 @@ namespace impl {
 
 NormalizedComponentStorage::NormalizedComponentStorage(ComponentStorage&& component,
                                                        const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
-                                                       MemoryPool& memory_pool, WithPermanentCompression)
+                                                       MemoryPool& memory_pool, const InjectorOptions& options,
+                                                       WithPermanentCompression)
     : normalized_component_memory_pool(),
       binding_compression_info_map(createHashMapWithArenaAllocator<TypeId, CompressedBindingUndoInfo>(
           0 /* capacity */, normalized_component_memory_pool)),
@@ -54,9 +55,12 @@ NormalizedComponentStorage::NormalizedComponentStorage(ComponentStorage&& compon
 
   using bindings_vector_t = std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>;
   bindings_vector_t bindings_vector = bindings_vector_t(ArenaAllocator<ComponentStorageEntry>(memory_pool));
-  BindingNormalization::normalizeBindingsWithPermanentBindingCompression(std::move(component).release(),
-                                                                         fixed_size_allocator_data, memory_pool,
-                                                                         exposed_types, bindings_vector, multibindings);
+  BindingNormalization::normalizeBindingsWithPermanentBindingCompression(
+      std::move(component).release(), fixed_size_allocator_data, memory_pool, exposed_types, bindings_vector,
+      multibindings, options.num_normalization_threads,
+      options.use_component_expansion_cache ? &ComponentExpansionCache::getInstance() : nullptr,
+      options.lazy_normalization, options.strict_lazy_normalization,
+      options.remove_unreachable_bindings ? &num_removed_unreachable_bindings : nullptr);
 
   bindings = SemistaticGraph<TypeId, NormalizedBinding>(InjectorStorage::BindingDataNodeIter{bindings_vector.begin()},
                                                         InjectorStorage::BindingDataNodeIter{bindings_vector.end()},
@@ -65,7 +69,9 @@ NormalizedComponentStorage::NormalizedComponentStorage(ComponentStorage&& compon
 
 NormalizedComponentStorage::NormalizedComponentStorage(ComponentStorage&& component,
                                                        const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
-                                                       MemoryPool& memory_pool, WithUndoableCompression)
+                                                       MemoryPool& memory_pool,
+                                                       const NormalizedComponentOptions& options,
+                                                       WithUndoableCompression)
     : normalized_component_memory_pool(),
       binding_compression_info_map(createHashMapWithArenaAllocator<TypeId, CompressedBindingUndoInfo>(
           20 /* capacity */, normalized_component_memory_pool)),
@@ -76,22 +82,52 @@ NormalizedComponentStorage::NormalizedComponentStorage(ComponentStorage&& compon
       component_with_no_args_replacements(
           createLazyComponentWithNoArgsReplacementMap(20 /* capacity */, normalized_component_memory_pool)),
       component_with_args_replacements(
-          createLazyComponentWithArgsReplacementMap(20 /* capacity */, normalized_component_memory_pool)) {
+          createLazyComponentWithArgsReplacementMap(20 /* capacity */, normalized_component_memory_pool)),
+      shared_objects_memory_resource(options.memory_resource) {
 
   using bindings_vector_t = std::vector<ComponentStorageEntry, ArenaAllocator<ComponentStorageEntry>>;
   bindings_vector_t bindings_vector = bindings_vector_t(ArenaAllocator<ComponentStorageEntry>(memory_pool));
+  std::vector<TypeId, ArenaAllocator<TypeId>> types_shared_across_injectors =
+      std::vector<TypeId, ArenaAllocator<TypeId>>(ArenaAllocator<TypeId>(memory_pool));
   BindingNormalization::normalizeBindingsWithUndoableBindingCompression(
       std::move(component).release(), fixed_size_allocator_data, memory_pool, normalized_component_memory_pool,
-      normalized_component_memory_pool, exposed_types, bindings_vector, multibindings, binding_compression_info_map,
-      fully_expanded_components_with_no_args, fully_expanded_components_with_args, component_with_no_args_replacements,
-      component_with_args_replacements);
+      normalized_component_memory_pool, exposed_types, bindings_vector, multibindings, types_shared_across_injectors,
+      binding_compression_info_map, fully_expanded_components_with_no_args, fully_expanded_components_with_args,
+      component_with_no_args_replacements, component_with_args_replacements, options.num_normalization_threads,
+      options.use_component_expansion_cache ? &ComponentExpansionCache::getInstance() : nullptr);
+
+  // The objects shared across injectors are constructed by createSharedObject(), that then uses the original binding.
+  HashSetWithArenaAllocator<TypeId> types_shared_across_injectors_set =
+      createHashSetWithArenaAllocator<TypeId>(types_shared_across_injectors.size(), memory_pool);
+  types_shared_across_injectors_set.insert(types_shared_across_injectors.begin(), types_shared_across_injectors.end());
+  std::vector<SharedObjectBinding, ArenaAllocator<SharedObjectBinding>> shared_object_bindings_vector =
+      std::vector<SharedObjectBinding, ArenaAllocator<SharedObjectBinding>>(
+          ArenaAllocator<SharedObjectBinding>(memory_pool));
+  for (ComponentStorageEntry& entry : bindings_vector) {
+    if (entry.kind != ComponentStorageEntry::Kind::BINDING_FOR_CONSTRUCTED_OBJECT &&
+        types_shared_across_injectors_set.count(entry.type_id) != 0) {
+      shared_object_bindings_vector.push_back(
+          SharedObjectBinding{entry.type_id, entry.binding_for_object_to_construct.create});
+      entry.binding_for_object_to_construct.create = InjectorStorage::createSharedObject;
+    }
+  }
 
+  SemistaticMapHashOptions hash_options;
+  hash_options.deterministic = options.deterministic_hashing;
+  hash_options.preferred_multiplier = options.hash_function_multiplier;
   bindings = SemistaticGraph<TypeId, NormalizedBinding>(InjectorStorage::BindingDataNodeIter{bindings_vector.begin()},
                                                         InjectorStorage::BindingDataNodeIter{bindings_vector.end()},
-                                                        memory_pool);
+                                                        memory_pool, hash_options);
+
+  for (const SharedObjectBinding& shared_object_binding : shared_object_bindings_vector) {
+    shared_object_bindings[bindings.at(shared_object_binding.type_id) - bindings.begin()] = shared_object_binding;
+  }
 }
 
 NormalizedComponentStorage::~NormalizedComponentStorage() noexcept {
+  // This must be destroyed before `bindings', since it's an overlay on it.
+  shared_objects_injector.reset();
+
   for (auto& x : fully_expanded_components_with_args) {
     x.destroy();
   }
@@ -121,6 +157,19 @@ NormalizedComponentStorage::~NormalizedComponentStorage() noexcept {
       createLazyComponentWithArgsReplacementMap(0 /* capacity */, normalized_component_memory_pool);
 }
 
+InjectorStorage& NormalizedComponentStorage::getSharedObjectsInjector() const {
+  std::lock_guard<std::mutex> lock(shared_objects_injector_mutex);
+  if (shared_objects_injector == nullptr) {
+    MemoryPool memory_pool;
+    InjectorOptions options;
+    // Different injectors created from this normalized component might need the same shared object concurrently.
+    options.concurrent_construction = true;
+    options.memory_resource = shared_objects_memory_resource;
+    shared_objects_injector = InjectorStorage::create(*this, ComponentStorage(), memory_pool, options);
+  }
+  return *shared_objects_injector;
+}
+
 } // namespace impl
 // We need a LCOV_EXCL_BR_LINE below because for some reason gcov/lcov think there's a branch there.
 } // namespace fruit LCOV_EXCL_BR_LINE
@@ -24,8 +24,8 @@ namespace impl {
 
 NormalizedComponentStorageHolder::NormalizedComponentStorageHolder(
     ComponentStorage&& component, const std::vector<TypeId, ArenaAllocator<TypeId>>& exposed_types,
-    MemoryPool& memory_pool, WithUndoableCompression)
-    : storage(new NormalizedComponentStorage(std::move(component), exposed_types, memory_pool,
+    MemoryPool& memory_pool, const NormalizedComponentOptions& options, WithUndoableCompression)
+    : storage(new NormalizedComponentStorage(std::move(component), exposed_types, memory_pool, options,
                                              NormalizedComponentStorage::WithUndoableCompression())) {}
 
 NormalizedComponentStorageHolder::~NormalizedComponentStorageHolder() noexcept {
@@ -35,5 +35,13 @@ NormalizedComponentStorageHolder::~NormalizedComponentStorageHolder() noexcept {
     }
 }
 
+std::uintptr_t NormalizedComponentStorageHolder::getHashFunctionMultiplier() const {
+  return storage->getHashFunctionMultiplier();
+}
+
+std::size_t NormalizedComponentStorageHolder::getNumHashFunctionRetries() const {
+  return storage->getNumHashFunctionRetries();
+}
+
 } // namespace impl
 } // namespace fruit
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE 1
+
+#include <fruit/impl/normalized_component_storage/parallel_component_expander.h>
+
+#include <new>
+#include <system_error>
+#include <thread>
+
+namespace fruit {
+namespace impl {
+
+ParallelComponentExpander::ParallelComponentExpander(const ComponentStorageEntry* first,
+                                                     const ComponentStorageEntry* last, std::size_t num_threads,
+                                                     ComponentExpansionCache* component_expansion_cache)
+    : memory_pools(num_threads == 0 ? 1 : num_threads), component_expansion_cache(component_expansion_cache) {
+  // No other threads are running yet, but addComponentsToExpand() expects the mutex to be locked.
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    addComponentsToExpand(first, last);
+  }
+
+  std::vector<std::thread> threads;
+#if FRUIT_HAS_EXCEPTIONS
+  try {
+#endif
+    for (std::size_t i = 1; i < memory_pools.size(); ++i) {
+      MemoryPool& memory_pool = memory_pools[i];
+      threads.emplace_back([this, &memory_pool]() { expandComponents(memory_pool); });
+    }
+#if FRUIT_HAS_EXCEPTIONS
+  } catch (const std::system_error&) {
+    // A thread couldn't be started. The ones already started (and this one) still expand all the components.
+  }
+#endif
+  expandComponents(memory_pools[0]);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+#if FRUIT_HAS_EXCEPTIONS
+  if (exception) {
+    // The destructor won't run, since the constructor didn't complete.
+    destroyEntries();
+    std::rethrow_exception(exception);
+  }
+#endif
+
+  FruitAssert(components_to_expand.empty());
+  FruitAssert(num_components_being_expanded == 0);
+}
+
+ParallelComponentExpander::~ParallelComponentExpander() {
+  destroyEntries();
+}
+
+void ParallelComponentExpander::destroyEntries() {
+  // The entries that were not taken are still owned by this object.
+  for (const auto& pair : expansions_with_no_args) {
+    if (pair.second != nullptr) {
+      for (const ComponentStorageEntry& entry : *pair.second) {
+        entry.destroy();
+      }
+    }
+  }
+  for (const auto& pair : expansions_with_args) {
+    if (pair.second != nullptr) {
+      for (const ComponentStorageEntry& entry : *pair.second) {
+        entry.destroy();
+      }
+    }
+    pair.first.destroy();
+  }
+  // The entry_vector_t objects are allocated in memory_pools, and their elements too, so there's no need to destroy
+  // them.
+}
+
+bool ParallelComponentExpander::takeBindings(const LazyComponentWithNoArgs& component, entry_vector_t& entries) {
+  auto itr = expansions_with_no_args.find(component);
+  if (itr == expansions_with_no_args.end() || itr->second == nullptr) {
+    return false;
+  }
+  entries.insert(entries.end(), itr->second->begin(), itr->second->end());
+  itr->second = nullptr;
+  return true;
+}
+
+bool ParallelComponentExpander::takeBindings(const LazyComponentWithArgs& component, entry_vector_t& entries) {
+  auto itr = expansions_with_args.find(component);
+  if (itr == expansions_with_args.end() || itr->second == nullptr) {
+    return false;
+  }
+  entries.insert(entries.end(), itr->second->begin(), itr->second->end());
+  itr->second = nullptr;
+  return true;
+}
+
+void ParallelComponentExpander::addComponentsToExpand(const ComponentStorageEntry* first,
+                                                      const ComponentStorageEntry* last) {
+  for (const ComponentStorageEntry* itr = first; itr != last; ++itr) {
+    const ComponentStorageEntry& entry = *itr;
+    switch (entry.kind) {
+    case ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_NO_ARGS:
+      if (expansions_with_no_args.emplace(entry.lazy_component_with_no_args, nullptr).second) {
+        components_to_expand.push_back(entry);
+      }
+      break;
+
+    case ComponentStorageEntry::Kind::REPLACED_LAZY_COMPONENT_WITH_NO_ARGS:
+      // This component will (most likely) be replaced, so there's no point in expanding it.
+      expansions_with_no_args.emplace(entry.lazy_component_with_no_args, nullptr);
+      break;
+
+    case ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_ARGS:
+      if (expansions_with_args.count(entry.lazy_component_with_args) == 0) {
+        LazyComponentWithArgs component = entry.lazy_component_with_args.copy();
+        expansions_with_args.emplace(component, nullptr);
+        ComponentStorageEntry entry_to_expand = entry;
+        entry_to_expand.lazy_component_with_args = component;
+        components_to_expand.push_back(entry_to_expand);
+      }
+      break;
+
+    case ComponentStorageEntry::Kind::REPLACED_LAZY_COMPONENT_WITH_ARGS:
+      // This component will (most likely) be replaced, so there's no point in expanding it.
+      if (expansions_with_args.count(entry.lazy_component_with_args) == 0) {
+        expansions_with_args.emplace(entry.lazy_component_with_args.copy(), nullptr);
+      }
+      break;
+
+    default:
+      break;
+    }
+  }
+}
+
+ParallelComponentExpander::entry_vector_t*
+ParallelComponentExpander::expandComponent(const ComponentStorageEntry& component_entry, MemoryPool& memory_pool) {
+  entry_vector_t* entries = new (memory_pool.allocate<entry_vector_t>(1))
+      entry_vector_t(ArenaAllocator<ComponentStorageEntry>(memory_pool));
+  if (component_entry.kind == ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_NO_ARGS) {
+    if (component_expansion_cache != nullptr) {
+      component_expansion_cache->addBindings(component_entry.lazy_component_with_no_args, *entries);
+    } else {
+      component_entry.lazy_component_with_no_args.addBindings(*entries);
+    }
+  } else {
+    FruitAssert(component_entry.kind == ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_ARGS);
+    if (component_expansion_cache != nullptr) {
+      component_expansion_cache->addBindings(component_entry.lazy_component_with_args, *entries);
+    } else {
+      component_entry.lazy_component_with_args.component->addBindings(*entries);
+    }
+  }
+  return entries;
+}
+
+void ParallelComponentExpander::expandComponents(MemoryPool& memory_pool) {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    components_to_expand_changed.wait(
+        lock, [this]() { return stopped || !components_to_expand.empty() || num_components_being_expanded == 0; });
+    if (stopped || components_to_expand.empty()) {
+      // All the reachable components have been expanded, or a component function threw.
+      return;
+    }
+    ComponentStorageEntry component_entry = components_to_expand.back();
+    components_to_expand.pop_back();
+    ++num_components_being_expanded;
+    lock.unlock();
+
+#if FRUIT_HAS_EXCEPTIONS
+    entry_vector_t* entries;
+    try {
+      entries = expandComponent(component_entry, memory_pool);
+    } catch (...) {
+      // The other threads can't wait for this component's expansion to complete, so they must stop.
+      lock.lock();
+      if (!exception) {
+        exception = std::current_exception();
+      }
+      stopped = true;
+      --num_components_being_expanded;
+      components_to_expand_changed.notify_all();
+      return;
+    }
+#else
+    entry_vector_t* entries = expandComponent(component_entry, memory_pool);
+#endif
+
+    lock.lock();
+    if (component_entry.kind == ComponentStorageEntry::Kind::LAZY_COMPONENT_WITH_NO_ARGS) {
+      expansions_with_no_args[component_entry.lazy_component_with_no_args] = entries;
+    } else {
+      expansions_with_args[component_entry.lazy_component_with_args] = entries;
+    }
+    addComponentsToExpand(entries->data(), entries->data() + entries->size());
+    --num_components_being_expanded;
+    components_to_expand_changed.notify_all();
+  }
+}
+
+} // namespace impl
+} // namespace fruit
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2014 Google Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define IN_FRUIT_CPP_FILE 1
+
+#include <fruit/impl/util/type_info.h>
+
+#include <fruit/impl/util/atomic_helpers.h>
+
+namespace fruit {
+namespace impl {
+
+std::atomic<std::size_t> TypeInfo::last_dense_index(0);
+
+std::size_t TypeInfo::getOrAssignDenseIndex() const {
+  std::size_t index = atomicLoadRelaxed(&dense_index);
+  if (index != 0) {
+    return index;
+  }
+  std::size_t new_index = last_dense_index.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (atomicCompareExchange(&dense_index, 0, new_index)) {
+    return new_index;
+  }
+  // Another thread assigned an index to this type in the meantime. new_index is simply not used.
+  return atomicLoadRelaxed(&dense_index); // LCOV_EXCL_LINE
+}
+
+} // namespace impl
+} // namespace fruit
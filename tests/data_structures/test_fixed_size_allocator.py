@@ -168,6 +168,52 @@ class TestFixedSizeAllocator(parameterized.TestCase):
             source,
             locals())
 
+    def test_objects_are_packed(self):
+        source = '''
+            // Checks that the storage has the size of the objects, plus the padding needed to align the first one.
+            struct CheckingMemoryResource : public fruit::MemoryResource {
+              void* allocate(std::size_t bytes, std::size_t) override {
+                Assert(bytes == 2 * 8 + 2 * 2 + 3 * 1 + (8 - 1));
+                return std::malloc(bytes);
+              }
+
+              void deallocate(void* p, std::size_t, std::size_t) override {
+                std::free(p);
+              }
+            };
+
+            int main() {
+              FixedSizeAllocator::FixedSizeAllocatorData allocator_data;
+              allocator_data.addType(getTypeId<TypeWithAlignment<1>>());
+              allocator_data.addType(getTypeId<TypeWithAlignment<8>>());
+              allocator_data.addType(getTypeId<TypeWithAlignment<2>>());
+              allocator_data.addType(getTypeId<TypeWithAlignment<1>>());
+              allocator_data.addType(getTypeId<TypeWithAlignment<2>>());
+              allocator_data.addType(getTypeId<TypeWithAlignment<8>>());
+              allocator_data.addType(getTypeId<TypeWithAlignment<1>>());
+              CheckingMemoryResource memory_resource;
+              FixedSizeAllocator allocator(allocator_data, &memory_resource);
+              // Objects with the same alignment are adjacent, regardless of the construction order.
+              char* a1 = reinterpret_cast<char*>(allocator.constructObject<TypeWithAlignment<1>>());
+              char* a8 = reinterpret_cast<char*>(allocator.constructObject<TypeWithAlignment<8>>());
+              char* a2 = reinterpret_cast<char*>(allocator.constructObject<TypeWithAlignment<2>>());
+              char* b8 = reinterpret_cast<char*>(allocator.constructObject<TypeWithAlignment<8>>());
+              char* b1 = reinterpret_cast<char*>(allocator.constructObject<TypeWithAlignment<1>>());
+              char* b2 = reinterpret_cast<char*>(allocator.constructObject<TypeWithAlignment<2>>());
+              char* c1 = reinterpret_cast<char*>(allocator.constructObject<TypeWithAlignment<1>>());
+              Assert(b8 == a8 + 8);
+              Assert(a2 == b8 + 8);
+              Assert(b2 == a2 + 2);
+              Assert(a1 == b2 + 2);
+              Assert(b1 == a1 + 1);
+              Assert(c1 == b1 + 1);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
     def test_move_constructor(self):
         source = '''
             int main() {
@@ -242,6 +242,43 @@ class TestSemistaticGraph(parameterized.TestCase):
             source,
             locals())
 
+    def test_neighbors_end(self):
+        source = '''
+            int main() {
+              MemoryPool memory_pool;
+              vector<int> neighbors = {2, 4};
+              vector<SimpleNode> old_values{{2, "foo", &no_neighbors, false}, {3, "bar", &neighbors, false},
+                                            {4, "baz", &no_neighbors, true}};
+
+              Graph old_graph(old_values.begin(), old_values.end(), memory_pool);
+              vector<int> new_neighbors = {2, 3, 4};
+              vector<SimpleNode> new_values{{5, "qux", &new_neighbors, false}};
+
+              Graph graph(old_graph, new_values.begin(), new_values.end(), memory_pool);
+              Assert(graph.at(2).neighborsBegin() == graph.at(2).neighborsEnd());
+
+              edge_iterator itr = graph.at(3).neighborsBegin();
+              Assert(itr.getNodeIterator(graph.begin()).getNode() == string("foo"));
+              ++itr;
+              Assert(itr.getNodeIterator(graph.begin()).getNode() == string("baz"));
+              ++itr;
+              Assert(itr == graph.at(3).neighborsEnd());
+
+              std::size_t num_neighbors = 0;
+              for (edge_iterator i = graph.at(5).neighborsBegin(); !(i == graph.at(5).neighborsEnd()); ++i) {
+                node_iterator neighbor = i.getNodeIterator(graph.begin());
+                Assert(0 <= neighbor - graph.begin());
+                Assert(neighbor - graph.begin() < graph.end() - graph.begin());
+                ++num_neighbors;
+              }
+              Assert(num_neighbors == 3);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
     def test_set_terminal(self):
         source = '''
             int main() {
@@ -274,6 +311,264 @@ class TestSemistaticGraph(parameterized.TestCase):
             source,
             locals())
 
+    def test_set_terminal_in_overlay_graph(self):
+        source = '''
+            int main() {
+              MemoryPool memory_pool;
+              vector<int> neighbors = {2, 4};
+              vector<SimpleNode> old_values{{2, "foo", &no_neighbors, false}, {3, "bar", &neighbors, false},
+                                            {4, "baz", &no_neighbors, true}};
+
+              Graph old_graph(old_values.begin(), old_values.end(), memory_pool);
+              vector<SimpleNode> new_values{{5, "qux", &neighbors, false}};
+
+              Graph graph(old_graph, new_values.begin(), new_values.end(), memory_pool);
+              graph.find(3).setTerminal();
+              graph.find(2).setTerminal("foo2");
+              Assert(graph.at(2).getNode() == string("foo2"));
+              Assert(graph.at(2).isTerminal() == true);
+              Assert(graph.at(3).getNode() == string("bar"));
+              Assert(graph.at(3).isTerminal() == true);
+              Assert(graph.at(4).getNode() == string("baz"));
+              Assert(graph.at(4).isTerminal() == true);
+              Assert(graph.at(5).getNode() == string("qux"));
+              Assert(graph.at(5).isTerminal() == false);
+              edge_iterator itr = graph.at(5).neighborsBegin();
+              Assert(itr.getNodeIterator(graph.begin()).getNode() == string("foo2"));
+              Assert(itr.getNodeIterator(graph.begin()).isTerminal() == true);
+
+              // The base graph is unchanged.
+              Assert(old_graph.at(2).getNode() == string("foo"));
+              Assert(old_graph.at(2).isTerminal() == false);
+              Assert(old_graph.at(3).getNode() == string("bar"));
+              Assert(old_graph.at(3).isTerminal() == false);
+              Assert(old_graph.find(5) == old_graph.end());
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_overlay_graph_in_memory_region(self):
+        source = '''
+            int main() {
+              MemoryPool memory_pool;
+              vector<int> neighbors = {2, 4};
+              vector<SimpleNode> old_values{{2, "foo", &no_neighbors, false}, {3, "bar", &neighbors, false},
+                                            {4, "baz", &no_neighbors, true}};
+
+              Graph old_graph(old_values.begin(), old_values.end(), memory_pool);
+              vector<int> new_neighbors = {3, 6};
+              vector<SimpleNode> new_values{{5, "qux", &new_neighbors, false}, {6, "quux", &no_neighbors, true}};
+
+              std::size_t size = Graph::maximumRequiredSpaceForOverlay(old_graph, new_values.begin(), new_values.end());
+              char* memory = static_cast<char*>(calloc(size, 1));
+              {
+                MemoryRegion region(memory, size);
+                Graph graph(old_graph, new_values.begin(), new_values.end(), memory_pool, &region);
+                graph.find(3).setTerminal();
+                Assert(graph.at(2).getNode() == string("foo"));
+                Assert(graph.at(2).isTerminal() == false);
+                Assert(graph.at(3).getNode() == string("bar"));
+                Assert(graph.at(3).isTerminal() == true);
+                Assert(graph.at(5).getNode() == string("qux"));
+                Assert(graph.at(5).isTerminal() == false);
+                Assert(graph.at(6).getNode() == string("quux"));
+                Assert(graph.at(6).isTerminal() == true);
+                edge_iterator itr = graph.at(5).neighborsBegin();
+                Assert(itr.getNodeIterator(graph.begin()).getNode() == string("bar"));
+                ++itr;
+                Assert(itr.getNodeIterator(graph.begin()).getNode() == string("quux"));
+                Assert(old_graph.at(3).isTerminal() == false);
+
+                // The memory of the graph is in the region.
+                const char* p = reinterpret_cast<const char*>(&graph.at(5).getNode());
+                Assert(memory <= p && p < memory + size);
+              }
+              free(memory);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_overlay_graph_memory_does_not_depend_on_base_graph_size(self):
+        source = '''
+            int main() {
+              MemoryPool memory_pool;
+              const std::size_t num_old_nodes = 10000;
+              vector<SimpleNode> old_values;
+              for (std::size_t i = 0; i < num_old_nodes; i++) {
+                old_values.push_back(SimpleNode{int(i), "foo", &no_neighbors, false});
+              }
+              Graph old_graph(old_values.begin(), old_values.end(), memory_pool);
+              vector<SimpleNode> new_values{{-1, "bar", &no_neighbors, true}};
+
+              std::size_t size = Graph::maximumRequiredSpaceForOverlay(old_graph, new_values.begin(), new_values.end());
+              Assert(size < 1000);
+              char* memory = static_cast<char*>(malloc(size));
+              {
+                MemoryRegion region(memory, size);
+                Graph graph(old_graph, new_values.begin(), new_values.end(), memory_pool, &region);
+                Assert(graph.getNumMaterializedNodes() == 0);
+                Assert(graph.at(-1).getNode() == string("bar"));
+                Assert(graph.at(7).isTerminal() == false);
+                Assert(graph.at(7).isClaimed() == false);
+                Assert(graph.getNumMaterializedNodes() == 0);
+
+                // More nodes than the space reserved in the region, so further space is allocated.
+                for (std::size_t i = 0; i < 1000; i++) {
+                  Assert(graph.at(i).tryClaim());
+                  Assert(graph.at(i).isClaimed());
+                }
+                for (std::size_t i = 0; i < 1000; i += 2) {
+                  graph.at(i).setTerminal("baz");
+                }
+                Assert(graph.getNumMaterializedNodes() == 1000);
+                for (std::size_t i = 0; i < 1000; i++) {
+                  Assert(graph.at(i).isTerminal() == (i % 2 == 0));
+                  Assert(graph.at(i).isClaimed() == (i % 2 != 0));
+                  Assert(graph.at(i).getNode() == string(i % 2 == 0 ? "baz" : "foo"));
+                }
+                Assert(graph.at(1000).isTerminal() == false);
+                Assert(graph.at(1000).isClaimed() == false);
+                Assert(old_graph.at(0).isTerminal() == false);
+                Assert(old_graph.at(0).getNode() == string("foo"));
+
+                // With node slots, space for the materialized nodes is reserved in the region.
+                std::size_t size_with_slots =
+                    Graph::maximumRequiredSpaceForOverlay(old_graph, new_values.begin(), new_values.end(), 1000);
+                Assert(size_with_slots > size + 1000 * sizeof(const char*));
+              }
+              free(memory);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_overlay_graph_with_node_slots(self):
+        source = '''
+            int main() {
+              MemoryPool memory_pool;
+              const std::size_t num_old_nodes = 100;
+              vector<SimpleNode> old_values;
+              for (std::size_t i = 0; i < num_old_nodes; i++) {
+                old_values.push_back(SimpleNode{int(i), "foo", &no_neighbors, false});
+              }
+              Graph old_graph(old_values.begin(), old_values.end(), memory_pool);
+              vector<SimpleNode> new_values{{-1, "bar", &no_neighbors, true}};
+              Graph::NodeSlots node_slots;
+              Assert(node_slots.size() == 0);
+
+              {
+                Graph graph(old_graph, new_values.begin(), new_values.end(), memory_pool, nullptr, &node_slots,
+                            node_slots.size());
+                for (std::size_t i = 0; i < 10; i++) {
+                  graph.at(i).setTerminal("baz");
+                }
+                graph.assignNodeSlots(node_slots);
+                Assert(node_slots.size() == 10);
+              }
+
+              // Nodes 0-9 have a slot, so they're materialized in the region.
+              std::size_t num_node_slots = node_slots.size();
+              std::size_t size = Graph::maximumRequiredSpaceForOverlay(old_graph, new_values.begin(), new_values.end(),
+                                                                       num_node_slots);
+              char* memory = static_cast<char*>(malloc(size));
+              {
+                MemoryRegion region(memory, size);
+                Graph graph(old_graph, new_values.begin(), new_values.end(), memory_pool, &region, &node_slots,
+                            num_node_slots);
+                for (std::size_t i = 0; i < 20; i++) {
+                  Assert(graph.at(i).isTerminal() == false);
+                  Assert(graph.at(i).getNode() == string("foo"));
+                }
+                Assert(graph.getNumMaterializedNodes() == 0);
+                for (std::size_t i = 0; i < 20; i += 2) {
+                  graph.at(i).setTerminal("qux");
+                }
+                Assert(graph.at(5).tryClaim());
+                Assert(graph.getNumMaterializedNodes() == 11);
+                for (std::size_t i = 0; i < 10; i += 2) {
+                  const char* p = reinterpret_cast<const char*>(&graph.at(i).getNode());
+                  Assert(memory <= p && p < memory + size);
+                }
+
+                // A third overlay, created before the slots of nodes 10-19 are assigned.
+                Graph graph2(old_graph, new_values.begin(), new_values.end(), memory_pool, nullptr, &node_slots,
+                             node_slots.size());
+                graph.assignNodeSlots(node_slots);
+                Assert(node_slots.size() == 15);
+                for (std::size_t i = 0; i < 20; i++) {
+                  Assert(graph.at(i).isTerminal() == (i % 2 == 0));
+                  Assert(graph.at(i).isClaimed() == (i == 5));
+                  Assert(graph.at(i).getNode() == string(i % 2 == 0 ? "qux" : "foo"));
+                }
+
+                // Nodes 10-19 are materialized in the hash table of graph2, even if they now have a slot.
+                for (std::size_t i = 0; i < 20; i++) {
+                  graph2.at(i).setTerminal("quux");
+                }
+                Assert(graph2.getNumMaterializedNodes() == 20);
+                for (std::size_t i = 0; i < 20; i++) {
+                  Assert(graph2.at(i).isTerminal() == true);
+                  Assert(graph2.at(i).getNode() == string("quux"));
+                  Assert(graph.at(i).getNode() == string(i % 2 == 0 ? "qux" : "foo"));
+                }
+                Assert(graph2.at(20).isTerminal() == false);
+                graph2.assignNodeSlots(node_slots);
+                Assert(node_slots.size() == 20);
+              }
+              free(memory);
+              Assert(old_graph.at(0).isTerminal() == false);
+              Assert(old_graph.at(0).getNode() == string("foo"));
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_overlay_graph_edges_memory(self):
+        source = '''
+            int main() {
+              MemoryPool memory_pool;
+              vector<SimpleNode> old_values{{2, "foo", &no_neighbors, true}, {3, "bar", &no_neighbors, true}};
+
+              Graph old_graph(old_values.begin(), old_values.end(), memory_pool);
+              // A single new node with many edges to the existing nodes.
+              const std::size_t num_edges = 2000;
+              vector<int> new_neighbors;
+              for (std::size_t i = 0; i < num_edges; i++) {
+                new_neighbors.push_back(2 + i % 2);
+              }
+              vector<SimpleNode> new_values{{5, "qux", &new_neighbors, false}};
+
+              std::size_t size = Graph::maximumRequiredSpaceForOverlay(old_graph, new_values.begin(), new_values.end());
+              char* memory = static_cast<char*>(calloc(size, 1));
+              {
+                MemoryRegion region(memory, size);
+                Graph graph(old_graph, new_values.begin(), new_values.end(), memory_pool, &region);
+                edge_iterator itr = graph.at(5).neighborsBegin();
+                Assert(itr.getNodeIterator(graph.begin()).getNode() == string("foo"));
+                Assert(itr.getNodeIterator(num_edges - 1, graph.begin()).getNode() == string("bar"));
+                // The edges are stored as 32-bit node indexes, so the graph takes less than 8 bytes per edge.
+                std::size_t used_memory = region.allocate<char>(0) - memory;
+                Assert(used_memory >= num_edges * sizeof(std::uint32_t));
+                Assert(used_memory < num_edges * sizeof(std::uint64_t));
+              }
+              free(memory);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
     def test_move_constructor(self):
         source = '''
             int main() {
@@ -72,7 +72,7 @@ class TestSemistaticMap(parameterized.TestCase):
               vector<pair<int, std::string>, ArenaAllocator<pair<int, std::string>>> new_values(
                 {{2, "bar"}}, 
                 ArenaAllocator<pair<int, std::string>>(memory_pool));
-              SemistaticMap<int, std::string> map(old_map, std::move(new_values));
+              SemistaticMap<int, std::string> map(old_map, new_values, memory_pool);
               Assert(map.find(0) == nullptr);
               Assert(map.find(2) != nullptr);
               Assert(map.at(2) == "bar");
@@ -117,7 +117,7 @@ class TestSemistaticMap(parameterized.TestCase):
               vector<pair<int, std::string>, ArenaAllocator<pair<int, std::string>>> new_values(
                   {{3, "bar"}, {4, "baz"}}, 
                   ArenaAllocator<pair<int, std::string>>(memory_pool));
-              SemistaticMap<int, std::string> map(old_map, std::move(new_values));
+              SemistaticMap<int, std::string> map(old_map, new_values, memory_pool);
               Assert(map.find(0) == nullptr);
               Assert(map.find(1) != nullptr);
               Assert(map.at(1) == "foo");
@@ -143,7 +143,7 @@ class TestSemistaticMap(parameterized.TestCase):
               vector<pair<int, std::string>, ArenaAllocator<pair<int, std::string>>> new_values(
                   {{2, "2"}, {4, "4"}, {16, "16"}}, 
                   ArenaAllocator<pair<int, std::string>>(memory_pool));
-              SemistaticMap<int, std::string> map(old_map, std::move(new_values));
+              SemistaticMap<int, std::string> map(old_map, new_values, memory_pool);
               Assert(map.find(0) == nullptr);
               Assert(map.find(1) != nullptr);
               Assert(map.at(1) == "1");
@@ -165,6 +165,55 @@ class TestSemistaticMap(parameterized.TestCase):
             source,
             locals())
 
+    def test_inserted_elems_use_base_hash_multiplier(self):
+        source = '''
+            int main() {
+              MemoryPool memory_pool;
+              vector<pair<int, std::string>> values{{1, "1"}, {3, "3"}, {5, "5"}};
+              SemistaticMap<int, std::string> old_map(values.begin(), values.end(), values.size(), memory_pool);
+              vector<pair<int, std::string>, ArenaAllocator<pair<int, std::string>>> new_values(
+                  {{2, "2"}, {4, "4"}, {16, "16"}},
+                  ArenaAllocator<pair<int, std::string>>(memory_pool));
+              SemistaticMap<int, std::string> map(old_map, new_values, memory_pool);
+              // With fewer than 4 new keys there can't be too many collisions, so the base map's multiplier is used.
+              Assert(map.getNumHashFunctionRetries() == 0);
+              Assert(map.getHashMultiplier() == old_map.getHashMultiplier());
+              Assert(map.at(16) == "16");
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_many_inserted_elems(self):
+        source = '''
+            int main() {
+              MemoryPool memory_pool;
+              vector<pair<std::uint64_t, std::string>> values{{1, "1"}};
+              SemistaticMap<std::uint64_t, std::string> old_map(values.begin(), values.end(), values.size(), memory_pool);
+              vector<pair<std::uint64_t, std::string>, ArenaAllocator<pair<std::uint64_t, std::string>>> new_values{
+                  ArenaAllocator<pair<std::uint64_t, std::string>>(memory_pool)};
+              for (std::uint64_t i = 2; i <= 30; i++) {
+                new_values.push_back({i, std::to_string(i)});
+              }
+              SemistaticMap<std::uint64_t, std::string> map(old_map, new_values, memory_pool);
+              Assert(map.find(0) == nullptr);
+              for (std::uint64_t i = 1; i <= 30; i++) {
+                Assert(map.find(i) != nullptr);
+                Assert(*map.find(i) == std::to_string(i));
+                Assert(map.at(i) == std::to_string(i));
+              }
+              for (std::uint64_t i = 31; i <= 60; i++) {
+                Assert(map.find(i) == nullptr);
+              }
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
     def test_move_constructor(self):
         source = '''
             int main() {
@@ -421,6 +421,39 @@ class TestBindingClash(parameterized.TestCase):
             source,
             locals())
 
+    @parameterized.parameters([
+        ('X', '(struct )?X'),
+        ('fruit::Annotated<Annotation1, X>', '(struct )?fruit::Annotated<(struct )?Annotation1, ?(struct )?X>'),
+    ])
+    def test_bind_instance_and_binding_runtime_with_parallel_normalization(self, XAnnot, XAnnotRegex):
+        source = '''
+            struct X {};
+
+            fruit::Component<> getComponentForInstanceHelper(X* x) {
+              return fruit::createComponent()
+                .bindInstance<XAnnot, X>(*x);
+            }
+
+            fruit::Component<XAnnot> getComponentForInstance(X* x) {
+              return fruit::createComponent()
+                .install(getComponentForInstanceHelper, x)
+                .registerConstructor<XAnnot()>();
+            }
+
+            int main() {
+              X x;
+              fruit::NormalizedComponentOptions options;
+              options.num_normalization_threads = 4;
+              fruit::NormalizedComponent<XAnnot> normalized_component(options, getComponentForInstance, &x);
+              (void)normalized_component;
+            }
+            '''
+        expect_runtime_error(
+            'Fatal injection error: the type XAnnotRegex was provided more than once, with different bindings.',
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
     @parameterized.parameters([
         'X',
         'fruit::Annotated<Annotation1, X>',
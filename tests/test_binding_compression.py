@@ -108,6 +108,40 @@ class TestBindingCompression(parameterized.TestCase):
             source,
             locals())
 
+    @parameterized.parameters([
+        ('I', 'X', 'const X', 'WithNoAnnot', 'WithNoAnnot'),
+        ('fruit::Annotated<Annotation1, I>', 'fruit::Annotated<Annotation2, X>', 'fruit::Annotated<Annotation2, const X>', 'WithAnnot1', 'WithAnnot2'),
+    ])
+    def test_no_compression_for_const_injector_type(self, IAnnot, XAnnot, ConstXAnnot, WithIAnnot, WithXAnnot):
+        source = '''
+            struct I {
+              int value = 5;
+            };
+
+            struct X : public I, ConstructionTracker<X> {
+            };
+
+            fruit::Component<IAnnot, ConstXAnnot> getComponent() {
+              return fruit::createComponent()
+                .registerProvider<XAnnot()>([](){return X();})
+                .bind<IAnnot, XAnnot>();
+            }
+
+            int main() {
+              // X is exposed by the injector (as const X), so the I->X binding must not be compressed.
+              fruit::Injector<IAnnot, ConstXAnnot> injector(getComponent);
+              const X& x = injector.get<WithXAnnot<const X&>>();
+              Assert(x.value == 5);
+              Assert(&injector.get<WithIAnnot<I&>>() == &x);
+              Assert(fruit::impl::InjectorAccessorForTests::unsafeGet<XAnnot>(injector) == &x);
+              Assert(X::num_objects_constructed == 1);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
     def test_compression_undone(self):
         source = '''
             struct I1 {};
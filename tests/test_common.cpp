@@ -25,8 +25,9 @@ namespace fruit {
 namespace impl {
 
 template class SemistaticGraph<int, const char*>;
-template SemistaticGraph<int, char const*>::SemistaticGraph(std::vector<SimpleNode>::iterator first, std::vector<SimpleNode>::iterator last, MemoryPool& memory_pool);
-template SemistaticGraph<int, char const*>::SemistaticGraph(const fruit::impl::SemistaticGraph<int, char const*>& graph, std::vector<SimpleNode>::iterator first, std::vector<SimpleNode>::iterator last, MemoryPool& memory_pool);
+template SemistaticGraph<int, char const*>::SemistaticGraph(std::vector<SimpleNode>::iterator first, std::vector<SimpleNode>::iterator last, MemoryPool& memory_pool, const SemistaticMapHashOptions& hash_options);
+template SemistaticGraph<int, char const*>::SemistaticGraph(const fruit::impl::SemistaticGraph<int, char const*>& graph, std::vector<SimpleNode>::iterator first, std::vector<SimpleNode>::iterator last, MemoryPool& memory_pool, MemoryRegion* region, const SemistaticGraph<int, char const*>::NodeSlots* node_slots, std::size_t num_node_slots);
+template std::size_t SemistaticGraph<int, char const*>::maximumRequiredSpaceForOverlay(const fruit::impl::SemistaticGraph<int, char const*>& graph, std::vector<SimpleNode>::iterator first, std::vector<SimpleNode>::iterator last, std::size_t num_node_slots);
 template class SemistaticMap<int, SemistaticGraphInternalNodeId>;
 
 } // namespace impl
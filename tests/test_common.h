@@ -44,6 +44,7 @@ struct SimpleNode {
   bool isTerminal() { return is_terminal; }
   std::vector<int>::const_iterator getEdgesBegin() { return neighbors->begin(); }
   std::vector<int>::const_iterator getEdgesEnd() { return neighbors->end(); }
+  bool isLazyEdge(std::size_t) { return false; }
 };
 
 #endif // FRUIT_COMMON_H
@@ -117,5 +117,142 @@ class TestEagerInjection(parameterized.TestCase):
             locals(),
             ignore_deprecation_warnings=True)
 
+    @parameterized.parameters([
+        ('false', '1'),
+        ('false', '4'),
+        ('true', '1'),
+        ('true', '4'),
+    ])
+    def test_eager_injection_parallel(self, ConcurrentConstruction, NumThreads):
+        source = '''
+            #include <atomic>
+
+            std::atomic<int> num_constructed_objects(0);
+
+            template <int N>
+            struct W {
+              INJECT(W()) {
+                ++num_constructed_objects;
+              }
+            };
+
+            struct V {
+              INJECT(V(W<1>&, W<2>&, W<3>&, fruit::Provider<W<4>>)) {
+                // All dependencies (including the ones injected lazily) have already been constructed.
+                Assert(num_constructed_objects == 4);
+                ++num_constructed_objects;
+              }
+            };
+
+            fruit::Component<X, V> getComponent() {
+              return fruit::createComponent()
+                .addMultibindingProvider([](){return new Y();})
+                .registerConstructor<Z()>();
+            }
+
+            int main() {
+              fruit::InjectorOptions options;
+              options.concurrent_construction = ConcurrentConstruction;
+              fruit::Injector<X, V> injector(options, getComponent);
+
+              Assert(!X::constructed);
+              Assert(!Y::constructed);
+              Assert(!Z::constructed);
+              Assert(num_constructed_objects == 0);
+
+              injector.eagerlyInjectAllParallel(NumThreads);
+
+              Assert(X::constructed);
+              Assert(Y::constructed);
+              // Z still not constructed, it's not reachable from Injector<X, V>.
+              Assert(!Z::constructed);
+              Assert(num_constructed_objects == 5);
+
+              // Already constructed, this doesn't construct any new object.
+              injector.get<V&>();
+              Assert(num_constructed_objects == 5);
+
+              return 0;
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    @parameterized.parameters([
+        ('false', '4'),
+        ('true', '1'),
+        ('true', '4'),
+    ])
+    def test_eager_injection_parallel_with_exception(self, ConcurrentConstruction, NumThreads):
+        source = '''
+            #include <atomic>
+            #include <stdexcept>
+
+            std::atomic<int> num_constructed_objects(0);
+            std::atomic<bool> should_throw(true);
+
+            template <int N>
+            struct W {
+              INJECT(W()) {
+                ++num_constructed_objects;
+              }
+            };
+
+            struct Thrower {
+              INJECT(Thrower(W<1>&, W<2>&)) {
+            #if FRUIT_HAS_EXCEPTIONS
+                if (should_throw) {
+                  throw std::runtime_error("Thrower");
+                }
+            #endif
+                ++num_constructed_objects;
+              }
+            };
+
+            struct V {
+              INJECT(V(Thrower&, W<3>&, fruit::Provider<W<4>>)) {
+                ++num_constructed_objects;
+              }
+            };
+
+            fruit::Component<V, W<5>, W<6>> getComponent() {
+              return fruit::createComponent()
+                .addMultibindingProvider([](){return new Y();});
+            }
+
+            int main() {
+              fruit::InjectorOptions options;
+              options.concurrent_construction = ConcurrentConstruction;
+              fruit::Injector<V, W<5>, W<6>> injector(options, getComponent);
+
+            #if FRUIT_HAS_EXCEPTIONS
+              bool caught = false;
+              try {
+                injector.eagerlyInjectAllParallel(NumThreads);
+              } catch (const std::runtime_error& e) {
+                Assert(std::string(e.what()) == "Thrower");
+                caught = true;
+              }
+              Assert(caught);
+              // V depends on Thrower, so it can't have been constructed. The multibindings are not constructed either.
+              Assert(num_constructed_objects <= 6);
+              Assert(!Y::constructed);
+            #endif
+
+              should_throw = false;
+              injector.eagerlyInjectAllParallel(NumThreads);
+              Assert(num_constructed_objects == 8);
+              Assert(Y::constructed);
+
+              return 0;
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
 if __name__ == '__main__':
     absltest.main()
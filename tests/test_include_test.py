@@ -24,8 +24,11 @@ FRUIT_PUBLIC_HEADERS = [
     "fruit.h",
     "fruit_forward_decls.h",
     "injector.h",
+    "injector_options.h",
+    "injector_pool.h",
     "macro.h",
     "normalized_component.h",
+    "normalized_component_options.h",
     "provider.h",
 ]
 
@@ -392,5 +392,812 @@ class TestInjector(parameterized.TestCase):
             source,
             locals())
 
+    @parameterized.parameters([
+        ('X', 'X*'),
+        ('fruit::Annotated<Annotation1, X>', 'fruit::Annotated<Annotation1, X*>'),
+    ])
+    def test_injector_with_concurrent_construction(self, XAnnot, XPtrAnnot):
+        source = '''
+            struct Y {
+              static int num_constructed;
+              using Inject = Y();
+              Y() {
+                ++num_constructed;
+              }
+            };
+
+            int Y::num_constructed = 0;
+
+            struct X {
+              using Inject = X(Y&, fruit::Provider<Y>);
+              X(Y& y, fruit::Provider<Y> y_provider) {
+                Assert(&y == y_provider.get<Y*>());
+              }
+            };
+
+            fruit::Component<XAnnot, Y> getComponent() {
+              return fruit::createComponent();
+            }
+
+            int main() {
+              fruit::InjectorOptions options;
+              options.concurrent_construction = true;
+              fruit::Injector<XAnnot, Y> injector(options, getComponent);
+
+              Y* y = injector.get<Y*>();
+              injector.get<XPtrAnnot>();
+              Assert(injector.get<Y*>() == y);
+              Assert(Y::num_constructed == 1);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_injector_with_normalized_component_and_concurrent_construction(self):
+        source = '''
+            struct Y {
+              int n;
+            };
+
+            struct X {
+              Y& y;
+              using Inject = X(Y&);
+              X(Y& y) : y(y) {}
+            };
+
+            fruit::Component<fruit::Required<Y>, X> getXComponent() {
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Y> getYComponent(Y* y) {
+              return fruit::createComponent()
+                  .bindInstance(*y);
+            }
+
+            int main() {
+              fruit::NormalizedComponent<fruit::Required<Y>, X> normalized_component(getXComponent);
+              fruit::InjectorOptions options;
+              options.concurrent_construction = true;
+              Y y{5};
+              fruit::Injector<X> injector(options, normalized_component, getYComponent, &y);
+              Assert(injector.get<X&>().y.n == 5);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source)
+
+    def test_injector_with_memory_resource(self):
+        source = '''
+            #include <cstddef>
+            #include <cstdlib>
+
+            // Allocates from the heap, keeping track of the memory that is currently allocated.
+            struct CountingMemoryResource : public fruit::MemoryResource {
+              std::size_t num_allocated_bytes = 0;
+
+              void* allocate(std::size_t bytes, std::size_t alignment) override {
+                Assert(alignment <= alignof(std::max_align_t));
+                num_allocated_bytes += bytes;
+                return std::malloc(bytes);
+              }
+
+              void deallocate(void* p, std::size_t bytes, std::size_t) override {
+                num_allocated_bytes -= bytes;
+                std::free(p);
+              }
+            };
+
+            CountingMemoryResource* memory_resource = nullptr;
+
+            struct Y {
+              int n;
+            };
+
+            struct X {
+              Y& y;
+              using Inject = X(Y&);
+              X(Y& y) : y(y) {
+                // The object is stored in memory from the resource.
+                Assert(memory_resource->num_allocated_bytes != 0);
+              }
+              ~X() {
+                // The memory is deallocated only after destroying the objects.
+                Assert(memory_resource->num_allocated_bytes != 0);
+              }
+            };
+
+            fruit::Component<fruit::Required<Y>, X> getXComponent() {
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Y> getYComponent(Y* y) {
+              return fruit::createComponent()
+                  .bindInstance(*y);
+            }
+
+            fruit::Component<X> getXYComponent(Y* y) {
+              return fruit::createComponent()
+                  .install(getXComponent)
+                  .install(getYComponent, y);
+            }
+
+            int main() {
+              CountingMemoryResource resource;
+              memory_resource = &resource;
+              fruit::InjectorOptions options;
+              options.memory_resource = &resource;
+              Y y{5};
+
+              {
+                fruit::Injector<X> injector(options, getXYComponent, &y);
+                Assert(injector.get<X&>().y.n == 5);
+              }
+              Assert(resource.num_allocated_bytes == 0);
+
+              fruit::NormalizedComponent<fruit::Required<Y>, X> normalized_component(getXComponent);
+              {
+                fruit::Injector<X> injector(options, normalized_component, getYComponent, &y);
+                Assert(injector.get<X&>().y.n == 5);
+              }
+              Assert(resource.num_allocated_bytes == 0);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source)
+
+    def test_injector_with_memory_resource_allocation_failure(self):
+        source = '''
+            #include <cstddef>
+            #include <new>
+
+            // A resource that never has any memory available.
+            struct EmptyMemoryResource : public fruit::MemoryResource {
+              void* allocate(std::size_t, std::size_t) override {
+                return nullptr;
+              }
+
+              void deallocate(void*, std::size_t, std::size_t) override {
+                Assert(false);
+              }
+            };
+
+            struct Y {
+              int n;
+            };
+
+            struct X {
+              Y& y;
+              using Inject = X(Y&);
+              X(Y& y) : y(y) {}
+            };
+
+            fruit::Component<fruit::Required<Y>, X> getXComponent() {
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Y> getYComponent(Y* y) {
+              return fruit::createComponent()
+                  .bindInstance(*y);
+            }
+
+            fruit::Component<X> getXYComponent(Y* y) {
+              return fruit::createComponent()
+                  .install(getXComponent)
+                  .install(getYComponent, y);
+            }
+
+            int main() {
+            #if FRUIT_HAS_EXCEPTIONS
+              EmptyMemoryResource resource;
+              fruit::InjectorOptions options;
+              options.memory_resource = &resource;
+              Y y{5};
+
+              bool caught = false;
+              try {
+                fruit::Injector<X> injector(options, getXYComponent, &y);
+              } catch (const std::bad_alloc&) {
+                caught = true;
+              }
+              Assert(caught);
+
+              fruit::NormalizedComponent<fruit::Required<Y>, X> normalized_component(getXComponent);
+              caught = false;
+              try {
+                fruit::Injector<X> injector(options, normalized_component, getYComponent, &y);
+              } catch (const std::bad_alloc&) {
+                caught = true;
+              }
+              Assert(caught);
+            #endif
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source)
+
+    @parameterized.parameters([
+        ('false', '1'),
+        ('true', '0'),
+    ])
+    def test_injector_with_skip_object_destruction(self, SkipObjectDestruction, ExpectedNumDestroyed):
+        source = '''
+            struct Y {
+              static int num_destroyed;
+              using Inject = Y();
+              ~Y() {
+                ++num_destroyed;
+              }
+            };
+
+            int Y::num_destroyed = 0;
+
+            fruit::Component<Y> getComponent() {
+              return fruit::createComponent();
+            }
+
+            int main() {
+              fruit::InjectorOptions options;
+              options.skip_object_destruction = SkipObjectDestruction;
+              {
+                fruit::Injector<Y> injector(options, getComponent);
+                injector.get<Y&>();
+              }
+              Assert(Y::num_destroyed == ExpectedNumDestroyed);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    @parameterized.parameters([
+        '1',
+        '4',
+    ])
+    def test_injector_with_parallel_normalization(self, NumThreads):
+        source = '''
+            #include <atomic>
+
+            struct Logger {
+              using Inject = Logger();
+            };
+
+            struct Storage {
+              int port;
+            };
+
+            struct Listener {
+              virtual ~Listener() = default;
+            };
+
+            template <int N>
+            struct Service : public Listener {
+              using Inject = Service(Logger&, Storage&);
+              Service(Logger&, Storage& storage) : port(storage.port) {}
+              int port;
+            };
+
+            Storage storage{8080};
+            Storage fake_storage{0};
+
+            std::atomic<int> num_logger_component_calls(0);
+
+            fruit::Component<Logger> getLoggerComponent() {
+              ++num_logger_component_calls;
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Storage> getStorageComponent(int) {
+              return fruit::createComponent()
+                  .bindInstance(storage);
+            }
+
+            fruit::Component<Storage> getFakeStorageComponent() {
+              return fruit::createComponent()
+                  .bindInstance(fake_storage);
+            }
+
+            template <int N>
+            fruit::Component<Service<N>> getServiceComponent() {
+              return fruit::createComponent()
+                  .install(getLoggerComponent)
+                  .install(getStorageComponent, 8080)
+                  .addMultibinding<Listener, Service<N>>();
+            }
+
+            fruit::Component<Service<1>, Service<2>, Service<3>> getRootComponent() {
+              return fruit::createComponent()
+                  .install(getServiceComponent<1>)
+                  .install(getServiceComponent<2>)
+                  .install(getServiceComponent<3>);
+            }
+
+            fruit::Component<Service<1>, Service<2>, Service<3>> getRootComponentWithFakeStorage() {
+              return fruit::createComponent()
+                  .replace(getStorageComponent, 8080).with(getFakeStorageComponent)
+                  .install(getRootComponent);
+            }
+
+            int main() {
+              fruit::InjectorOptions options;
+              options.num_normalization_threads = NumThreads;
+
+              fruit::Injector<Service<1>, Service<2>, Service<3>> injector(options, getRootComponent);
+              Assert(injector.get<Service<1>&>().port == 8080);
+              Assert(injector.getMultibindings<Listener>().size() == 3);
+              // Each component is expanded only once.
+              Assert(num_logger_component_calls == 1);
+
+              fruit::Injector<Service<1>, Service<2>, Service<3>> injector2(options, getRootComponentWithFakeStorage);
+              Assert(injector2.get<Service<3>&>().port == 0);
+              Assert(injector2.getMultibindings<Listener>().size() == 3);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    @parameterized.parameters([
+        ('false', '0'),
+        ('true', '1'),
+    ])
+    def test_injector_with_lazy_normalization(self, StrictLazyNormalization, NumUnusedComponentCalls):
+        source = '''
+            #include <atomic>
+
+            struct Logger {};
+
+            struct Storage {
+              int port;
+            };
+
+            struct Listener {
+              virtual ~Listener() = default;
+            };
+
+            template <int N>
+            struct Service : public Listener {
+              using Inject = Service(Logger&, Storage&);
+              Service(Logger&, Storage& storage) : port(storage.port) {}
+              int port;
+            };
+
+            Storage storage{8080};
+            Storage fake_storage{0};
+
+            std::atomic<int> num_logger_component_calls(0);
+            std::atomic<int> num_unused_component_calls(0);
+
+            fruit::Component<Logger> getLoggerComponent() {
+              ++num_logger_component_calls;
+              return fruit::createComponent()
+                  .registerConstructor<Logger()>();
+            }
+
+            fruit::Component<Storage> getStorageComponent(int) {
+              return fruit::createComponent()
+                  .bindInstance(storage);
+            }
+
+            fruit::Component<Storage> getFakeStorageComponent() {
+              return fruit::createComponent()
+                  .bindInstance(fake_storage);
+            }
+
+            fruit::Component<Service<1>> getServiceComponent() {
+              return fruit::createComponent()
+                  .install(getLoggerComponent)
+                  .install(getStorageComponent, 8080)
+                  .addMultibinding<Listener, Service<1>>();
+            }
+
+            fruit::Component<Service<2>> getUnusedComponent() {
+              ++num_unused_component_calls;
+              return fruit::createComponent()
+                  .install(getLoggerComponent)
+                  .install(getStorageComponent, 8080)
+                  .addMultibinding<Listener, Service<2>>();
+            }
+
+            fruit::Component<Service<3>> getUnusedComponentWithArgs(int) {
+              ++num_unused_component_calls;
+              return fruit::createComponent()
+                  .install(getLoggerComponent)
+                  .install(getStorageComponent, 8080);
+            }
+
+            fruit::Component<Service<1>> getRootComponent() {
+              return fruit::createComponent()
+                  .install(getUnusedComponent)
+                  .install(getServiceComponent)
+                  .install(getUnusedComponentWithArgs, 3);
+            }
+
+            fruit::Component<Service<1>> getRootComponentWithFakeStorage() {
+              return fruit::createComponent()
+                  .replace(getStorageComponent, 8080).with(getFakeStorageComponent)
+                  .install(getRootComponent);
+            }
+
+            int main() {
+              fruit::InjectorOptions options;
+              options.lazy_normalization = true;
+              options.strict_lazy_normalization = StrictLazyNormalization;
+
+              fruit::Injector<Service<1>> injector(options, getRootComponent);
+              Assert(injector.get<Service<1>&>().port == 8080);
+              // The multibindings in the components that are not expanded are not available.
+              Assert(injector.getMultibindings<Listener>().size() == 1 + NumUnusedComponentCalls);
+              Assert(num_logger_component_calls == 1);
+              Assert(num_unused_component_calls == 2 * NumUnusedComponentCalls);
+
+              fruit::Injector<Service<1>> injector2(options, getRootComponentWithFakeStorage);
+              Assert(injector2.get<Service<1>&>().port == 0);
+              Assert(num_unused_component_calls == 4 * NumUnusedComponentCalls);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    @parameterized.parameters([
+        ('false', 'true'),
+        ('true', 'false'),
+    ])
+    def test_injector_with_lazy_normalization_and_unused_conflicting_binding(self, StrictLazyNormalization,
+                                                                             ExpectSuccess):
+        source = '''
+            struct Storage {
+              int port;
+            };
+
+            Storage storage{8080};
+            Storage other_storage{0};
+
+            fruit::Component<Storage> getStorageComponent() {
+              return fruit::createComponent()
+                  .bindInstance(storage);
+            }
+
+            fruit::Component<fruit::Annotated<X, Storage>> getUnusedComponent() {
+              return fruit::createComponent()
+                  .bindInstance(other_storage)
+                  .bindInstance<fruit::Annotated<X, Storage>>(other_storage);
+            }
+
+            fruit::Component<Storage> getRootComponent() {
+              return fruit::createComponent()
+                  .install(getStorageComponent)
+                  .install(getUnusedComponent);
+            }
+
+            int main() {
+              fruit::InjectorOptions options;
+              options.lazy_normalization = true;
+              options.strict_lazy_normalization = StrictLazyNormalization;
+
+              fruit::Injector<Storage> injector(options, getRootComponent);
+              Assert(ExpectSuccess);
+              Assert(injector.get<Storage&>().port == 8080);
+            }
+            '''
+        if ExpectSuccess == 'true':
+            expect_success(
+                COMMON_DEFINITIONS,
+                source,
+                locals())
+        else:
+            expect_runtime_error(
+                'Fatal injection error: the type Storage was provided more than once, with different bindings.',
+                COMMON_DEFINITIONS,
+                source,
+                locals())
+
+    @parameterized.parameters([
+        ('false', '0'),
+        ('true', '4'),
+    ])
+    def test_injector_with_remove_unreachable_bindings(self, RemoveUnreachableBindings, NumRemovedBindings):
+        source = '''
+            struct Logger {
+              using Inject = Logger();
+            };
+
+            struct Config {
+              int port;
+            };
+
+            struct Server {
+              using Inject = Server(Logger&, fruit::Provider<Config>);
+              Server(Logger&, fruit::Provider<Config> config_provider) : config_provider(config_provider) {}
+              fruit::Provider<Config> config_provider;
+            };
+
+            struct Listener {
+              virtual ~Listener() = default;
+            };
+
+            struct MetricsListener : public Listener {
+              using Inject = MetricsListener(Logger&);
+              MetricsListener(Logger&) {}
+            };
+
+            struct Cache {
+              using Inject = Cache(Logger&);
+              Cache(Logger&) {}
+            };
+
+            struct Database {
+              virtual ~Database() = default;
+            };
+
+            struct DatabaseImpl : public Database {
+              using Inject = DatabaseImpl(Cache&);
+              DatabaseImpl(Cache&) {}
+            };
+
+            Config config{8080};
+            Config other_config{0};
+
+            fruit::Component<Database> getDatabaseComponent() {
+              return fruit::createComponent()
+                  .bind<Database, DatabaseImpl>();
+            }
+
+            fruit::Component<Server> getRootComponent() {
+              return fruit::createComponent()
+                  .bindInstance(config)
+                  .bindInstance<fruit::Annotated<X, Config>>(other_config)
+                  .addMultibinding<Listener, MetricsListener>()
+                  .install(getDatabaseComponent);
+            }
+
+            int main() {
+              fruit::InjectorOptions options;
+              options.remove_unreachable_bindings = RemoveUnreachableBindings;
+
+              // The bindings for Database, DatabaseImpl, Cache and Annotated<X, Config> are unreachable.
+              fruit::Injector<Server> injector(options, getRootComponent);
+              Assert(injector.getNumRemovedUnreachableBindings() == NumRemovedBindings);
+              Assert(injector.get<Server&>().config_provider.get<Config&>().port == 8080);
+              Assert(injector.getMultibindings<Listener>().size() == 1);
+              injector.eagerlyInjectAllParallel(2);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_injector_with_remove_unreachable_bindings_still_checks_them(self):
+        source = '''
+            struct Config {
+              int port;
+            };
+
+            Config config{8080};
+            Config other_config{0};
+
+            fruit::Component<fruit::Annotated<X, Config>> getUnusedComponent() {
+              return fruit::createComponent()
+                  .bindInstance(other_config)
+                  .bindInstance<fruit::Annotated<X, Config>>(other_config);
+            }
+
+            fruit::Component<Config> getRootComponent() {
+              return fruit::createComponent()
+                  .bindInstance(config)
+                  .install(getUnusedComponent);
+            }
+
+            int main() {
+              fruit::InjectorOptions options;
+              options.remove_unreachable_bindings = true;
+
+              fruit::Injector<Config> injector(options, getRootComponent);
+            }
+            '''
+        expect_runtime_error(
+            'Fatal injection error: the type Config was provided more than once, with different bindings.',
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    @parameterized.parameters([
+        'false',
+        'true',
+    ])
+    def test_injector_get_from_multiple_threads(self, ConcurrentConstruction):
+        source = '''
+            #include <atomic>
+            #include <thread>
+            #include <vector>
+
+            template <int N>
+            struct W {
+              static std::atomic<int> num_constructed;
+              using Inject = W();
+              W() {
+                ++num_constructed;
+              }
+            };
+
+            template <int N>
+            std::atomic<int> W<N>::num_constructed(0);
+
+            template <int N>
+            struct Z {
+              using Inject = Z(W<0>&, W<N>&);
+              Z(W<0>&, W<N>&) {}
+            };
+
+            fruit::Component<Z<1>, Z<2>, Z<3>, Z<4>> getComponent() {
+              return fruit::createComponent();
+            }
+
+            int main() {
+              fruit::InjectorOptions options;
+              options.concurrent_construction = ConcurrentConstruction;
+              fruit::Injector<Z<1>, Z<2>, Z<3>, Z<4>> injector(options, getComponent);
+
+              std::vector<std::thread> threads;
+              for (int i = 0; i < 8; i++) {
+                threads.emplace_back([&injector]() {
+                  for (int j = 0; j < 100; j++) {
+                    injector.get<Z<1>&>();
+                    injector.get<Z<2>&>();
+                    injector.get<Z<3>&>();
+                    injector.get<Z<4>&>();
+                  }
+                });
+              }
+              for (std::thread& thread : threads) {
+                thread.join();
+              }
+
+              Assert(W<0>::num_constructed == 1);
+              Assert(W<1>::num_constructed == 1);
+              Assert(W<2>::num_constructed == 1);
+              Assert(W<3>::num_constructed == 1);
+              Assert(W<4>::num_constructed == 1);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    @parameterized.parameters([
+        'false',
+        'true',
+    ])
+    def test_injector_get_from_multiple_threads_while_constructing(self, ConcurrentConstruction):
+        source = '''
+            #include <atomic>
+            #include <thread>
+            #include <vector>
+
+            template <int N>
+            struct W {
+              int value = 0;
+              using Inject = W();
+              W() {
+                value = N;
+              }
+            };
+
+            template <int N>
+            struct Z {
+              W<0>& w0;
+              W<N>& w;
+              int value = 0;
+              using Inject = Z(W<0>&, W<N>&);
+              Z(W<0>& w0, W<N>& w) : w0(w0), w(w) {
+                value = w.value + 100;
+              }
+            };
+
+            fruit::Component<Z<1>, Z<2>, Z<3>> getComponent() {
+              return fruit::createComponent();
+            }
+
+            // Called by all threads at the same time, while the objects are being constructed. The threads that find
+            // the objects already constructed (by another thread) read them without locking, so this checks that they
+            // see the values written by the constructors.
+            void checkObjects(fruit::Injector<Z<1>, Z<2>, Z<3>>& injector) {
+              for (int j = 0; j < 10; j++) {
+                Z<1>& z1 = injector.get<Z<1>&>();
+                Z<2>& z2 = injector.get<Z<2>&>();
+                Z<3>& z3 = injector.get<Z<3>&>();
+                Assert(z1.value == 101 && z1.w.value == 1 && z1.w0.value == 0);
+                Assert(z2.value == 102 && z2.w.value == 2 && &z2.w0 == &z1.w0);
+                Assert(z3.value == 103 && z3.w.value == 3 && &z3.w0 == &z1.w0);
+              }
+            }
+
+            int main() {
+              fruit::InjectorOptions options;
+              options.concurrent_construction = ConcurrentConstruction;
+
+              for (int i = 0; i < 50; i++) {
+                fruit::Injector<Z<1>, Z<2>, Z<3>> injector(options, getComponent);
+
+                std::atomic<int> num_waiting_threads(0);
+                std::vector<std::thread> threads;
+                for (int k = 0; k < 4; k++) {
+                  threads.emplace_back([&injector, &num_waiting_threads]() {
+                    // Start calling get() at roughly the same time in all the threads.
+                    ++num_waiting_threads;
+                    while (num_waiting_threads < 4) {
+                      std::this_thread::yield();
+                    }
+                    checkObjects(injector);
+                  });
+                }
+                for (std::thread& thread : threads) {
+                  thread.join();
+                }
+              }
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_injector_get_constructs_dependencies_first(self):
+        source = '''
+            #include <vector>
+
+            std::vector<int> construction_order;
+
+            // Y2 isn't constructed, since it's only injected through a Provider.
+            struct Y2 {
+              INJECT(Y2()) {
+                construction_order.push_back(-1);
+              }
+            };
+
+            template <int N>
+            struct Chain {
+              INJECT(Chain(Chain<N - 1>&, Chain<N / 2>&, fruit::Provider<Y2>)) {
+                construction_order.push_back(N);
+              }
+            };
+
+            template <>
+            struct Chain<0> {
+              INJECT(Chain()) {
+                construction_order.push_back(0);
+              }
+            };
+
+            fruit::Component<Chain<30>> getComponent() {
+              return fruit::createComponent();
+            }
+
+            int main() {
+              fruit::Injector<Chain<30>> injector(getComponent);
+              injector.get<Chain<30>&>();
+
+              // Each object is constructed once, after its dependencies.
+              Assert(construction_order.size() == 31);
+              for (int i = 0; i <= 30; i++) {
+                Assert(construction_order[i] == i);
+              }
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
 if __name__ == '__main__':
     absltest.main()
@@ -0,0 +1,565 @@
+#!/usr/bin/env python3
+#  Copyright 2016 Google Inc. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS-IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from absl.testing import parameterized
+from fruit_test_common import *
+
+COMMON_DEFINITIONS = '''
+    #include "test_common.h"
+
+    struct X;
+
+    struct Annotation1 {};
+    using XAnnot1 = fruit::Annotated<Annotation1, X>;
+    '''
+
+class TestInjectorPool(parameterized.TestCase):
+    @parameterized.parameters([
+        ('X', 'X*'),
+        ('fruit::Annotated<Annotation1, X>', 'fruit::Annotated<Annotation1, X*>'),
+    ])
+    def test_success(self, XAnnot, XPtrAnnot):
+        source = '''
+            struct Request {
+              int n;
+            };
+
+            struct X {
+              static int num_constructed;
+              static int num_destroyed;
+              const Request& request;
+              using Inject = X(const Request&);
+              X(const Request& request) : request(request) {
+                ++num_constructed;
+              }
+              ~X() {
+                ++num_destroyed;
+              }
+            };
+
+            int X::num_constructed = 0;
+            int X::num_destroyed = 0;
+
+            fruit::Component<fruit::Required<Request>, XAnnot> getXComponent() {
+              return fruit::createComponent()
+                  .registerConstructor<XAnnot(const Request&)>();
+            }
+
+            fruit::Component<Request> getRequestComponent(Request* request) {
+              return fruit::createComponent()
+                  .bindInstance(*request);
+            }
+
+            int main() {
+              fruit::NormalizedComponent<fruit::Required<Request>, XAnnot> normalized_component(getXComponent);
+              fruit::InjectorPool<XAnnot> injector_pool;
+
+              X* previous_x = nullptr;
+              for (int i = 0; i < 3; i++) {
+                Request request{i};
+                {
+                  fruit::InjectorPool<XAnnot>::PooledInjector injector =
+                      injector_pool.get(normalized_component, getRequestComponent, &request);
+                  X* x = injector->get<XPtrAnnot>();
+                  Assert(x->request.n == i);
+                  Assert(x == (*injector).get<XPtrAnnot>());
+                  if (previous_x != nullptr) {
+                    // The memory of the previous injector has been reused.
+                    Assert(x == previous_x);
+                  }
+                  previous_x = x;
+                  Assert(X::num_constructed == i + 1);
+                  Assert(X::num_destroyed == i);
+                }
+                // The objects are destroyed when the injector goes back to the pool.
+                Assert(X::num_destroyed == i + 1);
+              }
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_injectors_in_use_at_the_same_time(self):
+        source = '''
+            struct Y {
+              int n;
+            };
+
+            struct X {
+              Y& y;
+              using Inject = X(Y&);
+              X(Y& y) : y(y) {}
+            };
+
+            fruit::Component<fruit::Required<Y>, X> getXComponent() {
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Y> getYComponent(Y* y) {
+              return fruit::createComponent()
+                  .bindInstance(*y);
+            }
+
+            int main() {
+              fruit::NormalizedComponent<fruit::Required<Y>, X> normalized_component(getXComponent);
+              fruit::InjectorPool<X> injector_pool;
+
+              Y y1{1};
+              Y y2{2};
+              Y y3{3};
+              fruit::InjectorPool<X>::PooledInjector injector1 =
+                  injector_pool.get(normalized_component, getYComponent, &y1);
+              X* x1 = injector1->get<X*>();
+              {
+                fruit::InjectorPool<X>::PooledInjector injector2 =
+                    injector_pool.get(normalized_component, getYComponent, &y2);
+                fruit::InjectorPool<X>::PooledInjector moved_injector2 = std::move(injector2);
+                Assert(moved_injector2->get<X&>().y.n == 2);
+              }
+              fruit::InjectorPool<X>::PooledInjector injector3 =
+                  injector_pool.get(normalized_component, getYComponent, &y3);
+              Assert(injector3->get<X&>().y.n == 3);
+              Assert(injector1->get<X*>() == x1);
+              Assert(x1->y.n == 1);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source)
+
+    def test_with_multibindings(self):
+        source = '''
+            struct Listener {
+              virtual int get() = 0;
+              virtual ~Listener() = default;
+            };
+
+            struct ListenerImpl : public Listener {
+              int n;
+              ListenerImpl(int n) : n(n) {}
+              int get() override {
+                return n;
+              }
+            };
+
+            fruit::Component<> getListenersComponent() {
+              return fruit::createComponent()
+                  .addMultibindingProvider([]() { return static_cast<Listener*>(new ListenerImpl(1)); });
+            }
+
+            fruit::Component<> getRequestListenersComponent(ListenerImpl* listener) {
+              return fruit::createComponent()
+                  .addInstanceMultibinding<Listener>(*listener);
+            }
+
+            int main() {
+              fruit::NormalizedComponent<> normalized_component(getListenersComponent);
+              fruit::InjectorPool<> injector_pool;
+
+              for (int i = 2; i < 5; i++) {
+                ListenerImpl listener(i);
+                fruit::InjectorPool<>::PooledInjector injector =
+                    injector_pool.get(normalized_component, getRequestListenersComponent, &listener);
+                const std::vector<Listener*>& listeners = injector->getMultibindings<Listener>();
+                Assert(listeners.size() == 2);
+                Assert(listeners[0]->get() + listeners[1]->get() == 1 + i);
+              }
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source)
+
+    @parameterized.parameters([
+        'false',
+        'true',
+    ])
+    def test_get_from_multiple_threads(self, ConcurrentConstruction):
+        source = '''
+            #include <atomic>
+            #include <thread>
+            #include <vector>
+
+            struct Request {
+              int n;
+            };
+
+            struct X {
+              static std::atomic<int> num_alive;
+              const Request& request;
+              using Inject = X(const Request&);
+              X(const Request& request) : request(request) {
+                ++num_alive;
+              }
+              ~X() {
+                --num_alive;
+              }
+            };
+
+            std::atomic<int> X::num_alive(0);
+
+            fruit::Component<fruit::Required<Request>, X> getXComponent() {
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Request> getRequestComponent(Request* request) {
+              return fruit::createComponent()
+                  .bindInstance(*request);
+            }
+
+            int main() {
+              fruit::NormalizedComponent<fruit::Required<Request>, X> normalized_component(getXComponent);
+              fruit::InjectorOptions options;
+              options.concurrent_construction = ConcurrentConstruction;
+              fruit::InjectorPool<X> injector_pool(options);
+
+              std::vector<std::thread> threads;
+              for (int i = 0; i < 8; i++) {
+                threads.emplace_back([&normalized_component, &injector_pool, i]() {
+                  for (int j = 0; j < 100; j++) {
+                    Request request{i * 100 + j};
+                    fruit::InjectorPool<X>::PooledInjector injector =
+                        injector_pool.get(normalized_component, getRequestComponent, &request);
+                    Assert(injector->get<X&>().request.n == i * 100 + j);
+                  }
+                });
+              }
+              for (std::thread& thread : threads) {
+                thread.join();
+              }
+              Assert(X::num_alive == 0);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_with_memory_resource(self):
+        source = '''
+            #include <cstddef>
+            #include <cstdlib>
+
+            // Allocates from the heap, keeping track of the memory that is currently allocated.
+            struct CountingMemoryResource : public fruit::MemoryResource {
+              std::size_t num_allocated_bytes = 0;
+
+              void* allocate(std::size_t bytes, std::size_t alignment) override {
+                Assert(alignment <= alignof(std::max_align_t));
+                num_allocated_bytes += bytes;
+                return std::malloc(bytes);
+              }
+
+              void deallocate(void* p, std::size_t bytes, std::size_t) override {
+                num_allocated_bytes -= bytes;
+                std::free(p);
+              }
+            };
+
+            struct Request {
+              int n;
+            };
+
+            struct X {
+              const Request& request;
+              using Inject = X(const Request&);
+              X(const Request& request) : request(request) {}
+            };
+
+            fruit::Component<fruit::Required<Request>, X> getXComponent() {
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Request> getRequestComponent(Request* request) {
+              return fruit::createComponent()
+                  .bindInstance(*request);
+            }
+
+            int main() {
+              fruit::NormalizedComponent<fruit::Required<Request>, X> normalized_component(getXComponent);
+              CountingMemoryResource resource;
+              {
+                fruit::InjectorOptions options;
+                options.memory_resource = &resource;
+                fruit::InjectorPool<X> injector_pool(options);
+
+                std::size_t num_allocated_bytes = 0;
+                for (int i = 0; i < 3; i++) {
+                  Request request{i};
+                  fruit::InjectorPool<X>::PooledInjector injector =
+                      injector_pool.get(normalized_component, getRequestComponent, &request);
+                  Assert(injector->get<X&>().request.n == i);
+                  Assert(resource.num_allocated_bytes != 0);
+                  // The memory of the previous injector has been reused.
+                  Assert(i == 0 || resource.num_allocated_bytes == num_allocated_bytes);
+                  num_allocated_bytes = resource.num_allocated_bytes;
+                }
+              }
+              Assert(resource.num_allocated_bytes == 0);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source)
+
+    @parameterized.parameters([
+        '0',
+        '1',
+        '2',
+    ])
+    def test_max_idle_injectors(self, MaxIdleInjectors):
+        source = '''
+            #include <cstddef>
+            #include <cstdlib>
+
+            // Allocates from the heap, keeping track of the memory that is currently allocated.
+            struct CountingMemoryResource : public fruit::MemoryResource {
+              std::size_t num_allocated_bytes = 0;
+
+              void* allocate(std::size_t bytes, std::size_t alignment) override {
+                Assert(alignment <= alignof(std::max_align_t));
+                num_allocated_bytes += bytes;
+                return std::malloc(bytes);
+              }
+
+              void deallocate(void* p, std::size_t bytes, std::size_t) override {
+                num_allocated_bytes -= bytes;
+                std::free(p);
+              }
+            };
+
+            struct Request {
+              int n;
+            };
+
+            struct X {
+              const Request& request;
+              using Inject = X(const Request&);
+              X(const Request& request) : request(request) {}
+            };
+
+            fruit::Component<fruit::Required<Request>, X> getXComponent() {
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Request> getRequestComponent(Request* request) {
+              return fruit::createComponent()
+                  .bindInstance(*request);
+            }
+
+            int main() {
+              fruit::NormalizedComponent<fruit::Required<Request>, X> normalized_component(getXComponent);
+              CountingMemoryResource resource;
+              {
+                fruit::InjectorOptions options;
+                options.memory_resource = &resource;
+                fruit::InjectorPool<X> injector_pool(options, MaxIdleInjectors);
+
+                std::size_t bytes_per_injector = 0;
+                for (int i = 0; i < 2; i++) {
+                  Request request1{1};
+                  Request request2{2};
+                  Request request3{3};
+                  fruit::InjectorPool<X>::PooledInjector injector1 =
+                      injector_pool.get(normalized_component, getRequestComponent, &request1);
+                  if (i == 0) {
+                    bytes_per_injector = resource.num_allocated_bytes;
+                  }
+                  fruit::InjectorPool<X>::PooledInjector injector2 =
+                      injector_pool.get(normalized_component, getRequestComponent, &request2);
+                  fruit::InjectorPool<X>::PooledInjector injector3 =
+                      injector_pool.get(normalized_component, getRequestComponent, &request3);
+                  Assert(injector3->get<X&>().request.n == 3);
+                  Assert(resource.num_allocated_bytes == 3 * bytes_per_injector);
+                }
+                // All 3 injectors have been destroyed, the pool only kept the memory of MaxIdleInjectors of them.
+                Assert(resource.num_allocated_bytes == MaxIdleInjectors * bytes_per_injector);
+              }
+              Assert(resource.num_allocated_bytes == 0);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_component_function_throws(self):
+        source = '''
+            #include <cstddef>
+            #include <cstdlib>
+            #include <stdexcept>
+
+            // Allocates from the heap, keeping track of the memory that is currently allocated.
+            struct CountingMemoryResource : public fruit::MemoryResource {
+              std::size_t num_allocated_bytes = 0;
+
+              void* allocate(std::size_t bytes, std::size_t alignment) override {
+                Assert(alignment <= alignof(std::max_align_t));
+                num_allocated_bytes += bytes;
+                return std::malloc(bytes);
+              }
+
+              void deallocate(void* p, std::size_t bytes, std::size_t) override {
+                num_allocated_bytes -= bytes;
+                std::free(p);
+              }
+            };
+
+            struct Request {
+              int n;
+            };
+
+            struct X {
+              const Request& request;
+              using Inject = X(const Request&);
+              X(const Request& request) : request(request) {}
+            };
+
+            fruit::Component<fruit::Required<Request>, X> getXComponent() {
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Request> getRequestComponent(Request* request) {
+            #if FRUIT_HAS_EXCEPTIONS
+              if (request->n < 0) {
+                throw std::runtime_error("getRequestComponent");
+              }
+            #endif
+              return fruit::createComponent()
+                  .bindInstance(*request);
+            }
+
+            int main() {
+              fruit::NormalizedComponent<fruit::Required<Request>, X> normalized_component(getXComponent);
+              CountingMemoryResource resource;
+              {
+                fruit::InjectorOptions options;
+                options.memory_resource = &resource;
+                fruit::InjectorPool<X> injector_pool(options);
+
+                Request request1{1};
+                {
+                  fruit::InjectorPool<X>::PooledInjector injector =
+                      injector_pool.get(normalized_component, getRequestComponent, &request1);
+                  Assert(injector->get<X&>().request.n == 1);
+                }
+                std::size_t num_allocated_bytes = resource.num_allocated_bytes;
+                Assert(num_allocated_bytes != 0);
+
+            #if FRUIT_HAS_EXCEPTIONS
+                Request bad_request{-1};
+                bool caught = false;
+                try {
+                  injector_pool.get(normalized_component, getRequestComponent, &bad_request);
+                } catch (const std::runtime_error& e) {
+                  Assert(std::string(e.what()) == "getRequestComponent");
+                  caught = true;
+                }
+                Assert(caught);
+                Assert(resource.num_allocated_bytes == num_allocated_bytes);
+            #endif
+
+                // The memory block went back to the pool, so it's reused here.
+                Request request2{2};
+                fruit::InjectorPool<X>::PooledInjector injector =
+                    injector_pool.get(normalized_component, getRequestComponent, &request2);
+                Assert(injector->get<X&>().request.n == 2);
+                Assert(resource.num_allocated_bytes == num_allocated_bytes);
+              }
+              Assert(resource.num_allocated_bytes == 0);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source)
+
+    def test_skip_object_destruction_is_ignored(self):
+        source = '''
+            struct Request {
+              int n;
+            };
+
+            struct X {
+              static int num_destroyed;
+              using Inject = X(const Request&);
+              X(const Request&) {}
+              ~X() {
+                ++num_destroyed;
+              }
+            };
+
+            int X::num_destroyed = 0;
+
+            fruit::Component<fruit::Required<Request>, X> getXComponent() {
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Request> getRequestComponent(Request* request) {
+              return fruit::createComponent()
+                  .bindInstance(*request);
+            }
+
+            int main() {
+              fruit::NormalizedComponent<fruit::Required<Request>, X> normalized_component(getXComponent);
+              fruit::InjectorOptions options;
+              options.skip_object_destruction = true;
+              fruit::InjectorPool<X> injector_pool(options);
+              for (int i = 0; i < 3; i++) {
+                Request request{i};
+                {
+                  fruit::InjectorPool<X>::PooledInjector injector =
+                      injector_pool.get(normalized_component, getRequestComponent, &request);
+                  injector->get<X&>();
+                }
+                // The object is destroyed when the injector goes back to the pool, instead of being leaked.
+                Assert(X::num_destroyed == i + 1);
+              }
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source)
+
+    @parameterized.parameters([
+        'X',
+        'fruit::Annotated<Annotation1, X>',
+    ])
+    def test_error_declared_types_not_provided(self, XAnnot):
+        source = '''
+            struct X {
+              using Inject = X();
+            };
+
+            fruit::Component<> getEmptyComponent() {
+              return fruit::createComponent();
+            }
+
+            int main() {
+              fruit::NormalizedComponent<> normalizedComponent(getEmptyComponent);
+              fruit::InjectorPool<XAnnot> injector_pool;
+              injector_pool.get(normalizedComponent, getEmptyComponent);
+            }
+            '''
+        expect_compile_error(
+            'TypesInInjectorNotProvidedError<XAnnot>',
+            'The types in TypesNotProvided are declared as provided by the injector, but none of the two components passed to the Injector constructor provides them.',
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+if __name__ == '__main__':
+    absltest.main()
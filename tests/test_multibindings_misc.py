@@ -532,6 +532,57 @@ class TestMultibindingsMisc(parameterized.TestCase):
             COMMON_DEFINITIONS,
             source)
 
+    def test_several_types_with_normalized_component(self):
+        source = '''
+            int n1 = 1, n2 = 2, n3 = 3, n4 = 4;
+            double d1 = 1.5;
+            char c1 = 'a', c2 = 'b';
+
+            fruit::Component<> getRootComponent() {
+              return fruit::createComponent()
+                .addInstanceMultibinding(n1)
+                .addInstanceMultibinding(c1)
+                .addInstanceMultibinding<fruit::Annotated<Annotation1, int>>(n3);
+            }
+
+            fruit::Component<> getRequestComponent() {
+              return fruit::createComponent()
+                .addInstanceMultibinding(n2)
+                .addInstanceMultibinding(d1)
+                .addInstanceMultibinding(c2)
+                .addInstanceMultibinding<fruit::Annotated<Annotation1, int>>(n4);
+            }
+
+            int main() {
+              fruit::NormalizedComponent<> normalizedComponent(getRootComponent);
+              for (int i = 0; i < 2; i++) {
+                fruit::Injector<> injector(normalizedComponent, getRequestComponent);
+
+                const std::vector<int*>& ints = injector.getMultibindings<int>();
+                Assert(ints.size() == 2);
+                Assert(*ints[0] + *ints[1] == 1 + 2);
+                Assert(&injector.getMultibindings<int>() == &ints);
+
+                const std::vector<double*>& doubles = injector.getMultibindings<double>();
+                Assert(doubles.size() == 1);
+                Assert(doubles[0] == &d1);
+
+                const std::vector<char*>& chars = injector.getMultibindings<char>();
+                Assert(chars.size() == 2);
+                Assert(*chars[0] + *chars[1] == 'a' + 'b');
+
+                const std::vector<int*>& annotated_ints = injector.getMultibindings<fruit::Annotated<Annotation1, int>>();
+                Assert(annotated_ints.size() == 2);
+                Assert(*annotated_ints[0] + *annotated_ints[1] == 3 + 4);
+
+                Assert(injector.getMultibindings<X>().empty());
+              }
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source)
+
     @parameterized.parameters([
         ('const X', r'const X'),
         ('X*', r'X\*'),
@@ -204,5 +204,799 @@ class TestNormalizedComponent(parameterized.TestCase):
             source,
             locals())
 
+    def test_multiple_injectors_with_different_instances(self):
+        source = '''
+            struct Foo {
+              int value;
+            };
+
+            struct Bar {
+              Foo& foo;
+              INJECT(Bar(Foo& foo)) : foo(foo) {}
+            };
+
+            fruit::Component<fruit::Required<Foo>, Bar> getComponent() {
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Foo> getFooComponent(Foo* foo) {
+              return fruit::createComponent()
+                .bindInstance(*foo);
+            }
+
+            int main() {
+              fruit::NormalizedComponent<fruit::Required<Foo>, Bar> normalizedComponent(getComponent);
+
+              std::vector<Foo> foos;
+              for (int i = 0; i < 5; ++i) {
+                foos.push_back(Foo{i});
+              }
+              for (int n = 0; n < 2; ++n) {
+                for (Foo& foo : foos) {
+                  fruit::Injector<Foo, Bar> injector(normalizedComponent, getFooComponent, &foo);
+                  Assert(&(injector.get<Foo&>()) == &foo);
+                  Assert(&(injector.get<Bar&>().foo) == &foo);
+                }
+              }
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_multiple_injectors_with_different_instances_in_installed_component(self):
+        source = '''
+            struct Foo {
+              int value;
+            };
+
+            struct Bar {
+              Foo& foo;
+              INJECT(Bar(Foo& foo)) : foo(foo) {}
+            };
+
+            fruit::Component<fruit::Required<Foo>, Bar> getComponent() {
+              return fruit::createComponent();
+            }
+
+            Foo* current_foo = nullptr;
+
+            fruit::Component<Foo> getFooComponent() {
+              return fruit::createComponent()
+                .bindInstance(*current_foo)
+                .addInstanceMultibinding(*current_foo);
+            }
+
+            fruit::Component<Foo> getOuterComponent() {
+              return fruit::createComponent()
+                .install(getFooComponent);
+            }
+
+            int main() {
+              fruit::NormalizedComponent<fruit::Required<Foo>, Bar> normalizedComponent(getComponent);
+
+              std::vector<Foo> foos;
+              for (int i = 0; i < 5; ++i) {
+                foos.push_back(Foo{i});
+              }
+              for (int n = 0; n < 2; ++n) {
+                for (Foo& foo : foos) {
+                  current_foo = &foo;
+                  fruit::Injector<Foo, Bar> injector(normalizedComponent, getOuterComponent);
+                  Assert(&(injector.get<Foo&>()) == &foo);
+                  Assert(&(injector.get<Bar&>().foo) == &foo);
+                  std::vector<Foo*> multibindings = injector.getMultibindings<Foo>();
+                  Assert(multibindings.size() == 1);
+                  Assert(multibindings[0] == &foo);
+                }
+              }
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_normalized_component_with_parallel_normalization(self):
+        source = '''
+            struct Foo {
+              int value;
+            };
+
+            template <int N>
+            struct Bar {
+              Foo& foo;
+              int n;
+              INJECT(Bar(Foo& foo, ASSISTED(int) n)) : foo(foo), n(n) {}
+            };
+
+            fruit::Component<fruit::Required<Foo>, std::function<Bar<0>(int)>> getBar0Component() {
+              return fruit::createComponent();
+            }
+
+            fruit::Component<fruit::Required<Foo>, std::function<Bar<1>(int)>> getBar1Component(int) {
+              return fruit::createComponent();
+            }
+
+            fruit::Component<fruit::Required<Foo>, std::function<Bar<1>(int)>> getOtherBar1Component() {
+              return fruit::createComponent();
+            }
+
+            fruit::Component<fruit::Required<Foo>, std::function<Bar<0>(int)>, std::function<Bar<1>(int)>> getComponent() {
+              return fruit::createComponent()
+                .replace(getBar1Component, 5).with(getOtherBar1Component)
+                .install(getBar0Component)
+                .install(getBar1Component, 5);
+            }
+
+            fruit::Component<Foo> getFooComponent(Foo* foo) {
+              return fruit::createComponent()
+                .bindInstance(*foo);
+            }
+
+            int main() {
+              fruit::NormalizedComponentOptions options;
+              options.num_normalization_threads = 3;
+              fruit::NormalizedComponent<fruit::Required<Foo>, std::function<Bar<0>(int)>, std::function<Bar<1>(int)>>
+                  normalizedComponent(options, getComponent);
+
+              Foo foo{1};
+              fruit::Injector<std::function<Bar<0>(int)>, std::function<Bar<1>(int)>> injector(
+                  normalizedComponent, getFooComponent, &foo);
+              Bar<1> bar = injector.get<std::function<Bar<1>(int)>>()(7);
+              Assert(&bar.foo == &foo);
+              Assert(bar.n == 7);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_normalized_component_with_parallel_normalization_exception(self):
+        source = '''
+            #include <stdexcept>
+
+            template <int N>
+            struct Foo {
+              INJECT(Foo()) = default;
+            };
+
+            template <int N>
+            fruit::Component<Foo<N>> getFooComponent(int n) {
+            #if FRUIT_HAS_EXCEPTIONS
+              if (n == 3) {
+                throw std::runtime_error("getFooComponent");
+              }
+            #endif
+              (void) n;
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Foo<0>, Foo<1>, Foo<2>, Foo<3>, Foo<4>, Foo<5>> getComponent() {
+              return fruit::createComponent()
+                .install(getFooComponent<0>, 0)
+                .install(getFooComponent<1>, 1)
+                .install(getFooComponent<2>, 2)
+                .install(getFooComponent<3>, 3)
+                .install(getFooComponent<4>, 4)
+                .install(getFooComponent<5>, 5);
+            }
+
+            int main() {
+            #if FRUIT_HAS_EXCEPTIONS
+              fruit::NormalizedComponentOptions options;
+              options.num_normalization_threads = 4;
+              bool caught = false;
+              try {
+                fruit::NormalizedComponent<Foo<0>, Foo<1>, Foo<2>, Foo<3>, Foo<4>, Foo<5>> normalizedComponent(
+                    options, getComponent);
+              } catch (const std::runtime_error& e) {
+                Assert(std::string(e.what()) == "getFooComponent");
+                caught = true;
+              }
+              Assert(caught);
+            #endif
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    @parameterized.parameters([
+        '1',
+        '3',
+    ])
+    def test_normalized_component_with_component_expansion_cache(self, NumThreads):
+        source = '''
+            #include <atomic>
+
+            struct Logger {
+              using Inject = Logger();
+            };
+
+            struct Storage {
+              int port;
+            };
+
+            template <int N>
+            struct Service {
+              using Inject = Service(Logger&, Storage&);
+              Service(Logger&, Storage& storage) : port(storage.port) {}
+              int port;
+            };
+
+            Storage storage{8080};
+            Storage fake_storage{0};
+
+            std::atomic<int> num_logger_component_calls(0);
+            std::atomic<int> num_storage_component_calls(0);
+
+            fruit::Component<Logger> getLoggerComponent() {
+              ++num_logger_component_calls;
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Storage> getStorageComponent(int) {
+              ++num_storage_component_calls;
+              return fruit::createComponent()
+                  .bindInstance(storage);
+            }
+
+            fruit::Component<Storage> getFakeStorageComponent() {
+              return fruit::createComponent()
+                  .bindInstance(fake_storage);
+            }
+
+            template <int N>
+            fruit::Component<Service<N>> getServiceComponent() {
+              return fruit::createComponent()
+                  .install(getLoggerComponent)
+                  .install(getStorageComponent, 8080);
+            }
+
+            fruit::Component<Service<0>, Service<1>> getRootComponent() {
+              return fruit::createComponent()
+                  .install(getServiceComponent<0>)
+                  .install(getServiceComponent<1>);
+            }
+
+            fruit::Component<Service<1>> getTestRootComponent() {
+              return fruit::createComponent()
+                  .replace(getStorageComponent, 8080).with(getFakeStorageComponent)
+                  .install(getServiceComponent<1>);
+            }
+
+            fruit::Component<> getEmptyComponent() {
+              return fruit::createComponent();
+            }
+
+            int main() {
+              fruit::NormalizedComponentOptions options;
+              options.num_normalization_threads = NumThreads;
+              options.use_component_expansion_cache = true;
+
+              fruit::NormalizedComponent<Service<0>, Service<1>> normalized_component1(options, getRootComponent);
+              fruit::NormalizedComponent<Service<0>, Service<1>> normalized_component2(options, getRootComponent);
+              fruit::NormalizedComponent<Service<1>> test_normalized_component(options, getTestRootComponent);
+
+              fruit::InjectorOptions injector_options;
+              injector_options.use_component_expansion_cache = true;
+              fruit::Injector<Service<0>, Service<1>> injector(injector_options, getRootComponent);
+
+              Assert(num_logger_component_calls == 1);
+              Assert(num_storage_component_calls == 1);
+
+              fruit::Injector<Service<0>, Service<1>> injector1(normalized_component1, getEmptyComponent);
+              fruit::Injector<Service<0>, Service<1>> injector2(normalized_component2, getEmptyComponent);
+              fruit::Injector<Service<1>> test_injector(test_normalized_component, getEmptyComponent);
+              Assert(injector.get<Service<0>&>().port == 8080);
+              Assert(injector1.get<Service<0>&>().port == 8080);
+              Assert(injector2.get<Service<1>&>().port == 8080);
+              Assert(test_injector.get<Service<1>&>().port == 0);
+
+              // Normalizations that don't use the cache still call the component functions.
+              fruit::NormalizedComponent<Service<0>, Service<1>> normalized_component3(getRootComponent);
+              Assert(num_logger_component_calls == 2);
+              Assert(num_storage_component_calls == 2);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    @parameterized.parameters([
+        'fruit::normalizeAsync(getComponent, 5)',
+        'fruit::normalizeAsync(fruit::NormalizedComponentOptions(), getComponent, 5)',
+        'fruit::NormalizedComponentFuture<fruit::Required<Foo>, Bar>(getComponent, 5)',
+    ])
+    def test_normalize_async(self, NormalizeAsyncCall):
+        source = '''
+            struct Foo {
+              int value;
+            };
+
+            struct Bar {
+              Foo& foo;
+              INJECT(Bar(Foo& foo)) : foo(foo) {}
+            };
+
+            fruit::Component<fruit::Required<Foo>, Bar> getComponent(int n) {
+              Assert(n == 5);
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Foo> getFooComponent(Foo* foo) {
+              return fruit::createComponent()
+                .bindInstance(*foo);
+            }
+
+            int main() {
+              fruit::NormalizedComponentFuture<fruit::Required<Foo>, Bar> normalizedComponentFuture = NormalizeAsyncCall;
+
+              Foo foo1{1};
+              fruit::Injector<Bar> injector1(normalizedComponentFuture, getFooComponent, &foo1);
+              Assert(normalizedComponentFuture.isReady());
+              Assert(&(injector1.get<Bar&>().foo) == &foo1);
+
+              Foo foo2{2};
+              fruit::Injector<Bar> injector2(fruit::InjectorOptions(), normalizedComponentFuture, getFooComponent, &foo2);
+              Assert(&(injector2.get<Bar&>().foo) == &foo2);
+
+              fruit::Injector<Bar> injector3(normalizedComponentFuture.get(), getFooComponent, &foo2);
+              Assert(&(injector3.get<Bar&>().foo) == &foo2);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_normalize_async_exception(self):
+        source = '''
+            #include <stdexcept>
+
+            struct Foo {
+              int value;
+            };
+
+            struct Bar {
+              Foo& foo;
+              INJECT(Bar(Foo& foo)) : foo(foo) {}
+            };
+
+            fruit::Component<fruit::Required<Foo>, Bar> getComponent() {
+            #if FRUIT_HAS_EXCEPTIONS
+              throw std::runtime_error("getComponent");
+            #endif
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Foo> getFooComponent(Foo* foo) {
+              return fruit::createComponent()
+                .bindInstance(*foo);
+            }
+
+            int main() {
+            #if FRUIT_HAS_EXCEPTIONS
+              fruit::NormalizedComponentFuture<fruit::Required<Foo>, Bar> normalizedComponentFuture =
+                  fruit::normalizeAsync(getComponent);
+
+              int num_caught = 0;
+              try {
+                normalizedComponentFuture.wait();
+              } catch (const std::runtime_error& e) {
+                Assert(std::string(e.what()) == "getComponent");
+                ++num_caught;
+              }
+              Assert(normalizedComponentFuture.isReady());
+
+              try {
+                normalizedComponentFuture.get();
+              } catch (const std::runtime_error& e) {
+                Assert(std::string(e.what()) == "getComponent");
+                ++num_caught;
+              }
+
+              Foo foo{1};
+              try {
+                fruit::Injector<Bar> injector(normalizedComponentFuture, getFooComponent, &foo);
+              } catch (const std::runtime_error& e) {
+                Assert(std::string(e.what()) == "getComponent");
+                ++num_caught;
+              }
+
+              try {
+                fruit::Injector<Bar> injector(fruit::InjectorOptions(), normalizedComponentFuture, getFooComponent,
+                                              &foo);
+              } catch (const std::runtime_error& e) {
+                Assert(std::string(e.what()) == "getComponent");
+                ++num_caught;
+              }
+              Assert(num_caught == 4);
+            #endif
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_normalize_async_temporary_error(self):
+        source = '''
+            struct Foo {
+              int value;
+            };
+
+            fruit::Component<Foo> getComponent() {
+              return fruit::createComponent()
+                .registerProvider([]() { return Foo{1}; });
+            }
+
+            fruit::Component<> getEmptyComponent() {
+              return fruit::createComponent();
+            }
+
+            int main() {
+              fruit::Injector<Foo> injector(fruit::normalizeAsync(getComponent), getEmptyComponent);
+            }
+            '''
+        expect_generic_compile_error(
+            r'error: use of deleted function .fruit::Injector<P>::Injector\(fruit::NormalizedComponentFuture<'
+            r'|error: call to deleted constructor of .fruit::Injector<Foo>.'
+            r'|error C2280: .fruit::Injector<Foo>::Injector\(fruit::NormalizedComponentFuture<',
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_multiple_injectors_with_component_args_changing_bindings(self):
+        source = '''
+            struct Interface {
+              virtual int f() = 0;
+            };
+
+            struct Impl1 : public Interface {
+              INJECT(Impl1()) = default;
+              int f() override {
+                return 1;
+              }
+            };
+
+            struct Impl2 : public Interface {
+              INJECT(Impl2()) = default;
+              int f() override {
+                return 2;
+              }
+            };
+
+            struct Bar {
+              Interface& interface;
+              INJECT(Bar(Interface& interface)) : interface(interface) {}
+            };
+
+            fruit::Component<fruit::Required<Interface>, Bar> getComponent() {
+              return fruit::createComponent();
+            }
+
+            fruit::Component<Interface> getInterfaceComponent(bool useImpl1) {
+              if (useImpl1) {
+                return fruit::createComponent()
+                    .bind<Interface, Impl1>();
+              } else {
+                return fruit::createComponent()
+                    .bind<Interface, Impl2>();
+              }
+            }
+
+            fruit::Component<Interface> getImpl1Component() {
+              return fruit::createComponent()
+                  .bind<Interface, Impl1>();
+            }
+
+            int main() {
+              fruit::NormalizedComponent<fruit::Required<Interface>, Bar> normalizedComponent(getComponent);
+
+              for (int n = 0; n < 3; ++n) {
+                fruit::Injector<Bar> injector1(normalizedComponent, getInterfaceComponent, true);
+                Assert(injector1.get<Bar&>().interface.f() == 1);
+                fruit::Injector<Bar> injector2(normalizedComponent, getInterfaceComponent, false);
+                Assert(injector2.get<Bar&>().interface.f() == 2);
+                fruit::Injector<Bar> injector3(normalizedComponent, getImpl1Component);
+                Assert(injector3.get<Bar&>().interface.f() == 1);
+              }
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    @parameterized.parameters([
+        ('Pool', 'Pool*', 'Pool&', 'Config', 'Config&'),
+        ('fruit::Annotated<Annotation1, Pool>', 'fruit::Annotated<Annotation1, Pool*>',
+         'fruit::Annotated<Annotation1, Pool&>', 'fruit::Annotated<Annotation2, Config>',
+         'fruit::Annotated<Annotation2, Config&>'),
+    ])
+    def test_share_across_injectors(self, PoolAnnot, PoolPtrAnnot, PoolRefAnnot, ConfigAnnot, ConfigRefAnnot):
+        source = '''
+            struct Config {
+              static int num_constructed;
+              Config() {
+                ++num_constructed;
+              }
+            };
+            int Config::num_constructed = 0;
+
+            struct Pool {
+              static int num_constructed;
+              static int num_destroyed;
+              Config& config;
+              Pool(Config& config) : config(config) {
+                ++num_constructed;
+              }
+              ~Pool() {
+                ++num_destroyed;
+              }
+            };
+            int Pool::num_constructed = 0;
+            int Pool::num_destroyed = 0;
+
+            struct Request {};
+
+            struct Handler {
+              Pool& pool;
+              Request& request;
+              Handler(Pool& pool, Request& request) : pool(pool), request(request) {}
+            };
+
+            fruit::Component<fruit::Required<Request>, Handler, ConfigAnnot> getComponent() {
+              return fruit::createComponent()
+                  .registerConstructor<ConfigAnnot()>()
+                  .registerProvider<PoolPtrAnnot(ConfigRefAnnot)>([](Config& config) { return new Pool(config); })
+                  .registerProvider<Handler(PoolRefAnnot, Request&)>(
+                      [](Pool& pool, Request& request) { return Handler(pool, request); })
+                  .shareAcrossInjectors<PoolAnnot>();
+            }
+
+            fruit::Component<Request> getRequestComponent(Request* request) {
+              return fruit::createComponent()
+                  .bindInstance(*request);
+            }
+
+            int main() {
+              {
+                fruit::NormalizedComponent<fruit::Required<Request>, Handler, ConfigAnnot> normalizedComponent(
+                    getComponent);
+                Assert(Pool::num_constructed == 0);
+
+                Request request1;
+                Request request2;
+                fruit::Injector<Handler, ConfigAnnot> injector1(normalizedComponent, getRequestComponent, &request1);
+                fruit::Injector<Handler, ConfigAnnot> injector2(normalizedComponent, getRequestComponent, &request2);
+                Assert(Pool::num_constructed == 0);
+
+                Handler& handler1 = injector1.get<Handler&>();
+                Handler& handler2 = injector2.get<Handler&>();
+                Assert(&handler1 != &handler2);
+                Assert(&handler1.request == &request1);
+                Assert(&handler2.request == &request2);
+                Assert(&handler1.pool == &handler2.pool);
+                Assert(Pool::num_constructed == 1);
+
+                // The dependencies of Pool are shared too.
+                Assert(Config::num_constructed == 1);
+                Assert(&(injector1.get<ConfigRefAnnot>()) == &handler1.pool.config);
+                Assert(&(injector2.get<ConfigRefAnnot>()) == &handler1.pool.config);
+
+                {
+                  Request request3;
+                  fruit::Injector<Handler, ConfigAnnot> injector3(normalizedComponent, getRequestComponent, &request3);
+                  Assert(&(injector3.get<Handler&>().pool) == &handler1.pool);
+                }
+                Assert(Pool::num_constructed == 1);
+                Assert(Pool::num_destroyed == 0);
+              }
+              Assert(Pool::num_destroyed == 1);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_share_across_injectors_with_memory_resource(self):
+        source = '''
+            #include <cstddef>
+            #include <cstdlib>
+
+            // Allocates from the heap, keeping track of the memory that is currently allocated.
+            struct CountingMemoryResource : public fruit::MemoryResource {
+              std::size_t num_allocated_bytes = 0;
+
+              void* allocate(std::size_t bytes, std::size_t alignment) override {
+                Assert(alignment <= alignof(std::max_align_t));
+                num_allocated_bytes += bytes;
+                return std::malloc(bytes);
+              }
+
+              void deallocate(void* p, std::size_t bytes, std::size_t) override {
+                num_allocated_bytes -= bytes;
+                std::free(p);
+              }
+            };
+
+            CountingMemoryResource* memory_resource = nullptr;
+
+            struct Pool {
+              INJECT(Pool()) {
+                // The shared object is stored in memory from the resource.
+                Assert(memory_resource->num_allocated_bytes != 0);
+              }
+            };
+
+            struct Request {};
+
+            struct Handler {
+              Pool& pool;
+              INJECT(Handler(Pool& pool, Request&)) : pool(pool) {}
+            };
+
+            fruit::Component<fruit::Required<Request>, Handler> getComponent() {
+              return fruit::createComponent()
+                  .shareAcrossInjectors<Pool>();
+            }
+
+            fruit::Component<Request> getRequestComponent(Request* request) {
+              return fruit::createComponent()
+                  .bindInstance(*request);
+            }
+
+            int main() {
+              CountingMemoryResource resource;
+              memory_resource = &resource;
+              {
+                fruit::NormalizedComponentOptions options;
+                options.memory_resource = &resource;
+                fruit::NormalizedComponent<fruit::Required<Request>, Handler> normalizedComponent(options, getComponent);
+                Assert(resource.num_allocated_bytes == 0);
+
+                Request request;
+                fruit::Injector<Handler> injector(normalizedComponent, getRequestComponent, &request);
+                injector.get<Handler&>();
+                Assert(resource.num_allocated_bytes != 0);
+              }
+              Assert(resource.num_allocated_bytes == 0);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source)
+
+    def test_share_across_injectors_with_concurrent_injectors(self):
+        source = '''
+            #include <atomic>
+            #include <thread>
+            #include <vector>
+
+            struct Pool {
+              static std::atomic<int> num_constructed;
+              INJECT(Pool()) {
+                ++num_constructed;
+                std::this_thread::yield();
+              }
+            };
+            std::atomic<int> Pool::num_constructed(0);
+
+            struct Request {};
+
+            struct Handler {
+              Pool& pool;
+              INJECT(Handler(Pool& pool, Request&)) : pool(pool) {}
+            };
+
+            fruit::Component<fruit::Required<Request>, Handler> getComponent() {
+              return fruit::createComponent()
+                  .shareAcrossInjectors<Pool>();
+            }
+
+            fruit::Component<Request> getRequestComponent(Request* request) {
+              return fruit::createComponent()
+                  .bindInstance(*request);
+            }
+
+            int main() {
+              fruit::NormalizedComponent<fruit::Required<Request>, Handler> normalizedComponent(getComponent);
+
+              std::vector<Pool*> pools(8);
+              std::vector<std::thread> threads;
+              for (int i = 0; i < 8; i++) {
+                threads.emplace_back([&normalizedComponent, &pools, i]() {
+                  for (int j = 0; j < 20; j++) {
+                    Request request;
+                    fruit::Injector<Handler> injector(normalizedComponent, getRequestComponent, &request);
+                    Pool* pool = &(injector.get<Handler&>().pool);
+                    Assert(j == 0 || pools[i] == pool);
+                    pools[i] = pool;
+                  }
+                });
+              }
+              for (std::thread& thread : threads) {
+                thread.join();
+              }
+
+              Assert(Pool::num_constructed == 1);
+              for (Pool* pool : pools) {
+                Assert(pool == pools[0]);
+              }
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    @parameterized.parameters([
+        ('Pool', r"it \(directly or indirectly\) depends on (struct )?Request, that's not bound"),
+        ('Request', r"it's not bound"),
+    ])
+    def test_share_across_injectors_type_not_bound_error(self, SharedType, ErrorRegex):
+        source = '''
+            struct Request {};
+
+            struct Pool {
+              INJECT(Pool(Request&)) {}
+            };
+
+            struct Handler {
+              INJECT(Handler(Pool&)) {}
+            };
+
+            fruit::Component<fruit::Required<Request>, Handler> getComponent() {
+              return fruit::createComponent()
+                  .shareAcrossInjectors<SharedType>();
+            }
+
+            int main() {
+              fruit::NormalizedComponent<fruit::Required<Request>, Handler> normalizedComponent(getComponent);
+              (void) normalizedComponent;
+            }
+            '''
+        expect_runtime_error(
+            'Fatal injection error: the type (struct )?SharedType is shared across injectors, but ErrorRegex in the normalized component.',
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_share_across_injectors_in_injector_without_normalized_component(self):
+        source = '''
+            struct Pool {
+              INJECT(Pool()) = default;
+            };
+
+            struct Handler {
+              Pool& pool;
+              INJECT(Handler(Pool& pool)) : pool(pool) {}
+            };
+
+            fruit::Component<Handler, Pool> getComponent() {
+              return fruit::createComponent()
+                  .shareAcrossInjectors<Pool>();
+            }
+
+            int main() {
+              fruit::Injector<Handler, Pool> injector1(getComponent);
+              fruit::Injector<Handler, Pool> injector2(getComponent);
+              Assert(&(injector1.get<Handler&>().pool) == &(injector1.get<Pool&>()));
+              Assert(&(injector1.get<Pool&>()) != &(injector2.get<Pool&>()));
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
 if __name__ == '__main__':
     absltest.main()
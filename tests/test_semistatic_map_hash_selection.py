@@ -56,5 +56,63 @@ class TestSemistaticMapHashSelection(parameterized.TestCase):
             source,
             locals())
 
+    def test_deterministic_hashing(self):
+        source = '''
+            fruit::Component<> getComponent() {
+              return fruit::createComponent()
+                .registerConstructor<X1()>()
+                .registerConstructor<X2()>()
+                .registerConstructor<X3()>()
+                .registerConstructor<X4()>()
+                .registerConstructor<X5()>()
+                .registerConstructor<X6()>()
+                .registerConstructor<X7()>();
+            }
+            
+            int main() {
+              fruit::NormalizedComponentOptions options;
+              options.deterministic_hashing = true;
+              fruit::NormalizedComponent<> normalizedComponent1(options, getComponent);
+              for (int i = 0; i < 10; i++) {
+                fruit::NormalizedComponent<> normalizedComponent2(options, getComponent);
+                Assert(normalizedComponent2.getHashFunctionMultiplier() == normalizedComponent1.getHashFunctionMultiplier());
+                Assert(normalizedComponent2.getNumHashFunctionRetries() == normalizedComponent1.getNumHashFunctionRetries());
+              }
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
+    def test_hash_function_multiplier_reuse(self):
+        source = '''
+            fruit::Component<> getComponent() {
+              return fruit::createComponent()
+                .registerConstructor<X1()>()
+                .registerConstructor<X2()>()
+                .registerConstructor<X3()>()
+                .registerConstructor<X4()>()
+                .registerConstructor<X5()>()
+                .registerConstructor<X6()>()
+                .registerConstructor<X7()>();
+            }
+            
+            int main() {
+              for (int i = 0; i < 50; i++) {
+                fruit::NormalizedComponent<> normalizedComponent1(getComponent);
+                fruit::NormalizedComponentOptions options;
+                options.hash_function_multiplier = normalizedComponent1.getHashFunctionMultiplier();
+                fruit::NormalizedComponent<> normalizedComponent2(options, getComponent);
+                Assert(normalizedComponent2.getHashFunctionMultiplier() == normalizedComponent1.getHashFunctionMultiplier());
+                Assert(normalizedComponent2.getNumHashFunctionRetries() == 0);
+              }
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
 if __name__ == '__main__':
     absltest.main()
@@ -99,5 +99,28 @@ class TestTypeInfo(parameterized.TestCase):
             source,
             locals())
 
+    def test_dense_index(self):
+        source = '''
+            struct MyStruct1 {};
+            struct MyStruct2 {};
+
+            int main() {
+              Assert(getTypeId<MyStruct1>().type_info->denseIndex() == 0);
+              std::size_t index1 = getTypeId<MyStruct1>().type_info->getOrAssignDenseIndex();
+              Assert(index1 != 0);
+              Assert(getTypeId<MyStruct1>().type_info->denseIndex() == index1);
+              Assert(getTypeId<MyStruct1>().type_info->getOrAssignDenseIndex() == index1);
+
+              using AnnotatedMyStruct1 = fruit::Annotated<MyStruct2, MyStruct1>;
+              std::size_t index2 = getTypeId<AnnotatedMyStruct1>().type_info->getOrAssignDenseIndex();
+              Assert(index2 != 0);
+              Assert(index2 != index1);
+            }
+            '''
+        expect_success(
+            COMMON_DEFINITIONS,
+            source,
+            locals())
+
 if __name__ == '__main__':
     absltest.main()